@@ -10,14 +10,16 @@
 #include <stdint.h>
 #include "esp_err.h"
 #include "mqtt_client.h"
+#include "event_system.h"
 
-// MQTT消息结构体
+// MQTT消息结构体（主题和数据指向入站环形缓冲区中的记录，处理完成前有效）
 typedef struct {
-    char *topic;       // 消息主题
-    char *data;        // 消息数据
+    char *topic;       // 消息主题，以 '\0' 结尾
+    char *data;        // 消息数据，以 '\0' 结尾
     int data_len;      // 消息数据长度
     int qos;           // 消息QoS等级
     int retain;        // 消息保留标志
+    uint32_t recv_time; // 接收时间戳（单位：微秒）
 } mqtt_message_t;
 
 // MQTT客户端配置结构体
@@ -45,7 +47,32 @@ esp_err_t mqtt_client_subscribe(const char *topic, int qos);
 // 发布MQTT消息
 esp_err_t mqtt_client_publish(const char *topic, const char *data, int qos, bool retain);
 
+// 将MQTT消息放入发送队列，由MQTT任务发送，不阻塞调用者（用于LVGL任务）
+esp_err_t mqtt_client_enqueue(const char *topic, const char *data, int qos, bool retain);
+
+// MQTT是否已连接
+bool mqtt_client_is_connected(void);
+
 // 获取MQTT客户端句柄
 esp_mqtt_client_handle_t mqtt_client_get_handle(void);
 
+/**
+ * @brief 将一条入站消息写入所属通道的环形缓冲区并通知事件处理任务
+ *
+ * esp-mqtt 收到消息时调用；环形缓冲区只允许一个生产者，
+ * 其他调用者（如 mqtt_replay）只能在MQTT客户端未启动时使用。
+ *
+ * @param topic 主题（无需以 '\0' 结尾）
+ * @param topic_len 主题长度
+ * @param data 数据
+ * @param data_len 数据长度
+ * @param qos QoS等级
+ * @param retain 保留标志
+ * @return esp_err_t ESP_ERR_NOT_FOUND 表示没有匹配的路由，ESP_ERR_NO_MEM 表示环形缓冲区已满，两种情况消息均被丢弃
+ */
+esp_err_t mqtt_client_inject(const char *topic, int topic_len, const char *data, int data_len, int qos, int retain);
+
+// 获取指定优先级通道的入站消息环形缓冲区（见 mqtt_ring.h）
+struct mqtt_ring *mqtt_client_get_ring(event_lane_t lane);
+
 #endif /* ESP32_MQTT_CLIENT_H */
@@ -0,0 +1,91 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#ifndef EVENT_METRICS_H
+#define EVENT_METRICS_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_timer.h"
+#include "event_system.h"
+
+// 直方图桶数：桶 i 统计 [2^i, 2^(i+1)) 微秒，最后一个桶收纳所有更大的值
+#define EVENT_METRICS_BUCKETS 20
+
+// 统计上报的MQTT主题
+#define EVENT_METRICS_MQTT_TOPIC "esp32_jt/metrics/latency"
+
+// 延迟指标种类
+typedef enum {
+    EVENT_METRIC_QUEUE_WAIT,        // 从发送到被消费者取出的等待时间
+    EVENT_METRIC_HANDLER,           // 处理耗时
+    EVENT_METRIC_END_TO_END,        // 从数据到达（如收到MQTT消息）到Subject更新完成
+    EVENT_METRIC_KIND_MAX
+} event_metric_kind_t;
+
+// 延迟统计摘要（单位：微秒，百分位取所在桶的上界）
+typedef struct {
+    uint32_t count;                 // 样本数
+    uint32_t p50_us;                // 中位数
+    uint32_t p99_us;                // 99分位
+    uint32_t max_us;                // 最大值
+} event_metric_summary_t;
+
+// 获取微秒时间戳（低32位，差值计算按无符号回绕处理）
+static inline uint32_t event_metrics_now_us(void)
+{
+    return (uint32_t)esp_timer_get_time();
+}
+
+/**
+ * @brief 记录一次事件延迟样本
+ * @param type 事件类型
+ * @param kind 指标种类
+ * @param us 延迟（微秒）
+ */
+void event_metrics_record_event(event_type_t type, event_metric_kind_t kind, uint32_t us);
+
+/**
+ * @brief 记录一次UI更新延迟样本
+ * @param type UI更新类型
+ * @param kind 指标种类
+ * @param us 延迟（微秒）
+ */
+void event_metrics_record_ui(ui_update_type_t type, event_metric_kind_t kind, uint32_t us);
+
+/**
+ * @brief 获取事件延迟统计摘要
+ * @param type 事件类型
+ * @param kind 指标种类
+ * @param summary 输出摘要
+ */
+void event_metrics_get_event_summary(event_type_t type, event_metric_kind_t kind, event_metric_summary_t *summary);
+
+/**
+ * @brief 获取UI更新延迟统计摘要
+ * @param type UI更新类型
+ * @param kind 指标种类
+ * @param summary 输出摘要
+ */
+void event_metrics_get_ui_summary(ui_update_type_t type, event_metric_kind_t kind, event_metric_summary_t *summary);
+
+/**
+ * @brief 将所有非空指标的 p50/p99/max 打印到日志
+ */
+void event_metrics_dump(void);
+
+/**
+ * @brief 将所有非空指标以JSON格式发布到 EVENT_METRICS_MQTT_TOPIC
+ * @return esp_err_t 错误码
+ */
+esp_err_t event_metrics_publish(void);
+
+/**
+ * @brief 清空所有直方图，开始新的统计周期
+ */
+void event_metrics_reset(void);
+
+#endif /* EVENT_METRICS_H */
@@ -0,0 +1,60 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#ifndef EVENT_POOL_H
+#define EVENT_POOL_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// 事件负载池槽位数量（两个事件队列各10项，另留生产者持有余量）
+#define EVENT_POOL_SLOT_COUNT 24
+
+// 单个槽位的负载字节数（含8字节引用计数头），可容纳 ui_update_t 和 xml_load_result_t 等小负载
+#define EVENT_POOL_SLOT_SIZE 64
+
+// 事件负载池统计信息
+typedef struct {
+    uint32_t capacity;          // 槽位总数
+    uint32_t slot_size;         // 单个槽位字节数
+    uint32_t in_use;            // 当前占用槽位数
+    uint32_t high_water;        // 占用峰值
+    uint32_t acquired;          // 累计从池中分配的次数
+    uint32_t heap_fallbacks;    // 池耗尽或尺寸超限时回退到堆分配的次数
+} event_pool_stats_t;
+
+/**
+ * @brief 从事件负载池获取一个槽位
+ *
+ * 池中无空闲槽位或 size 超过槽位大小时回退到堆分配，
+ * 两种情况都必须通过 event_pool_free 释放。
+ *
+ * @param size 需要的字节数
+ * @return void* 负载指针，失败返回 NULL
+ */
+void *event_pool_alloc(size_t size);
+
+/**
+ * @brief 释放 event_pool_alloc 分配的负载
+ * @param ptr 负载指针，可为 NULL
+ */
+void event_pool_free(void *ptr);
+
+/**
+ * @brief 判断指针是否属于事件负载池
+ * @param ptr 负载指针
+ * @return true 属于池中槽位
+ */
+bool event_pool_owns(const void *ptr);
+
+/**
+ * @brief 获取事件负载池统计信息
+ * @param stats 输出统计信息
+ */
+void event_pool_get_stats(event_pool_stats_t *stats);
+
+#endif /* EVENT_POOL_H */
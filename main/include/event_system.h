@@ -8,10 +8,18 @@
 #define EVENT_SYSTEM_H
 
 #include <stdint.h>
+#include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/queue.h"
 #include "esp_event.h"
 
+// 事件优先级通道
+typedef enum {
+    EVENT_LANE_INTERACTIVE,            // 交互通道：点击反馈、播放状态、开关状态等，总是优先处理
+    EVENT_LANE_BULK,                   // 批量通道：歌词、能耗、天气等，在时间预算内处理
+    EVENT_LANE_MAX                     // 通道数量
+} event_lane_t;
+
 // UI更新类型枚举
 typedef enum {
     UI_UPDATE_TYPE_LYRICS,              // 更新歌词
@@ -35,16 +43,40 @@ typedef enum {
     UI_UPDATE_TYPE_MAX                  // UI更新类型最大值
 } ui_update_type_t;
 
-// UI更新数据结构
+// UI更新值的编码方式
+typedef enum {
+    UI_VALUE_INT,                      // 整数，保存在 int_value
+    UI_VALUE_STR,                      // 字符串，str_value 指向调用者的缓冲区，长度为 len
+    UI_VALUE_PTR,                      // 指针，保存在 ptr_value
+} ui_value_tag_t;
+
+// UI更新数据结构（紧凑编码，32位平台为12字节）
+// 字符串不随结构体复制，发布时由UI更新通道按实际长度拷入该类型的字符串池
 typedef struct {
-    ui_update_type_t type;             // 更新类型
+    uint8_t type;                      // 更新类型 (ui_update_type_t)
+    uint8_t tag;                       // 值的编码方式 (ui_value_tag_t)，零初始化即为整数
+    uint16_t len;                      // 字符串长度（不含 '\0'），仅 UI_VALUE_STR 有效
+    uint32_t origin_time;              // 数据到达时间戳（单位：微秒），0 表示以发布时刻为准
     union {
-        char str_value[256];           // 字符串值
+        const char *str_value;         // 字符串值，以 '\0' 结尾
         int int_value;                 // 整数值
         void *ptr_value;               // 指针值 (用于图片等)
     } value;                           // 更新值
 } ui_update_t;
 
+/**
+ * @brief 设置字符串值，字符串只需在发布调用期间有效
+ * @param update UI更新
+ * @param str 以 '\0' 结尾的字符串
+ */
+static inline void ui_update_set_str(ui_update_t *update, const char *str)
+{
+    size_t len = strlen(str);
+    update->tag = UI_VALUE_STR;
+    update->len = (len > UINT16_MAX) ? UINT16_MAX : (uint16_t)len;
+    update->value.str_value = str;
+}
+
 // 事件类型枚举
 typedef enum {
     EVENT_TYPE_WIFI_CONNECTED,         // WiFi连接成功事件
@@ -57,30 +89,115 @@ typedef enum {
     EVENT_TYPE_NTP_TIME_UPDATED,       // NTP时间更新事件
     EVENT_TYPE_MQTT_CONNECTED,         // MQTT连接成功事件
     EVENT_TYPE_MQTT_DISCONNECTED,      // MQTT断开连接事件
-    EVENT_TYPE_MQTT_MESSAGE_RECEIVED,  // MQTT消息接收事件
+    EVENT_TYPE_MQTT_MESSAGE_RECEIVED,  // MQTT消息接收事件（无负载，消息在 mqtt_ring 中）
     EVENT_TYPE_UI_UPDATE,              // UI更新事件
+    EVENT_TYPE_HTTP_COMPLETE,          // 异步HTTP请求完成事件（由 http_async 在 LVGL 任务中调用完成回调）
     EVENT_TYPE_MAX                     // 事件类型最大值
 } event_type_t;
 
-// 事件队列句柄，外部可见
-extern QueueHandle_t g_system_event_queue;    // 系统事件队列
-extern QueueHandle_t g_ui_event_queue;        // UI事件队列
+// 事件发送策略：目标队列已满时的处理方式
+typedef enum {
+    EVENT_POLICY_BLOCK,                // 阻塞等待，超过期限仍无空位则丢弃新事件
+    EVENT_POLICY_DROP_NEWEST,          // 立即丢弃新事件
+    EVENT_POLICY_DROP_OLDEST,          // 丢弃队列中最旧的事件，为新事件腾出位置
+    EVENT_POLICY_COALESCE,             // 同类型事件尚未被取走时，新事件与之合并
+} event_post_policy_t;
+
+// 事件队列编号（每个队列包含交互和批量两个通道）
+typedef enum {
+    EVENT_QUEUE_SYSTEM,                // 系统事件队列，由 event_system_task 消费
+    EVENT_QUEUE_UI,                    // UI事件队列，由 LVGL 任务消费
+    EVENT_QUEUE_MAX                    // 事件队列数量
+} event_queue_id_t;
+
+// 事件队列统计信息
+typedef struct {
+    uint32_t capacity;                 // 队列容量（两个通道之和）
+    uint32_t posted;                   // 成功入队次数
+    uint32_t dropped;                  // 因队列已满被丢弃的事件数
+    uint32_t coalesced;                // 被合并的事件数
+    uint32_t high_water;               // 队列最大深度
+} event_queue_stats_t;
 
 // 事件数据结构
 typedef struct {
     event_type_t type;             // 事件类型
     void *data;                    // 事件数据
     size_t data_len;               // 事件数据长度
-    TickType_t send_time;          // 事件发送时间戳（单位：tick）
+    uint32_t send_time;            // 事件发送时间戳（单位：微秒，esp_timer 低32位）
 } event_t;
 
+// 事件订阅者的投递方式
+typedef enum {
+    EVENT_DELIVERY_CALLBACK,           // 在消费该事件队列的任务中同步回调
+    EVENT_DELIVERY_TASK,               // 向订阅任务发送任务通知，可选地把事件副本放入其队列
+} event_delivery_t;
+
+// 事件回调函数，event 及其负载只在回调期间有效，需保留负载时调用 event_system_retain
+typedef void (*event_callback_t)(const event_t *event, void *ctx);
+
+// 事件订阅者
+typedef struct {
+    event_delivery_t delivery;         // 投递方式
+    event_callback_t callback;         // EVENT_DELIVERY_CALLBACK: 回调函数
+    void *ctx;                         // EVENT_DELIVERY_CALLBACK: 回调上下文
+    TaskHandle_t task;                 // EVENT_DELIVERY_TASK: 接收通知的任务
+    QueueHandle_t queue;               // EVENT_DELIVERY_TASK: 可选，事件副本（负载已 retain）投递到此队列，处理后须 event_system_release
+    uint32_t notify_bits;              // EVENT_DELIVERY_TASK: 通知位（eSetBits），为0时使用 1 << 事件类型
+} event_subscriber_t;
+
+// 订阅句柄
+typedef int event_subscription_t;
+
+// 最大订阅数量
+#define EVENT_SUBSCRIBER_MAX 16
+
 // 事件队列初始化
 esp_err_t event_system_init(void);
 
-// 发送事件
+// 发送事件（复制 data 到事件负载池，调用者保留 data 的所有权；队列已满时按事件类型的策略处理，不会无限期阻塞）
 esp_err_t event_system_post(event_type_t type, void *data, size_t data_len);
 
-// 注册事件处理函数
+// 分配事件负载（优先从事件负载池获取槽位）
+void *event_system_alloc(size_t size);
+
+// 释放尚未发送的事件负载（引用计数减一，归零时归还）
+void event_system_free(void *data);
+
+// 增加事件负载的引用计数，订阅者需要在回调返回后继续持有负载时调用，用完后调用 event_system_free
+void *event_system_retain(void *data);
+
+// 发送事件并转移所有权（data 必须由 event_system_alloc 分配，无论成功与否调用者都不再持有 data）
+esp_err_t event_system_post_owned(event_type_t type, void *data, size_t data_len);
+
+// 发送事件到指定优先级通道并转移所有权（用于同一事件类型按内容区分优先级，如MQTT消息）
+esp_err_t event_system_post_owned_lane(event_type_t type, void *data, size_t data_len, event_lane_t lane);
+
+// 释放已处理事件的负载
+void event_system_release(event_t *event);
+
+// 发布UI更新（写入按类型合并的UI更新通道，最新值覆盖未渲染的旧值，不会阻塞）
+esp_err_t event_system_post_ui_update(const ui_update_t *update);
+
+// 从事件队列取出事件，交互通道优先（消费者须通过此函数取事件，以维护合并策略的计数）
+esp_err_t event_system_receive(event_queue_id_t queue_id, event_t *event, TickType_t timeout);
+
+// 只从事件队列的指定通道取出事件
+esp_err_t event_system_receive_lane(event_queue_id_t queue_id, event_lane_t lane, event_t *event, TickType_t timeout);
+
+// 获取事件队列统计信息
+void event_system_get_queue_stats(event_queue_id_t queue_id, event_queue_stats_t *stats);
+
+// 订阅事件，同一事件类型可有多个订阅者，按订阅顺序投递
+esp_err_t event_system_subscribe(event_type_t type, const event_subscriber_t *subscriber, event_subscription_t *handle);
+
+// 取消订阅
+esp_err_t event_system_unsubscribe(event_subscription_t handle);
+
+// 将事件投递给所有订阅者（由事件队列的消费者在取出事件后调用），负载在订阅者之间共享不复制
+void event_system_dispatch(const event_t *event);
+
+// 注册事件处理任务（以任务通知方式订阅，通知位为 1 << type）
 esp_err_t event_system_register_handler(event_type_t type, TaskHandle_t handler_task);
 
 // 事件处理任务
@@ -89,6 +206,13 @@ void event_system_task(void *arg);
 // HA 监控任务
 void ha_monitor_task(void *arg);
 
+/**
+ * @brief 应用推送来的 HA 实体状态（与HTTP轮询共用缓存和格式化，状态变化时发布UI更新）
+ * @param entity_id 实体ID，不是面板显示的实体时忽略
+ * @param state 状态字符串
+ */
+void event_system_apply_ha_state(const char *entity_id, const char *state);
+
 // 24小时天气数据结构
 typedef struct {
     float temperature;              // 温度(摄氏度)
@@ -100,4 +224,19 @@ typedef struct {
 // 获取24小时天气数据
 const hourly_weather_t* get_24h_weather_data(int *count);
 
+// 智能插座电量数据（Tasmota tele/.../SENSOR 中的 ENERGY）
+typedef struct {
+    float power;                    // 功率(W)
+    float voltage;                  // 电压(V)
+    float current;                  // 电流(A)
+    float total;                    // 累计电量(kWh)
+    bool valid;                     // 是否已收到数据
+} plug_energy_t;
+
+/**
+ * @brief 获取最近一次收到的智能插座电量数据
+ * @param data 输出：数据副本，未收到数据时 valid 为 false
+ */
+void get_plug_energy_data(plug_energy_t *data);
+
 #endif /* EVENT_SYSTEM_H */
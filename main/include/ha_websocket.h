@@ -0,0 +1,39 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#ifndef HA_WEBSOCKET_H
+#define HA_WEBSOCKET_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+/**
+ * @brief 连接 Home Assistant 的 /api/websocket，认证后用 subscribe_entities 订阅实体，
+ *        收到的状态交给 event_system_apply_ha_state；断开后自动重连并重新订阅
+ * @param entity_ids 订阅的实体ID（须为静态存储）
+ * @param count 实体数量
+ * @return esp_err_t 错误码
+ */
+esp_err_t ha_websocket_start(const char *const *entity_ids, size_t count);
+
+/**
+ * @brief 是否已认证且实体订阅成功
+ * @return true 状态由推送更新
+ */
+bool ha_websocket_is_ready(void);
+
+/**
+ * @brief 通过 WebSocket 调用服务，只放入发送队列不等待（发送失败时记录日志），可在 LVGL 回调中调用
+ * @param domain 服务领域 (如 "switch")
+ * @param service 服务名称 (如 "turn_on")
+ * @param entity_id 实体ID
+ * @return esp_err_t 非 ESP_OK 时请求未入队：ESP_ERR_INVALID_STATE 表示尚未认证，
+ *         ESP_ERR_TIMEOUT 表示队列已满，调用者应改用HTTP
+ */
+esp_err_t ha_websocket_call_service(const char *domain, const char *service, const char *entity_id);
+
+#endif /* HA_WEBSOCKET_H */
@@ -1,6 +1,23 @@
 #ifndef HOMEASSISTANT_H
 #define HOMEASSISTANT_H
+#include <stdbool.h>
+#include <stddef.h>
 #include "esp_err.h"
+#include "sdkconfig.h"
+
+// Home Assistant 地址和长期访问令牌，在 menuconfig 中设置，保存在不提交的 sdkconfig 中
+#define HA_HOST CONFIG_SMART_PANEL_HA_HOST
+#define HA_ACCESS_TOKEN CONFIG_SMART_PANEL_HA_TOKEN
+
+// 能耗 Entity ID
+#define HA_ENTITY_DAILY_ENERGY "sensor.daily_energy_consumption"
+#define HA_ENTITY_MONTHLY_ENERGY "sensor.monthly_energy_consumption"
+
+/**
+ * @brief 是否已在 menuconfig 中设置访问令牌；未设置时不向 HA 发出任何请求
+ * @return true 令牌非空
+ */
+bool ha_token_configured(void);
 
 /**
  * @brief 获取每日能耗数据
@@ -15,18 +32,39 @@ char *get_daily_energy(void);
 char *get_monthly_energy(void);
 
 /**
- * @brief 获取单个实体的状态
+ * @brief 获取单个实体的状态，等待请求完成，只能在后台任务中调用
  * @param entity_id 实体的ID
- * @return 返回状态字符串，需要调用者释放内存
+ * @return 返回状态字符串，需要调用者释放内存；最多保留 JSON_STREAM_VALUE_MAX（64）个原始字节，
+ *         更长的状态被截断（HA 状态通常是数字或 "on" 之类的短值）
  */
 char *get_entity_state(const char *entity_id);
 
 /**
- * @brief 调用 HomeAssistant 服务
+ * @brief 批量获取实体状态时的回调
+ * @param entity_id 实体ID
+ * @param state 状态字符串，仅在回调期间有效
+ */
+typedef void (*ha_state_cb_t)(const char *entity_id, const char *state);
+
+/**
+ * @brief 用一次 /api/template 请求获取多个实体的状态，依次交给回调（在HTTP工作任务中执行）
+ *        等待请求完成，只能在后台任务中调用
+ * @param entity_ids 实体ID列表
+ * @param count 实体数量
+ * @param cb 每个实体的回调
+ * @return esp_err_t 请求或解析失败时返回错误码
+ */
+esp_err_t get_entity_states(const char *const *entity_ids, size_t count, ha_state_cb_t cb);
+
+/**
+ * @brief 调用 HomeAssistant 服务，不等待结果，可在 LVGL 回调中调用
+ *
+ * WebSocket 未连接时改用异步HTTP请求，结果只记录日志。
+ *
  * @param domain 服务领域 (如 "switch")
  * @param service 服务名称 (如 "turn_on")
  * @param entity_id 实体ID
- * @return esp_err_t 返回执行结果
+ * @return esp_err_t 请求已发出或已入队时返回 ESP_OK，未设置访问令牌时返回 ESP_ERR_INVALID_STATE
  */
 esp_err_t call_ha_service(const char *domain, const char *service, const char *entity_id);
 
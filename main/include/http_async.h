@@ -0,0 +1,80 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#ifndef HTTP_ASYNC_H
+#define HTTP_ASYNC_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "event_system.h"
+#include "http_service.h"
+
+/**
+ * @brief 请求结果
+ *
+ * 响应内容借自工作任务复用的响应缓冲区，不需要释放；借出期间该工作任务
+ * 不处理下一个请求，接收者应尽快用完（需要保留时自行复制）。
+ */
+typedef struct {
+    esp_err_t err;              // ESP_OK 成功；ESP_ERR_HTTP_NOT_MODIFIED 条件请求返回304；ESP_ERR_TIMEOUT 超过截止时间；其他为请求失败
+    http_view_t response;       // 响应内容（流式请求、304 或失败时 data 为 NULL）
+    int64_t elapsed_us;         // 从提交到完成的耗时
+    void *lease;                // 内部使用：归还响应缓冲区
+} http_async_result_t;
+
+/**
+ * @brief 完成回调，在 LVGL 任务中执行，可以直接操作控件
+ * @param result 结果，仅在回调期间有效，回调返回后响应缓冲区归还给工作任务
+ * @param ctx 提交时传入的上下文
+ */
+typedef void (*http_async_done_t)(http_async_result_t *result, void *ctx);
+
+/**
+ * @brief 异步请求
+ */
+typedef struct {
+    http_config_t http;         // 请求配置，url、post_data 和请求头在提交时复制（validators 不复制），deadline_us 由 deadline_ms 计算
+    int max_retries;            // 最大尝试次数，0 按1次处理
+    uint32_t deadline_ms;       // 从提交起的截止时间，排队和重试都计算在内；0 表示不限
+    event_lane_t lane;          // 交互通道的请求由独立的工作任务处理，不排在后台下载之后
+    http_stream_cb_t on_data;   // 可选：流式接收，回调在工作任务中执行（仅 http_async_perform）
+    void *stream_ctx;           // 流式接收回调的上下文
+} http_async_request_t;
+
+/**
+ * @brief 创建请求队列和工作任务，须在 event_system_init 之后调用
+ * @return esp_err_t 错误码
+ */
+esp_err_t http_async_init(void);
+
+/**
+ * @brief 提交请求，立即返回，可在 LVGL 回调中调用
+ * @param req 请求（调用返回后即可释放）
+ * @param done 完成回调，在 LVGL 任务中执行，可为 NULL
+ * @param ctx 完成回调的上下文
+ * @return esp_err_t ESP_OK 已入队；ESP_ERR_NO_MEM 队列已满或内存不足，回调不会被调用
+ */
+esp_err_t http_async_submit(const http_async_request_t *req, http_async_done_t done, void *ctx);
+
+/**
+ * @brief 提交请求并等待完成，供后台任务使用（不可在 LVGL 任务中调用）
+ *
+ * 等待期间只阻塞调用者，已订阅任务看门狗的调用者会定期喂狗。
+ * 返回后必须调用 http_async_release 归还响应缓冲区。
+ *
+ * @param req 请求，流式接收的上下文在返回前保持有效
+ * @param result 输出结果
+ * @return esp_err_t 与 result->err 相同
+ */
+esp_err_t http_async_perform(const http_async_request_t *req, http_async_result_t *result);
+
+/**
+ * @brief 归还 http_async_perform 借出的响应缓冲区，此后 result->response 失效
+ * @param result http_async_perform 的结果（重复调用无影响）
+ */
+void http_async_release(http_async_result_t *result);
+
+#endif /* HTTP_ASYNC_H */
@@ -3,6 +3,31 @@
 
 #include "esp_http_client.h"
 
+// 304 Not Modified：调用者持有的响应内容仍然有效（较早的 ESP-IDF 没有定义）
+#ifndef ESP_ERR_HTTP_NOT_MODIFIED
+#define ESP_ERR_HTTP_NOT_MODIFIED (ESP_ERR_HTTP_BASE + 9)
+#endif
+
+// 记录的 ETag 最大长度（含引号），更长的不记录
+#define HTTP_ETAG_MAX 64
+
+// Last-Modified 的长度，如 "Sun, 06 Nov 1994 08:49:37 GMT"
+#define HTTP_LAST_MODIFIED_MAX 32
+
+/**
+ * @brief 条件请求的校验值，由保存响应内容的调用者持有，与该内容一一对应
+ *
+ * 请求的 URL 与记录的相同时发送 If-None-Match/If-Modified-Since，服务器返回 304
+ * 时请求以 ESP_ERR_HTTP_NOT_MODIFIED 结束，不接收也不解析响应内容；收到 2xx 响应
+ * 后更新为该响应的校验值。调用者丢弃内容或未能完整处理响应时应清零。
+ */
+typedef struct {
+    uint32_t key;                               // 请求 URL 的哈希，0 表示没有记录
+    uint32_t len;                               // 对应响应的长度，用于统计 304 省去的流量
+    char etag[HTTP_ETAG_MAX];
+    char last_modified[HTTP_LAST_MODIFIED_MAX];
+} http_validators_t;
+
 /**
  * @brief HTTP 请求配置结构体
  */
@@ -12,6 +37,8 @@ typedef struct {
     const char *post_data;      // POST 数据 (如果是 POST 请求)
     const char **headers;       // 请求头，格式为 [key1, val1, key2, val2, ..., NULL]
     int timeout_ms;             // 超时时间
+    int64_t deadline_us;        // 截止时刻（esp_timer_get_time），超过后不再重试，单次超时也不超过剩余时间；0 表示不限
+    http_validators_t *validators; // 可选：条件请求的校验值，请求完成前须保持有效（仅 arena 和流式接收）
 } http_config_t;
 
 /**
@@ -31,4 +58,107 @@ char* http_send_request(const http_config_t *config);
  */
 char* http_send_request_with_retry(const http_config_t *config, int max_retries);
 
+/**
+ * @brief 响应缓冲区：跨请求复用（如每个HTTP工作任务一个），只在容量不足时增长，
+ *        零初始化即可使用，不再使用时调用 http_arena_free
+ */
+typedef struct {
+    char *buf;                  // 缓冲区（优先PSRAM）
+    size_t cap;                 // 容量
+} http_arena_t;
+
+/**
+ * @brief 借给调用者的响应内容，指向 arena，下一次使用同一 arena 之前有效
+ */
+typedef struct {
+    const char *data;           // 响应内容，以 '\0' 结尾
+    size_t len;                 // 字节数（不含 '\0'）
+} http_view_t;
+
+/**
+ * @brief 发送 HTTP 请求，响应读入调用者的 arena，不分配新的缓冲区
+ *
+ * 响应给出 Content-Length 时按长度预留，否则按同一端点（URL 去掉查询参数）
+ * 出现过的最大长度预留；arena 容量足够时不分配内存，也不清零未用的部分。
+ *
+ * @param config 请求配置
+ * @param max_retries 最大尝试次数
+ * @param arena 响应缓冲区
+ * @param view 输出：响应内容
+ * @return esp_err_t 错误码，304 时为 ESP_ERR_HTTP_NOT_MODIFIED（view 为空）
+ */
+esp_err_t http_send_request_arena(const http_config_t *config, int max_retries, http_arena_t *arena,
+                                  http_view_t *view);
+
+/**
+ * @brief 释放响应缓冲区
+ *
+ * @param arena 响应缓冲区
+ */
+void http_arena_free(http_arena_t *arena);
+
+/**
+ * @brief 流式接收响应内容的回调
+ *
+ * @param ctx 上下文
+ * @param data 本次收到的内容（仅在回调期间有效）
+ * @param len 字节数
+ * @return false 停止接收，请求视为失败
+ */
+typedef bool (*http_stream_cb_t)(void *ctx, const char *data, int len);
+
+/**
+ * @brief 发送 HTTP 请求，响应内容分块交给回调，不在内存中保留完整响应
+ *
+ * 只在回调收到任何内容之前的失败才会重试，回调不会看到重复的数据。
+ *
+ * @param config 请求配置
+ * @param max_retries 最大尝试次数
+ * @param on_data 接收回调，只在状态码为 2xx 时调用
+ * @param ctx 回调上下文
+ * @return esp_err_t ESP_OK 表示响应已完整交给回调；ESP_ERR_HTTP_NOT_MODIFIED 表示 304，回调未被调用
+ */
+esp_err_t http_send_request_stream(const http_config_t *config, int max_retries, http_stream_cb_t on_data, void *ctx);
+
+/**
+ * @brief 连接池统计
+ */
+typedef struct {
+    uint32_t hits;              // 复用空闲长连接的请求数
+    uint32_t misses;            // 新建连接的请求数
+    uint32_t stale;             // 复用的连接已被服务器关闭、重新连接的次数
+} http_pool_stats_t;
+
+/**
+ * @brief 启用或停用连接池（停用时每个请求新建连接，用于对比测试）
+ *
+ * @param enabled 是否启用
+ */
+void http_service_set_pool_enabled(bool enabled);
+
+/**
+ * @brief 获取连接池统计
+ *
+ * @param stats 输出统计
+ */
+void http_service_get_pool_stats(http_pool_stats_t *stats);
+
+/**
+ * @brief 响应缓冲区统计
+ */
+typedef struct {
+    uint32_t responses;         // 读入缓冲区的响应数
+    uint32_t allocs;            // 缓冲区分配或扩容的次数
+    size_t peak_cap;            // 单个缓冲区的最大容量
+    uint32_t not_modified;      // 条件请求返回 304 的次数
+    uint64_t saved_bytes;       // 304 省去的响应内容字节数（按上次响应的长度计）
+} http_buffer_stats_t;
+
+/**
+ * @brief 获取响应缓冲区统计
+ *
+ * @param stats 输出统计
+ */
+void http_service_get_buffer_stats(http_buffer_stats_t *stats);
+
 #endif // HTTP_SERVICE_H
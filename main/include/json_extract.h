@@ -0,0 +1,66 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#ifndef JSON_EXTRACT_H
+#define JSON_EXTRACT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// 路径的最大层数
+#define JSON_EXTRACT_MAX_DEPTH 8
+
+// 提取到的值类型
+typedef enum {
+    JSON_FIELD_MISSING = 0,     // 未找到
+    JSON_FIELD_NUMBER,          // 数字
+    JSON_FIELD_STRING,          // 字符串（value 不含引号，转义序列保持原样，json_field_string 拷贝时解码）
+    JSON_FIELD_BOOL,            // true/false
+    JSON_FIELD_NULL,            // null
+    JSON_FIELD_OBJECT,          // 对象（value 为含括号的原始文本）
+    JSON_FIELD_ARRAY,           // 数组（value 为含括号的原始文本）
+} json_field_kind_t;
+
+// 待提取的字段，value 直接指向输入缓冲区，不分配内存
+typedef struct {
+    const char *path;           // 以 '.' 分隔的对象键路径，如 "ENERGY.Power"
+    json_field_kind_t kind;     // 输出：值类型
+    const char *value;          // 输出：值在缓冲区中的起始位置
+    size_t value_len;           // 输出：值的字节数
+} json_field_t;
+
+/**
+ * @brief 单遍扫描JSON文本，按路径提取字段，不分配内存，所有字段找到后立即返回
+ *
+ * 只匹配对象键组成的路径，不进入数组元素；键按原始字节比较（不处理转义）。
+ * 重复出现的键以第一次为准。
+ *
+ * @param json JSON文本（无需以 '\0' 结尾）
+ * @param len 文本长度
+ * @param fields 待提取的字段，调用时清空输出
+ * @param count 字段数量
+ * @return int 找到的字段数，JSON语法错误时返回 -1（错误前找到的字段仍然有效）
+ */
+int json_extract(const char *json, size_t len, json_field_t *fields, size_t count);
+
+/**
+ * @brief 将提取到的数字字段转换为 double
+ * @param field 字段
+ * @param out 输出数值
+ * @return true 字段存在且为数字
+ */
+bool json_field_number(const json_field_t *field, double *out);
+
+/**
+ * @brief 将提取到的字符串字段拷贝到缓冲区，解码转义序列（\uXXXX 转为UTF-8），超长时截断
+ * @param field 字段
+ * @param buf 输出缓冲区，以 '\0' 结尾
+ * @param size 缓冲区大小
+ * @return true 字段存在且为字符串
+ */
+bool json_field_string(const json_field_t *field, char *buf, size_t size);
+
+#endif /* JSON_EXTRACT_H */
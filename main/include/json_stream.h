@@ -0,0 +1,89 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#ifndef JSON_STREAM_H
+#define JSON_STREAM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "json_extract.h"
+
+// 容器嵌套的最大层数，超过时视为错误
+#define JSON_STREAM_MAX_DEPTH JSON_EXTRACT_MAX_DEPTH
+
+// 对象键的最大长度，超长的键不会与任何订阅匹配
+#define JSON_STREAM_KEY_MAX 32
+
+// 标量值的最大长度（按转义前的原始字节计），超长的字符串截断
+#define JSON_STREAM_VALUE_MAX 64
+
+/**
+ * @brief 订阅的值解析完成时的回调
+ * @param ctx 订阅时传入的上下文
+ * @param field 值：path 为订阅路径，value 仅在回调期间有效，字符串保留转义序列，可用 json_field_number/json_field_string 转换
+ * @param index 最内层数组中的下标，不在数组中时为 -1
+ */
+typedef void (*json_stream_cb_t)(void *ctx, const json_field_t *field, int index);
+
+// 路径订阅
+typedef struct {
+    const char *path;           // 如 "hourly.temperature_2m[*]"，"[*]" 匹配任意下标，"[3]" 只匹配下标3，"[*]" 开头表示顶层数组
+    json_stream_cb_t cb;
+    void *ctx;
+} json_stream_sub_t;
+
+// 路径上的一层容器
+typedef struct {
+    char type;                  // '{' 或 '['
+    uint8_t key_len;            // 对象中当前键的长度，超长时为 UINT8_MAX
+    int index;                  // 数组中当前元素的下标
+    char key[JSON_STREAM_KEY_MAX];
+} json_stream_frame_t;
+
+/**
+ * @brief 流式解析器状态，只占几百字节，可放在栈上
+ *
+ * 按任意分块喂入文本，标量值（数字、字符串、true/false/null）解析完成后
+ * 与订阅路径比较，匹配时立即回调；不构建DOM，不分配内存。
+ */
+typedef struct {
+    const json_stream_sub_t *subs;
+    size_t sub_count;
+    int state;
+    int depth;                  // 当前所在容器的层数
+    bool in_key;                // 正在解析的字符串是对象键
+    bool escape;                // 字符串中上一个字符是 '\'
+    size_t token_len;
+    char token[JSON_STREAM_VALUE_MAX + 1];
+    json_stream_frame_t stack[JSON_STREAM_MAX_DEPTH];
+} json_stream_t;
+
+/**
+ * @brief 初始化解析器
+ * @param s 解析器
+ * @param subs 订阅列表（解析期间须保持有效）
+ * @param count 订阅数量
+ */
+void json_stream_init(json_stream_t *s, const json_stream_sub_t *subs, size_t count);
+
+/**
+ * @brief 喂入一段文本，分块边界可以落在任意位置（包括字符串和数字中间）
+ * @param s 解析器
+ * @param data 文本
+ * @param len 字节数
+ * @return int 0 成功，JSON语法错误或嵌套过深时返回 -1（此后的输入全部忽略）
+ */
+int json_stream_feed(json_stream_t *s, const char *data, size_t len);
+
+/**
+ * @brief 结束输入，检查顶层值是否完整
+ * @param s 解析器
+ * @return int 0 完整，-1 语法错误或文本被截断
+ */
+int json_stream_finish(json_stream_t *s);
+
+#endif /* JSON_STREAM_H */
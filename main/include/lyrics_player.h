@@ -0,0 +1,54 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#ifndef LYRICS_PLAYER_H
+#define LYRICS_PLAYER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+// 本地歌词调度：每首歌接收一次完整的LRC，解析为按时间排序的行表，
+// LVGL 任务每帧按播放时钟查找当前行
+
+/**
+ * @brief 初始化歌词调度
+ * @return esp_err_t 错误码
+ */
+esp_err_t lyrics_player_init(void);
+
+/**
+ * @brief 解析LRC并替换当前歌词表（在事件处理任务中调用）
+ *
+ * 支持一行多个时间标签 "[mm:ss.xx][mm:ss.xx]歌词" 和 [offset:毫秒] 标签，其他元数据标签忽略。
+ * 数据为空或不含时间标签时清空歌词表，恢复逐行接收歌词。
+ *
+ * @param lrc LRC文本（无需以 '\0' 结尾）
+ * @param len 文本长度
+ * @return esp_err_t ESP_ERR_NO_MEM 表示分配歌词表失败
+ */
+esp_err_t lyrics_player_load(const char *lrc, size_t len);
+
+/**
+ * @brief 是否已加载歌词表（已加载时逐行歌词消息应被忽略）
+ * @return true 已加载
+ */
+bool lyrics_player_active(void);
+
+/**
+ * @brief 按播放位置查找当前歌词行（在 LVGL 任务中每帧调用）
+ *
+ * 位置连续前进时只检查下一行，跳转时在行表中二分查找。
+ *
+ * @param position_ms 当前播放位置（毫秒）
+ * @param buf 输出当前行文本，第一行之前为空字符串
+ * @param size 缓冲区大小
+ * @return true 当前行发生变化，需要刷新显示
+ */
+bool lyrics_player_poll(uint32_t position_ms, char *buf, size_t size);
+
+#endif /* LYRICS_PLAYER_H */
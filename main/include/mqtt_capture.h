@@ -0,0 +1,113 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#ifndef MQTT_CAPTURE_H
+#define MQTT_CAPTURE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+/*
+ * MQTT流量捕获文件格式（小端序，无对齐填充），主机工具 tools/mqtt_capture.py 使用同一格式：
+ *
+ *   文件头 mqtt_capture_header_t
+ *   记录 × record_count：mqtt_capture_record_t + 主题 + 数据（主题和数据均不含 '\0'）
+ *
+ * 每条记录的时间戳为距上一条记录的微秒数，第一条为距开始捕获的微秒数。
+ */
+
+// 文件头魔数 "MQCP"
+#define MQTT_CAPTURE_MAGIC 0x5043514Du
+
+// 格式版本
+#define MQTT_CAPTURE_VERSION 1
+
+// 捕获数据所在的flash分区名（见 partitions_custom.csv）
+#define MQTT_CAPTURE_PARTITION "mqttcap"
+
+// 捕获文件头
+typedef struct __attribute__((packed)) {
+    uint32_t magic;         // MQTT_CAPTURE_MAGIC
+    uint16_t version;       // MQTT_CAPTURE_VERSION
+    uint16_t header_size;   // 文件头字节数
+    uint32_t record_count;  // 记录数
+    uint32_t data_size;     // 文件头之后的字节数
+} mqtt_capture_header_t;
+
+// 捕获记录头，后面紧跟主题和数据
+typedef struct __attribute__((packed)) {
+    uint32_t delta_us;      // 距上一条记录的微秒数
+    uint32_t data_len;      // 数据长度
+    uint16_t topic_len;     // 主题长度
+    uint8_t qos;            // QoS等级
+    uint8_t retain;         // 保留标志
+} mqtt_capture_record_t;
+
+// 捕获统计信息
+typedef struct {
+    bool active;            // 是否正在捕获
+    uint32_t capacity;      // 缓冲区字节数
+    uint32_t used;          // 已用字节数（含文件头）
+    uint32_t records;       // 已捕获的消息数
+    uint32_t dropped;       // 缓冲区已满后未捕获的消息数
+} mqtt_capture_stats_t;
+
+/**
+ * @brief 分配捕获缓冲区（优先分配在 PSRAM）并开始捕获
+ * @param capacity 缓冲区字节数
+ * @param duration_ms 捕获时长，0 表示直到缓冲区写满
+ * @return esp_err_t 错误码
+ */
+esp_err_t mqtt_capture_start(size_t capacity, uint32_t duration_ms);
+
+/**
+ * @brief 记录一条入站消息（仅由 esp-mqtt 任务调用）
+ *
+ * 缓冲区写满或达到捕获时长时自动停止捕获，并由后台任务保存到flash分区和串口。
+ *
+ * @param topic 主题（无需以 '\0' 结尾）
+ * @param topic_len 主题长度
+ * @param data 数据
+ * @param data_len 数据长度
+ * @param qos QoS等级
+ * @param retain 保留标志
+ */
+void mqtt_capture_record(const char *topic, int topic_len, const char *data, int data_len, int qos, int retain);
+
+/**
+ * @brief 停止捕获，把捕获数据写入flash分区并以base64输出到串口
+ * @return esp_err_t ESP_ERR_INVALID_STATE 表示未在捕获
+ */
+esp_err_t mqtt_capture_stop(void);
+
+/**
+ * @brief 获取捕获统计信息
+ * @param stats 输出统计信息
+ */
+void mqtt_capture_get_stats(mqtt_capture_stats_t *stats);
+
+/**
+ * @brief 映射flash分区中保存的捕获数据
+ * @param data 输出捕获数据（含文件头），在 mqtt_capture_unmap 前有效
+ * @param len 输出捕获数据字节数
+ * @return esp_err_t ESP_ERR_NOT_FOUND 表示分区不存在或没有有效的捕获数据
+ */
+esp_err_t mqtt_capture_map(const uint8_t **data, size_t *len);
+
+// 释放 mqtt_capture_map 的映射
+void mqtt_capture_unmap(void);
+
+/**
+ * @brief 校验捕获数据的文件头
+ * @param data 捕获数据
+ * @param len 捕获数据字节数
+ * @return true 文件头有效且数据完整
+ */
+bool mqtt_capture_validate(const uint8_t *data, size_t len);
+
+#endif /* MQTT_CAPTURE_H */
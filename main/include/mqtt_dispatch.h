@@ -0,0 +1,111 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#ifndef MQTT_DISPATCH_H
+#define MQTT_DISPATCH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "event_system.h"
+#include "esp32_mqtt_client.h"
+
+// 可注册的最大路由数
+#define MQTT_DISPATCH_MAX_ROUTES 256
+
+// 可注册的最大通配符订阅数
+#define MQTT_DISPATCH_MAX_WILDCARDS 8
+
+// 变化检测策略：解析结果与上一次相同时不发布UI更新
+typedef enum {
+    MQTT_CHANGE_ALWAYS,         // 每条消息都发布
+    MQTT_CHANGE_STR,            // 按字符串值比对（解析函数须输出 UI_VALUE_STR）
+    MQTT_CHANGE_INT,            // 按 int_value 比对
+} mqtt_change_policy_t;
+
+/**
+ * @brief 路由解析函数
+ * @param msg 收到的MQTT消息
+ * @param update 输出的UI更新，type 已由分发器按路由填好
+ * @return true 发布 update，false 不发布（解析失败或只做副作用处理）
+ */
+typedef bool (*mqtt_route_parser_t)(const mqtt_message_t *msg, ui_update_t *update);
+
+// 主题路由表项
+typedef struct {
+    const char *topic;                  // 完整主题（不支持通配符）
+    int qos;                            // 订阅QoS
+    ui_update_type_t ui_type;           // 解析结果对应的UI更新类型
+    mqtt_route_parser_t parser;         // 解析函数
+    mqtt_change_policy_t change_policy; // 变化检测策略
+    event_lane_t lane;                  // 消息投递的优先级通道
+} mqtt_route_t;
+
+/**
+ * @brief 注册一组主题路由（routes 须为静态存储，须在MQTT连接前注册）
+ * @param routes 路由表
+ * @param count 路由数量
+ * @return esp_err_t 错误码
+ */
+esp_err_t mqtt_dispatch_register(const mqtt_route_t *routes, size_t count);
+
+/**
+ * @brief 注册通配符订阅（filters 须为静态存储），被覆盖的路由不再单独订阅，
+ *        收到的消息仍只按路由表精确匹配，未命中路由的消息在本地丢弃
+ * @param filters 订阅过滤器（支持 '+' 和 '#'）
+ * @param count 过滤器数量
+ * @return esp_err_t 错误码
+ */
+esp_err_t mqtt_dispatch_register_wildcards(const esp_mqtt_topic_t *filters, size_t count);
+
+/**
+ * @brief 判断主题是否匹配订阅过滤器
+ * @param filter 订阅过滤器，'+' 匹配一级，'#' 匹配其后所有层级
+ * @param topic 主题（无需以 '\0' 结尾）
+ * @param topic_len 主题长度
+ * @return true 匹配
+ */
+bool mqtt_dispatch_topic_matches(const char *filter, const char *topic, size_t topic_len);
+
+/**
+ * @brief 按路由表和通配符生成订阅列表：先列出至少覆盖一条路由的通配符，再列出未被覆盖的路由
+ * @param topics 输出订阅列表，filter 指向路由表或通配符表中的字符串
+ * @param max 列表容量
+ * @return size_t 订阅数量
+ */
+size_t mqtt_dispatch_build_subscriptions(esp_mqtt_topic_t *topics, size_t max);
+
+/**
+ * @brief 按主题分发MQTT消息，查找耗时与路由数量无关
+ * @param msg MQTT消息
+ * @return esp_err_t ESP_ERR_NOT_FOUND 表示没有匹配的路由
+ */
+esp_err_t mqtt_dispatch_message(const mqtt_message_t *msg);
+
+/**
+ * @brief 查询主题所属的优先级通道，在 esp-mqtt 回调中投递消息前调用
+ * @param topic 主题（无需以 '\0' 结尾）
+ * @param topic_len 主题长度
+ * @param lane 输出路由配置的通道
+ * @return true 有匹配的路由，false 没有（消息应在本地丢弃）
+ */
+bool mqtt_dispatch_lane(const char *topic, size_t topic_len, event_lane_t *lane);
+
+/**
+ * @brief 获取已注册的路由数量
+ * @return size_t 路由数量
+ */
+size_t mqtt_dispatch_route_count(void);
+
+/**
+ * @brief 按注册顺序获取路由，用于生成订阅列表
+ * @param index 路由序号
+ * @return const mqtt_route_t* 路由，越界返回 NULL
+ */
+const mqtt_route_t *mqtt_dispatch_get_route(size_t index);
+
+#endif /* MQTT_DISPATCH_H */
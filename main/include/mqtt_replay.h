@@ -0,0 +1,63 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#ifndef MQTT_REPLAY_H
+#define MQTT_REPLAY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+// 回放倍速取该值表示不等待，尽快注入
+#define MQTT_REPLAY_SPEED_MAX 0
+
+// 单次回放结果
+typedef struct {
+    uint32_t messages;      // 成功注入的消息数
+    uint32_t ring_full;     // 环形缓冲区已满而丢弃的消息数
+    uint32_t elapsed_us;    // 从第一条注入到流水线处理完毕的耗时（微秒）
+    uint32_t throughput;    // 吞吐量（消息/秒）
+} mqtt_replay_result_t;
+
+/**
+ * @brief 按文本流量样本回放MQTT消息，经环形缓冲区、门铃事件、路由分发直到UI更新通道
+ *
+ * 样本每行格式为 "<距上一条的毫秒数> <主题> <数据>"，以 '#' 开头的行为注释。
+ * 回放期间不得启动MQTT客户端（入站环形缓冲区只允许一个生产者）。
+ *
+ * @param trace 样本文本
+ * @param len 样本长度
+ * @param speed 回放倍速，MQTT_REPLAY_SPEED_MAX 表示不等待
+ * @param loops 重复回放次数
+ * @param result 输出回放结果，可为 NULL
+ * @return esp_err_t 错误码
+ */
+esp_err_t mqtt_replay_run(const char *trace, size_t len, uint32_t speed, uint32_t loops,
+                          mqtt_replay_result_t *result);
+
+/**
+ * @brief 按二进制捕获数据（见 mqtt_capture.h）回放MQTT消息，保留微秒级时间间隔、QoS和保留标志
+ *
+ * 与 mqtt_replay_run 相同，回放期间不得启动MQTT客户端。
+ *
+ * @param capture 捕获数据（含文件头）
+ * @param len 捕获数据字节数
+ * @param speed 回放倍速，MQTT_REPLAY_SPEED_MAX 表示不等待
+ * @param loops 重复回放次数
+ * @param result 输出回放结果，可为 NULL
+ * @return esp_err_t ESP_ERR_INVALID_ARG 表示捕获数据无效
+ */
+esp_err_t mqtt_replay_run_capture(const uint8_t *capture, size_t len, uint32_t speed, uint32_t loops,
+                                  mqtt_replay_result_t *result);
+
+/**
+ * @brief 回放基准测试任务：依次以1倍速、10倍速和最高速回放 mqttcap 分区中的捕获数据（没有时回放内置样本），打印吞吐量、
+ *        队列占用、负载分配和延迟分位数，完成后删除自身
+ * @param arg 任务参数（未使用）
+ */
+void mqtt_replay_task(void *arg);
+
+#endif /* MQTT_REPLAY_H */
@@ -0,0 +1,71 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#ifndef MQTT_RING_H
+#define MQTT_RING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp32_mqtt_client.h"
+
+// 单生产者/单消费者的MQTT消息环形缓冲区
+// 生产者为 esp-mqtt 任务，消费者为事件处理任务，读写两端各自只修改自己的索引，无需加锁
+typedef struct mqtt_ring mqtt_ring_t;
+
+// 环形缓冲区统计信息
+typedef struct {
+    uint32_t capacity;      // 缓冲区字节数
+    uint32_t used;          // 当前占用字节数
+    uint32_t written;       // 写入的消息数
+    uint32_t dropped;       // 因空间不足丢弃的消息数
+    uint32_t high_water;    // 最大占用字节数
+} mqtt_ring_stats_t;
+
+/**
+ * @brief 创建环形缓冲区（优先分配在 PSRAM）
+ * @param capacity 缓冲区字节数，向上取整为2的幂
+ * @return mqtt_ring_t* 环形缓冲区，失败返回 NULL
+ */
+mqtt_ring_t *mqtt_ring_create(size_t capacity);
+
+/**
+ * @brief 写入一条消息，主题和数据连续存放为一条带长度前缀的记录（仅生产者调用）
+ * @param ring 环形缓冲区
+ * @param topic 主题（无需以 '\0' 结尾）
+ * @param topic_len 主题长度
+ * @param data 数据
+ * @param data_len 数据长度
+ * @param qos QoS等级
+ * @param retain 保留标志
+ * @param recv_time 接收时间戳（微秒）
+ * @return true 写入成功，false 空间不足已丢弃
+ */
+bool mqtt_ring_write(mqtt_ring_t *ring, const char *topic, int topic_len, const char *data, int data_len,
+                     int qos, int retain, uint32_t recv_time);
+
+/**
+ * @brief 查看最早的一条消息，msg 的主题和数据直接指向缓冲区，调用 mqtt_ring_pop 前有效（仅消费者调用）
+ * @param ring 环形缓冲区
+ * @param msg 输出消息视图，主题和数据均以 '\0' 结尾
+ * @return true 有消息，false 缓冲区为空
+ */
+bool mqtt_ring_peek(mqtt_ring_t *ring, mqtt_message_t *msg);
+
+/**
+ * @brief 释放 mqtt_ring_peek 返回的消息所占空间（仅消费者调用）
+ * @param ring 环形缓冲区
+ */
+void mqtt_ring_pop(mqtt_ring_t *ring);
+
+/**
+ * @brief 获取环形缓冲区统计信息
+ * @param ring 环形缓冲区
+ * @param stats 输出统计信息
+ */
+void mqtt_ring_get_stats(mqtt_ring_t *ring, mqtt_ring_stats_t *stats);
+
+#endif /* MQTT_RING_H */
@@ -0,0 +1,55 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#ifndef NET_REACHABILITY_H
+#define NET_REACHABILITY_H
+
+#include <stdbool.h>
+#include "esp_err.h"
+
+/**
+ * @brief 网络连通状态
+ */
+typedef enum {
+    NET_STATE_LINK_DOWN,        // WiFi 未连接或未获得IP
+    NET_STATE_UNKNOWN,          // 已获得IP，但最近没有请求确认连通（或确认已过期）
+    NET_STATE_ONLINE,           // 最近的请求成功
+    NET_STATE_OFFLINE,          // 连续请求失败，退避期间跳过请求
+} net_state_t;
+
+/**
+ * @brief 注册 WiFi/IP 事件，须在默认事件循环创建后、启动WiFi前调用
+ * @return esp_err_t 错误码
+ */
+esp_err_t net_reachability_init(void);
+
+/**
+ * @brief 是否应发出网络请求：未连接或处于离线退避期间返回 false，
+ *        退避结束后放行请求作为探测，由其结果决定是否恢复
+ * @return true 可以发出请求
+ */
+bool net_reachability_allow_request(void);
+
+/**
+ * @brief 报告一次请求的结果
+ * @param reachable 服务器有响应（包括错误状态码）为 true，连接失败或超时为 false
+ */
+void net_reachability_report(bool reachable);
+
+/**
+ * @brief 获取当前缓存的连通状态
+ * @return net_state_t 状态
+ */
+net_state_t net_reachability_get_state(void);
+
+/**
+ * @brief 状态名称，用于日志
+ * @param state 状态
+ * @return const char* 名称
+ */
+const char *net_reachability_state_name(net_state_t state);
+
+#endif /* NET_REACHABILITY_H */
@@ -0,0 +1,73 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#ifndef PLAYBACK_CLOCK_H
+#define PLAYBACK_CLOCK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// 本地播放时钟：按最近一次同步的播放位置加上经过的时间推算当前位置
+// 由事件处理任务同步，LVGL 任务每帧读取
+
+// 播放进度的满值，与 main.xml 中进度弧的 max_value 一致
+#define PLAYBACK_PROGRESS_MAX 10000
+
+// 同步误差超过该值（毫秒）视为跳转，直接对齐
+#define PLAYBACK_CLOCK_SNAP_MS 1000
+
+/**
+ * @brief 按收到的精确播放位置同步时钟
+ *
+ * 误差在 PLAYBACK_CLOCK_SNAP_MS 以内时只修正一半，用于平滑消息延迟抖动；
+ * 首次精确同步、暂停中或误差更大时直接对齐。
+ *
+ * @param position_ms 播放位置（毫秒）
+ * @param at_us 该位置对应的时间戳（微秒，esp_timer 低32位），通常为消息接收时间
+ */
+void playback_clock_sync(uint32_t position_ms, uint32_t at_us);
+
+/**
+ * @brief 按收到的粗粒度播放位置校验时钟，推算位置明显偏离时才对齐
+ * @param position_ms 截断后的播放位置（毫秒），实际位置在 [position_ms, position_ms + window_ms) 内
+ * @param window_ms 截断粒度（毫秒），如 "mm:ss" 为1000
+ * @param at_us 该位置对应的时间戳（微秒，esp_timer 低32位）
+ */
+void playback_clock_sync_coarse(uint32_t position_ms, uint32_t window_ms, uint32_t at_us);
+
+/**
+ * @brief 时钟是否可用于本地推算显示（已同步且时长已知）
+ * @return true 可用
+ */
+bool playback_clock_active(void);
+
+/**
+ * @brief 设置当前曲目时长，推算的位置不会超过时长
+ * @param duration_ms 时长（毫秒），0 表示未知
+ */
+void playback_clock_set_duration(uint32_t duration_ms);
+
+/**
+ * @brief 设置播放状态，暂停时位置停在暂停时刻
+ * @param playing 是否正在播放
+ */
+void playback_clock_set_playing(bool playing);
+
+/**
+ * @brief 获取当前曲目时长
+ * @return uint32_t 时长（毫秒），0 表示未知
+ */
+uint32_t playback_clock_duration(void);
+
+/**
+ * @brief 推算当前播放位置，与时长在同一次加锁中读取
+ * @param position_ms 输出播放位置（毫秒）
+ * @param duration_ms 输出曲目时长（毫秒），0 表示未知，可为 NULL
+ * @return true 时钟已同步过
+ */
+bool playback_clock_now(uint32_t *position_ms, uint32_t *duration_ms);
+
+#endif /* PLAYBACK_CLOCK_H */
@@ -21,6 +21,9 @@ void save_brightness_to_nvs(uint8_t brightness);
 // 设置背光亮度
 void set_backlight_brightness(uint8_t brightness);
 
+// 只设置背光PWM，不保存到NVS
+void apply_backlight_brightness(uint8_t brightness);
+
 // LCD初始化
 void lcd_init(void);
 
@@ -0,0 +1,78 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#ifndef UI_UPDATE_CHANNEL_H
+#define UI_UPDATE_CHANNEL_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "event_system.h"
+
+// 开关状态按索引单独占用槽位，避免不同开关的更新互相覆盖
+#define UI_CHANNEL_SWITCH_COUNT 8
+
+// 槽位总数：每种UI更新类型一个槽位，外加每个开关一个槽位
+#define UI_CHANNEL_SLOT_COUNT (UI_UPDATE_TYPE_MAX + UI_CHANNEL_SWITCH_COUNT)
+
+// 单个字符串值的最大容量（含 '\0'），各类型的实际容量见 ui_update_channel.c
+#define UI_CHANNEL_STR_MAX 256
+
+// UI更新通道统计信息
+typedef struct {
+    uint32_t published;     // 累计发布次数
+    uint32_t coalesced;     // 被后续值覆盖、未渲染即丢弃的次数
+    uint32_t applied;       // 累计应用到UI的次数
+    uint32_t deferred;      // 批量槽位因超出时间预算推迟到下一帧的次数
+    uint32_t truncated;     // 字符串超出该类型容量被截断的次数
+    uint32_t copied_bytes;  // 发布和取出时累计拷贝的字节数（含字符串）
+} ui_update_channel_stats_t;
+
+// UI更新应用回调，在 LVGL 任务中调用，字符串值只在回调期间有效
+typedef void (*ui_update_apply_cb_t)(const ui_update_t *update, void *ctx);
+
+/**
+ * @brief 初始化UI更新通道，按各类型的字符串容量划分字符串池
+ * @return esp_err_t 错误码
+ */
+esp_err_t ui_update_channel_init(void);
+
+/**
+ * @brief 发布UI更新（最新值覆盖未处理的旧值，不会阻塞；origin_time 为0时记为发布时刻）
+ *
+ * 字符串值按实际长度拷入该类型的字符串池，超出容量时在UTF-8字符边界截断。
+ *
+ * @param update UI更新数据，函数返回后调用者可复用 update 及其字符串
+ * @return esp_err_t 错误码
+ */
+esp_err_t ui_update_channel_publish(const ui_update_t *update);
+
+/**
+ * @brief 获取UI更新类型所属的优先级通道
+ * @param type UI更新类型
+ * @return event_lane_t 播放状态、音量、开关状态为交互通道，其余为批量通道
+ */
+event_lane_t ui_update_channel_lane(ui_update_type_t type);
+
+/**
+ * @brief 取出待处理的UI更新并逐个应用，每个槽位最多应用一次
+ *
+ * 交互通道的槽位全部应用；批量通道的槽位在 bulk_budget_us 内轮流应用，
+ * 至少应用一个，其余留到下一帧。
+ *
+ * @param apply 应用回调
+ * @param ctx 回调上下文
+ * @param bulk_budget_us 批量通道的时间预算（微秒）
+ * @return uint32_t 本次应用的更新数量
+ */
+uint32_t ui_update_channel_drain(ui_update_apply_cb_t apply, void *ctx, uint32_t bulk_budget_us);
+
+/**
+ * @brief 获取UI更新通道统计信息
+ * @param stats 输出统计信息
+ */
+void ui_update_channel_get_stats(ui_update_channel_stats_t *stats);
+
+#endif /* UI_UPDATE_CHANNEL_H */
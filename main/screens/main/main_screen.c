@@ -17,7 +17,9 @@
 #include "esp_task_wdt.h"
 #include "esp32_mqtt_client.h"
 #include "ui_common.h"
+#include "ui_throttle.h"
 #include "http_service.h"
+#include "http_async.h"
 #include "homeassistant.h"
 
 static const char *TAG = "main_screen";
@@ -112,43 +114,54 @@ lv_subject_t switch_4_state;
 lv_subject_t switch_5_state;
 lv_subject_t switch_6_state;
 
+// 拖动亮度滑块时每秒最多写一次NVS
+#define BRIGHTNESS_SAVE_RATE 1
+
+// 音量滑块和亮度滑块的限速输出
+static ui_throttle_t s_volume_throttle;
+static ui_throttle_t s_brightness_throttle;
+
+// 将0-100范围转换为65-255范围
+static uint8_t brightness_to_duty(int32_t brightness_value)
+{
+    return 65 + (brightness_value * 190) / 100;
+}
+
 // 亮度变化观察者回调函数
 static void brightness_observer_cb(lv_observer_t * observer, lv_subject_t * subject)
 {
     // 获取当前亮度值
     int32_t brightness_value = lv_subject_get_int(subject);
-    ESP_LOGI(TAG, "亮度值变化：%d", brightness_value);
     
-    // 将0-100范围转换为65-255范围
-    uint8_t actual_brightness = 65 + (brightness_value * 190) / 100;
-    
-    // 设置实际的背光亮度
-    set_backlight_brightness(actual_brightness);
+    // 立即设置背光，NVS由限速输出保存
+    apply_backlight_brightness(brightness_to_duty(brightness_value));
 }
 
-// 音量滑块松开事件回调函数
-static void volume_slider_release_cb(lv_event_t *e)
+// 保存亮度值到NVS（限速输出回调）
+static void brightness_save_cb(int32_t brightness_value, void *ctx)
+{
+    set_backlight_brightness(brightness_to_duty(brightness_value));
+}
+
+// 发布音量（限速输出回调），拖动中也推送，让音箱跟随手指
+static void volume_publish_cb(int32_t volume_value, void *ctx)
 {
-    // 获取滑块对象
-    lv_obj_t *slider = lv_event_get_target(e);
-    
-    // 获取当前音量值
-    int32_t volume_value = lv_slider_get_value(slider);
-    
-    // 发布MQTT消息，只在松开时推送，减少性能开销
-    ESP_LOGI(TAG, "音量滑块松开：%d，推送MQTT消息", volume_value);
-    
     // 将音量值转换为字符串
     char volume_str[8];
     sprintf(volume_str, "%" PRId32 "", volume_value);
     
-    // 发布MQTT消息到音量设置主题
-    esp_err_t err = mqtt_client_publish("homeassistant/number/esp32_music_player/volume/set", volume_str, 0, false);
+    // 放入MQTT发送队列，不阻塞LVGL任务
+    esp_err_t err = mqtt_client_enqueue("homeassistant/number/esp32_music_player/volume/set", volume_str, 0, false);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "发布音量MQTT消息失败: %s", esp_err_to_name(err));
     }
 }
 
+bool main_screen_volume_busy(void)
+{
+    return ui_throttle_busy(&s_volume_throttle);
+}
+
 // 播放控制回调函数
 void play_prev_cb(lv_event_t *e)
 {
@@ -548,14 +561,18 @@ void init_main_screen_subjects(void)
 
 // XML加载结果结构体
 typedef struct {
-    char *xml_data;
+    const char *xml_data;           // 借出的响应内容，只在 on_xml_loaded 期间有效
     bool success;
+    bool not_modified;              // 服务器返回304：已注册的 "main" 组件仍是最新的，xml_data 为 NULL
 } xml_load_result_t;
 
-// 从网络加载XML文件函数已移除，改用 http_service.h 中的 http_send_request
+// 从网络加载XML文件函数已移除，改用 http_async.h 中的异步请求
+
+// 已注册的 "main" 组件对应的XML校验值，刷新时据此发送条件请求，注册失败时清零
+static http_validators_t s_xml_validators;
 
-// XML加载任务声明
-void load_xml_task(void *arg);
+// 启动XML加载请求
+static esp_err_t start_xml_load(void);
 
 // 刷新XML回调函数
 void refresh_xml_cb(lv_event_t *e)
@@ -571,10 +588,10 @@ void refresh_xml_cb(lv_event_t *e)
     // 清除当前屏幕上的所有对象
     lv_obj_clean(lv_screen_active());
     
-    // 创建XML加载任务，在后台执行网络请求
-    xTaskCreate(load_xml_task, "load_xml_task", 8192, NULL, 3, NULL);
-    
-    ESP_LOGI(TAG, "已启动XML刷新任务");
+    // 提交异步请求，在HTTP工作任务中执行网络请求
+    if (start_xml_load() == ESP_OK) {
+        ESP_LOGI(TAG, "已启动XML刷新请求");
+    }
 }
 
 // XML加载完成回调函数
@@ -597,10 +614,12 @@ void on_xml_loaded(xml_load_result_t *result)
     esp_task_wdt_reset();
     vTaskDelay(pdMS_TO_TICKS(1)); // 主动让出 CPU 一下
 
-    // 注册XML组件
-    if (lv_xml_register_component_from_data("main", result->xml_data) != LV_RES_OK) {
+    // 注册XML组件，XML未变化时直接使用已注册的组件，不再解析
+    if (result->not_modified) {
+        ESP_LOGI(TAG, "XML未变化，使用已注册的组件");
+    } else if (lv_xml_register_component_from_data("main", result->xml_data) != LV_RES_OK) {
         ESP_LOGE(TAG, "注册XML组件失败");
-        free(result->xml_data);
+        memset(&s_xml_validators, 0, sizeof(s_xml_validators));
         
         lv_obj_t *error_label = lv_label_create(lv_scr_act());
         lv_label_set_text(error_label, "XML Register Failed");
@@ -608,7 +627,6 @@ void on_xml_loaded(xml_load_result_t *result)
         
         return;
     }
-    free(result->xml_data);
     
     // 增加小延迟，让IDLE任务有机会执行
     vTaskDelay(pdMS_TO_TICKS(1));
@@ -664,12 +682,18 @@ void on_xml_loaded(xml_load_result_t *result)
     // 增加小延迟，让IDLE任务有机会执行
     vTaskDelay(pdMS_TO_TICKS(1));
     
-    // 查找音量滑块并添加松开事件回调
+    // 音量滑块拖动时限速推送MQTT消息，松开时推送最终值
     lv_obj_t *volume_slider = lv_obj_find_by_name(main_ui, "song_slider");
     if (volume_slider != NULL) {
-        ESP_LOGI(TAG, "找到音量滑块，添加松开事件回调");
-        // 添加松开事件回调，只在松开时推送MQTT消息
-        lv_obj_add_event_cb(volume_slider, volume_slider_release_cb, LV_EVENT_RELEASED, NULL);
+        ui_throttle_init(&s_volume_throttle, CONFIG_SMART_PANEL_SLIDER_PUBLISH_RATE, volume_publish_cb, NULL);
+        ui_throttle_attach_slider(&s_volume_throttle, volume_slider);
+    }
+    
+    // 亮度滑块拖动时限速保存到NVS，松开时保存最终值
+    lv_obj_t *brightness_slider = lv_obj_find_by_name(main_ui, "brightness_slider");
+    if (brightness_slider != NULL) {
+        ui_throttle_init(&s_brightness_throttle, BRIGHTNESS_SAVE_RATE, brightness_save_cb, NULL);
+        ui_throttle_attach_slider(&s_brightness_throttle, brightness_slider);
     }
     
     // 手动应用图标偏移 (解决 XML 无法处理 ICON_OFFSET 的问题)
@@ -740,39 +764,43 @@ void update_energy_display(float daily_energy, float monthly_energy)
              daily_energy, daily_cost, monthly_energy, monthly_cost);
 }
 
-// XML加载任务
-void load_xml_task(void *arg)
+// XML请求完成，在 LVGL 任务中执行
+static void on_xml_request_done(http_async_result_t *result, void *ctx)
 {
-    ESP_LOGI(TAG, "开始执行XML加载任务 (Network)");
+    ESP_LOGI(TAG, "XML请求完成: %s，耗时: %lld ms", esp_err_to_name(result->err),
+             (long long)(result->elapsed_us / 1000));
     
-    // 从网络加载XML文件
+    // 响应借自HTTP工作任务的缓冲区，on_xml_loaded 返回后归还
+    xml_load_result_t xml_result = {
+        .xml_data = result->response.data,
+        .not_modified = (result->err == ESP_ERR_HTTP_NOT_MODIFIED),
+    };
+    xml_result.success = (xml_result.xml_data != NULL) || xml_result.not_modified;
+    on_xml_loaded(&xml_result);
+}
+
+// 从网络加载XML文件
+static esp_err_t start_xml_load(void)
+{
     // 注意：请确保你的电脑/服务器IP地址正确，并且文件路径为 /main.xml
-    const char *xml_url = "http://192.168.1.218/main.xml";
-    
-    http_config_t http_cfg = {
-        .url = xml_url,
-        .method = HTTP_METHOD_GET,
-        .timeout_ms = 8000
+    http_async_request_t req = {
+        .http = {
+            .url = "http://192.168.1.218/main.xml",
+            .method = HTTP_METHOD_GET,
+            .timeout_ms = 8000,
+            .validators = &s_xml_validators,
+        },
+        .max_retries = 1,
+        .lane = EVENT_LANE_BULK,
     };
-    char *main_xml = http_send_request(&http_cfg);
-    
-    // 创建XML加载结果
-    xml_load_result_t *result = malloc(sizeof(xml_load_result_t));
-    if (result == NULL) {
-        ESP_LOGE(TAG, "分配XML加载结果内存失败");
-        if (main_xml) free(main_xml);
-        vTaskDelete(NULL);
-        return;
+    esp_err_t err = http_async_submit(&req, on_xml_request_done, NULL);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "提交XML加载请求失败: %s", esp_err_to_name(err));
+        lv_obj_t *error_label = lv_label_create(lv_scr_act());
+        lv_label_set_text(error_label, "XML Load Failed");
+        lv_obj_align(error_label, LV_ALIGN_CENTER, 0, 0);
     }
-    
-    result->xml_data = main_xml;
-    result->success = (main_xml != NULL);
-    
-    // 发送XML加载完成事件
-    event_system_post(EVENT_TYPE_XML_LOADED, result, sizeof(xml_load_result_t));
-    
-    ESP_LOGI(TAG, "XML加载任务完成");
-    vTaskDelete(NULL);
+    return err;
 }
 
 // 初始化主屏幕UI
@@ -790,9 +818,9 @@ void init_main_screen(void)
         return;
     }
     
-    // 创建XML加载任务，在后台执行网络请求
-    xTaskCreate(load_xml_task, "load_xml_task", 12288, NULL, 3, NULL);
-    
-    ESP_LOGI(TAG, "已启动XML加载任务");
+    // 提交异步请求，在HTTP工作任务中执行网络请求
+    if (start_xml_load() == ESP_OK) {
+        ESP_LOGI(TAG, "已启动XML加载请求");
+    }
 }
 
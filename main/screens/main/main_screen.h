@@ -12,8 +12,9 @@
 
 // XML加载结果结构体
 typedef struct {
-    char *xml_data;
+    const char *xml_data;           // 借出的响应内容，只在 on_xml_loaded 期间有效
     bool success;
+    bool not_modified;              // 服务器返回304：已注册的 "main" 组件仍是最新的，xml_data 为 NULL
 } xml_load_result_t;
 
 // 时间相关的Subject和缓冲区
@@ -57,6 +58,9 @@ extern void update_energy_display(float daily_energy, float monthly_energy);
 // 初始化主屏幕UI
 extern void init_main_screen(void);
 
+// 音量滑块是否正在拖动或刚松开，期间忽略设备回传的音量
+extern bool main_screen_volume_busy(void);
+
 // 初始化主屏幕Subject
 extern void init_main_screen_subjects(void);
 
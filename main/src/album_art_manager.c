@@ -12,6 +12,7 @@
 #include "jpeg_decoder.h"
 #include "lvgl.h"
 #include "event_system.h"
+#include "http_async.h"
 
 static const char *TAG = "ALBUM_ART";
 
@@ -35,6 +36,8 @@ typedef struct {
 static char s_current_cache_url[512] = {0};
 // 缓存槽位：0: 100x100
 static image_cache_t s_image_caches[1] = {0};
+// 缓存图片对应的下载响应的校验值，同一地址再次下载时服务器可返回304，只在本任务中访问
+static http_validators_t s_cover_validators;
 static SemaphoreHandle_t s_cache_mutex = NULL;
 
 // 专辑封面更新请求队列
@@ -76,65 +79,33 @@ static void url_encode(const char *src, char *dest) {
     *dest = '\0';
 }
 
-// Download URL content to buffer (caller must free)
-static uint8_t* download_url_to_buffer(const char* url, size_t* out_len) {
+// Download URL content (lent from the HTTP worker's buffer, caller must http_async_release)
+static esp_err_t download_url(const char* url, http_async_result_t* result) {
     ESP_LOGI(TAG, "Downloading from: %s", url);
     
-    esp_http_client_config_t config = {
-        .url = url,
-        .timeout_ms = 10000,
-        .buffer_size = 4096,
-        .buffer_size_tx = 1024,
+    // 经异步HTTP工作任务下载（复用连接池和响应缓冲区），本任务只等待结果
+    http_async_request_t req = {
+        .http = {
+            .url = url,
+            .method = HTTP_METHOD_GET,
+            .timeout_ms = 10000,
+            .validators = &s_cover_validators,
+        },
+        .max_retries = 1,
+        .lane = EVENT_LANE_BULK,
     };
-    
-    esp_http_client_handle_t client = esp_http_client_init(&config);
-    if (!client) {
-        ESP_LOGE(TAG, "Failed to init HTTP client");
-        return NULL;
-    }
-    
-    if (esp_http_client_open(client, 0) != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to open connection");
-        esp_http_client_cleanup(client);
-        return NULL;
-    }
-    
-    int content_length = esp_http_client_fetch_headers(client);
-    ESP_LOGI(TAG, "Content length: %d", content_length);
-    
-    if (content_length <= 0) {
-        content_length = 50 * 1024;
+    esp_err_t err = http_async_perform(&req, result);
+    if (err == ESP_ERR_HTTP_NOT_MODIFIED) {
+        ESP_LOGI(TAG, "Not modified, reusing cached image");
+        return err;
     }
-    
-    // 使用PSRAM分配内存
-    uint8_t* buffer = (uint8_t*)heap_caps_malloc(content_length, MALLOC_CAP_SPIRAM);
-    if (!buffer) {
-        ESP_LOGE(TAG, "Failed to allocate %d bytes from PSRAM", content_length);
-        esp_http_client_close(client);
-        esp_http_client_cleanup(client);
-        return NULL;
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Download failed: %s", esp_err_to_name(err));
+        return err;
     }
     
-    int total_read = 0;
-    while (1) {
-        int read_len = esp_http_client_read(client, (char*)buffer + total_read, content_length - total_read);
-        if (read_len > 0) {
-            total_read += read_len;
-        } else if (read_len == 0) {
-            break;
-        } else {
-            ESP_LOGE(TAG, "Error reading data");
-            break;
-        }
-        if (total_read >= content_length) break;
-    }
-    
-    esp_http_client_close(client);
-    esp_http_client_cleanup(client);
-    
-    *out_len = total_read;
-    ESP_LOGI(TAG, "Downloaded %d bytes", total_read);
-    return buffer;
+    ESP_LOGI(TAG, "Downloaded %d bytes", (int)result->response.len);
+    return ESP_OK;
 }
 
 // Parse JPEG header to get dimensions
@@ -258,8 +229,26 @@ static void album_art_task(void* pvParameters) {
                      
             ESP_LOGI(TAG, "下载地址: %s", convert_url);
             
-            size_t data_len = 0;
-            uint8_t* raw_data = download_url_to_buffer(convert_url, &data_len);
+            http_async_result_t download;
+            if (download_url(convert_url, &download) == ESP_ERR_HTTP_NOT_MODIFIED) {
+                // 与缓存的图片相同，不再下载和解码，重新显示缓存
+                init_cache_mutex();
+                xSemaphoreTake(s_cache_mutex, portMAX_DELAY);
+                if (s_image_caches[0].buffer != NULL) {
+                    s_image_caches[0].is_in_use = true;
+                    ui_update_t uu = {0};
+                    uu.type = UI_UPDATE_TYPE_ALBUM_ART;
+                    uu.tag = UI_VALUE_PTR;
+                    uu.value.ptr_value = s_image_caches[0].buffer;
+                    if (event_system_post_ui_update(&uu) != ESP_OK) {
+                        ESP_LOGE(TAG, "创建UI更新事件失败");
+                    }
+                }
+                xSemaphoreGive(s_cache_mutex);
+                continue;
+            }
+            const uint8_t* raw_data = (const uint8_t*)download.response.data;
+            size_t data_len = download.response.len;
             
             if (raw_data && data_len > 0) {
                 ESP_LOGI(TAG, "下载成功，数据长度: %d bytes", data_len);
@@ -279,7 +268,7 @@ static void album_art_task(void* pvParameters) {
                 int out_w, out_h;
                 ESP_LOGI(TAG, "开始解码JPEG图片");
                 uint16_t* rgb565 = decode_jpg_to_rgb565(raw_data, data_len, &out_w, &out_h);
-                heap_caps_free(raw_data);
+                http_async_release(&download); // 解码完成后立即归还下载缓冲区
                 
                 if (rgb565) {
                     ESP_LOGI(TAG, "JPEG解码成功，尺寸: %dx%d", out_w, out_h);
@@ -294,13 +283,12 @@ static void album_art_task(void* pvParameters) {
                     s_image_caches[0].is_in_use = true; // 标记为正在使用
                     
                     // 发送 UI 更新事件
-                    ui_update_t *uu = malloc(sizeof(ui_update_t));
-                    if (uu) {
-                        uu->type = UI_UPDATE_TYPE_ALBUM_ART;
-                        uu->value.ptr_value = rgb565;
-                        ESP_LOGI(TAG, "发送UI更新事件，数据指针: %p", rgb565);
-                        event_system_post(EVENT_TYPE_UI_UPDATE, uu, sizeof(ui_update_t));
-                        
+                    ui_update_t uu = {0};
+                    uu.type = UI_UPDATE_TYPE_ALBUM_ART;
+                    uu.tag = UI_VALUE_PTR;
+                    uu.value.ptr_value = rgb565;
+                    ESP_LOGI(TAG, "发送UI更新事件，数据指针: %p", rgb565);
+                    if (event_system_post_ui_update(&uu) == ESP_OK) {
                         // 等待一小段时间，确保UI线程已经获取到新的图片数据
                         vTaskDelay(pdMS_TO_TICKS(100));
                         
@@ -312,6 +300,7 @@ static void album_art_task(void* pvParameters) {
                     } else {
                         ESP_LOGE(TAG, "创建UI更新事件失败");
                         heap_caps_free(rgb565);
+                        memset(&s_cover_validators, 0, sizeof(s_cover_validators)); // 校验值属于刚丢弃的图片
                         s_image_caches[0].buffer = old_buffer; // 恢复旧的缓存
                         if (s_image_caches[0].buffer) {
                             s_image_caches[0].is_in_use = true;
@@ -319,13 +308,12 @@ static void album_art_task(void* pvParameters) {
                     }
                 } else {
                     ESP_LOGE(TAG, "JPEG解码失败");
+                    memset(&s_cover_validators, 0, sizeof(s_cover_validators));
                 }
                 xSemaphoreGive(s_cache_mutex);
             } else {
                 ESP_LOGE(TAG, "下载失败，数据为空或长度为0");
-                if (raw_data) {
-                    heap_caps_free(raw_data);
-                }
+                http_async_release(&download);
             }
             
             ESP_LOGI(TAG, "专辑封面请求处理完成");
@@ -349,12 +337,11 @@ void request_album_art_update(const char* raw_url, int width, int height, bool i
         if (s_image_caches[0].buffer != NULL) {
             ESP_LOGI(TAG, "Cache hit for URL: %s", raw_url);
             s_image_caches[0].is_in_use = true; // 标记为正在使用
-            ui_update_t *uu = malloc(sizeof(ui_update_t));
-            if (uu) {
-                uu->type = UI_UPDATE_TYPE_ALBUM_ART;
-                uu->value.ptr_value = s_image_caches[0].buffer;
-                event_system_post(EVENT_TYPE_UI_UPDATE, uu, sizeof(ui_update_t));
-            } else {
+            ui_update_t uu = {0};
+            uu.type = UI_UPDATE_TYPE_ALBUM_ART;
+            uu.tag = UI_VALUE_PTR;
+            uu.value.ptr_value = s_image_caches[0].buffer;
+            if (event_system_post_ui_update(&uu) != ESP_OK) {
                 ESP_LOGE(TAG, "创建UI更新事件失败");
             }
             xSemaphoreGive(s_cache_mutex);
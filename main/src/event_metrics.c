@@ -0,0 +1,235 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "cJSON.h"
+#include "event_metrics.h"
+#include "esp32_mqtt_client.h"
+
+static const char *TAG = "event_metrics";
+
+// 对数分桶直方图
+typedef struct {
+    uint32_t buckets[EVENT_METRICS_BUCKETS];
+    uint32_t count;
+    uint32_t max_us;
+} latency_hist_t;
+
+static latency_hist_t s_event_hist[EVENT_TYPE_MAX][EVENT_METRIC_KIND_MAX];
+static latency_hist_t s_ui_hist[UI_UPDATE_TYPE_MAX][EVENT_METRIC_KIND_MAX];
+
+// 保护直方图的自旋锁
+static portMUX_TYPE s_metrics_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// 指标名称，用于日志和JSON
+static const char *const s_kind_names[EVENT_METRIC_KIND_MAX] = {
+    "wait", "handler", "e2e",
+};
+
+static const char *const s_event_names[EVENT_TYPE_MAX] = {
+    "wifi_connected", "wifi_disconnected", "button_click", "touch_event",
+    "load_xml", "xml_loaded", "refresh_xml", "ntp_time_updated",
+    "mqtt_connected", "mqtt_disconnected", "mqtt_message", "ui_update",
+    "http_complete",
+};
+
+static const char *const s_ui_names[UI_UPDATE_TYPE_MAX] = {
+    "lyrics", "song_name", "artist", "play_progress", "volume", "song_time",
+    "power", "energy", "daily_energy", "monthly_energy", "weather_desc",
+    "weather_temp", "weather_hum", "indoor_temp", "indoor_hum", "album_art",
+    "play_state", "switch_state",
+};
+
+_Static_assert(sizeof(s_event_names) / sizeof(s_event_names[0]) == EVENT_TYPE_MAX, "事件名称表与 event_type_t 不一致");
+_Static_assert(sizeof(s_ui_names) / sizeof(s_ui_names[0]) == UI_UPDATE_TYPE_MAX, "UI更新名称表与 ui_update_type_t 不一致");
+
+// 计算样本所在的桶
+static int bucket_index(uint32_t us)
+{
+    if (us < 2) {
+        return 0;
+    }
+    int index = 31 - __builtin_clz(us);
+    return (index < EVENT_METRICS_BUCKETS) ? index : EVENT_METRICS_BUCKETS - 1;
+}
+
+static void hist_record(latency_hist_t *hist, uint32_t us)
+{
+    int index = bucket_index(us);
+    portENTER_CRITICAL(&s_metrics_lock);
+    hist->buckets[index]++;
+    hist->count++;
+    if (us > hist->max_us) {
+        hist->max_us = us;
+    }
+    portEXIT_CRITICAL(&s_metrics_lock);
+}
+
+// 从直方图计算摘要，百分位取所在桶的上界（不超过最大值）
+static void hist_summarize(const latency_hist_t *hist, event_metric_summary_t *summary)
+{
+    latency_hist_t snapshot;
+    portENTER_CRITICAL(&s_metrics_lock);
+    snapshot = *hist;
+    portEXIT_CRITICAL(&s_metrics_lock);
+
+    memset(summary, 0, sizeof(*summary));
+    summary->count = snapshot.count;
+    summary->max_us = snapshot.max_us;
+    if (snapshot.count == 0) {
+        return;
+    }
+
+    uint32_t p50_rank = (snapshot.count + 1) / 2;
+    uint32_t p99_rank = snapshot.count - snapshot.count / 100;
+    uint32_t seen = 0;
+    bool p50_done = false;
+    for (int i = 0; i < EVENT_METRICS_BUCKETS; i++) {
+        seen += snapshot.buckets[i];
+        uint32_t upper = (i == EVENT_METRICS_BUCKETS - 1) ? snapshot.max_us : (2u << i) - 1;
+        if (upper > snapshot.max_us) {
+            upper = snapshot.max_us;
+        }
+        if (!p50_done && seen >= p50_rank) {
+            summary->p50_us = upper;
+            p50_done = true;
+        }
+        if (seen >= p99_rank) {
+            summary->p99_us = upper;
+            break;
+        }
+    }
+}
+
+void event_metrics_record_event(event_type_t type, event_metric_kind_t kind, uint32_t us)
+{
+    if (type >= EVENT_TYPE_MAX || kind >= EVENT_METRIC_KIND_MAX) {
+        return;
+    }
+    hist_record(&s_event_hist[type][kind], us);
+}
+
+void event_metrics_record_ui(ui_update_type_t type, event_metric_kind_t kind, uint32_t us)
+{
+    if (type >= UI_UPDATE_TYPE_MAX || kind >= EVENT_METRIC_KIND_MAX) {
+        return;
+    }
+    hist_record(&s_ui_hist[type][kind], us);
+}
+
+void event_metrics_get_event_summary(event_type_t type, event_metric_kind_t kind, event_metric_summary_t *summary)
+{
+    if (summary == NULL) {
+        return;
+    }
+    if (type >= EVENT_TYPE_MAX || kind >= EVENT_METRIC_KIND_MAX) {
+        memset(summary, 0, sizeof(*summary));
+        return;
+    }
+    hist_summarize(&s_event_hist[type][kind], summary);
+}
+
+void event_metrics_get_ui_summary(ui_update_type_t type, event_metric_kind_t kind, event_metric_summary_t *summary)
+{
+    if (summary == NULL) {
+        return;
+    }
+    if (type >= UI_UPDATE_TYPE_MAX || kind >= EVENT_METRIC_KIND_MAX) {
+        memset(summary, 0, sizeof(*summary));
+        return;
+    }
+    hist_summarize(&s_ui_hist[type][kind], summary);
+}
+
+void event_metrics_dump(void)
+{
+    event_metric_summary_t summary;
+
+    ESP_LOGI(TAG, "%-18s %-8s %8s %10s %10s %10s", "name", "metric", "count", "p50(us)", "p99(us)", "max(us)");
+    for (int type = 0; type < EVENT_TYPE_MAX; type++) {
+        for (int kind = 0; kind < EVENT_METRIC_KIND_MAX; kind++) {
+            hist_summarize(&s_event_hist[type][kind], &summary);
+            if (summary.count > 0) {
+                ESP_LOGI(TAG, "%-18s %-8s %8u %10u %10u %10u", s_event_names[type], s_kind_names[kind],
+                         (unsigned int)summary.count, (unsigned int)summary.p50_us,
+                         (unsigned int)summary.p99_us, (unsigned int)summary.max_us);
+            }
+        }
+    }
+    for (int type = 0; type < UI_UPDATE_TYPE_MAX; type++) {
+        for (int kind = 0; kind < EVENT_METRIC_KIND_MAX; kind++) {
+            hist_summarize(&s_ui_hist[type][kind], &summary);
+            if (summary.count > 0) {
+                ESP_LOGI(TAG, "ui.%-15s %-8s %8u %10u %10u %10u", s_ui_names[type], s_kind_names[kind],
+                         (unsigned int)summary.count, (unsigned int)summary.p50_us,
+                         (unsigned int)summary.p99_us, (unsigned int)summary.max_us);
+            }
+        }
+    }
+}
+
+// 将一组直方图写入JSON对象：{"name":{"metric":[count,p50,p99,max]}}
+static void add_hist_group(cJSON *parent, const char *group, latency_hist_t (*hists)[EVENT_METRIC_KIND_MAX],
+                           const char *const *names, int count)
+{
+    cJSON *group_obj = cJSON_AddObjectToObject(parent, group);
+    if (group_obj == NULL) {
+        return;
+    }
+
+    event_metric_summary_t summary;
+    for (int type = 0; type < count; type++) {
+        cJSON *type_obj = NULL;
+        for (int kind = 0; kind < EVENT_METRIC_KIND_MAX; kind++) {
+            hist_summarize(&hists[type][kind], &summary);
+            if (summary.count == 0) {
+                continue;
+            }
+            if (type_obj == NULL) {
+                type_obj = cJSON_AddObjectToObject(group_obj, names[type]);
+                if (type_obj == NULL) {
+                    return;
+                }
+            }
+            int values[4] = {(int)summary.count, (int)summary.p50_us, (int)summary.p99_us, (int)summary.max_us};
+            cJSON_AddItemToObject(type_obj, s_kind_names[kind], cJSON_CreateIntArray(values, 4));
+        }
+    }
+}
+
+esp_err_t event_metrics_publish(void)
+{
+    cJSON *root = cJSON_CreateObject();
+    if (root == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    add_hist_group(root, "event", s_event_hist, s_event_names, EVENT_TYPE_MAX);
+    add_hist_group(root, "ui", s_ui_hist, s_ui_names, UI_UPDATE_TYPE_MAX);
+
+    char *payload = cJSON_PrintUnformatted(root);
+    cJSON_Delete(root);
+    if (payload == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t err = mqtt_client_publish(EVENT_METRICS_MQTT_TOPIC, payload, 0, false);
+    cJSON_free(payload);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "发布延迟统计失败: %s", esp_err_to_name(err));
+    }
+    return err;
+}
+
+void event_metrics_reset(void)
+{
+    portENTER_CRITICAL(&s_metrics_lock);
+    memset(s_event_hist, 0, sizeof(s_event_hist));
+    memset(s_ui_hist, 0, sizeof(s_ui_hist));
+    portEXIT_CRITICAL(&s_metrics_lock);
+}
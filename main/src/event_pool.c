@@ -0,0 +1,114 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "event_pool.h"
+
+static const char *TAG = "event_pool";
+
+_Static_assert(EVENT_POOL_SLOT_COUNT <= 32, "空闲位图为 uint32_t，槽位数不能超过32");
+
+// 槽位存储，按8字节对齐以便存放任意负载结构体
+typedef struct {
+    uint8_t data[EVENT_POOL_SLOT_SIZE];
+} __attribute__((aligned(8))) event_pool_slot_t;
+
+static event_pool_slot_t s_slots[EVENT_POOL_SLOT_COUNT];
+
+// 空闲槽位位图，置1表示空闲
+static uint32_t s_free_mask = (uint32_t)((1ULL << EVENT_POOL_SLOT_COUNT) - 1);
+
+// 统计信息
+static uint32_t s_in_use = 0;
+static uint32_t s_high_water = 0;
+static uint32_t s_acquired = 0;
+static uint32_t s_heap_fallbacks = 0;
+
+// 保护位图和统计信息的自旋锁
+static portMUX_TYPE s_pool_lock = portMUX_INITIALIZER_UNLOCKED;
+
+bool event_pool_owns(const void *ptr)
+{
+    const uint8_t *p = (const uint8_t *)ptr;
+    const uint8_t *begin = (const uint8_t *)&s_slots[0];
+    const uint8_t *end = (const uint8_t *)&s_slots[EVENT_POOL_SLOT_COUNT];
+    return p >= begin && p < end;
+}
+
+void *event_pool_alloc(size_t size)
+{
+    if (size == 0) {
+        return NULL;
+    }
+
+    if (size <= EVENT_POOL_SLOT_SIZE) {
+        int index = -1;
+        portENTER_CRITICAL(&s_pool_lock);
+        if (s_free_mask != 0) {
+            index = __builtin_ctz(s_free_mask);
+            s_free_mask &= ~(1u << index);
+            s_in_use++;
+            s_acquired++;
+            if (s_in_use > s_high_water) {
+                s_high_water = s_in_use;
+            }
+        }
+        portEXIT_CRITICAL(&s_pool_lock);
+
+        if (index >= 0) {
+            return s_slots[index].data;
+        }
+    }
+
+    // 池耗尽或负载过大，回退到堆分配
+    portENTER_CRITICAL(&s_pool_lock);
+    s_heap_fallbacks++;
+    portEXIT_CRITICAL(&s_pool_lock);
+    ESP_LOGD(TAG, "事件负载池回退到堆分配: %u 字节", (unsigned int)size);
+    return malloc(size);
+}
+
+void event_pool_free(void *ptr)
+{
+    if (ptr == NULL) {
+        return;
+    }
+
+    if (!event_pool_owns(ptr)) {
+        free(ptr);
+        return;
+    }
+
+    int index = (event_pool_slot_t *)ptr - s_slots;
+    portENTER_CRITICAL(&s_pool_lock);
+    if (s_free_mask & (1u << index)) {
+        portEXIT_CRITICAL(&s_pool_lock);
+        ESP_LOGE(TAG, "重复释放事件负载槽位: %d", index);
+        return;
+    }
+    s_free_mask |= (1u << index);
+    s_in_use--;
+    portEXIT_CRITICAL(&s_pool_lock);
+}
+
+void event_pool_get_stats(event_pool_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+
+    portENTER_CRITICAL(&s_pool_lock);
+    stats->capacity = EVENT_POOL_SLOT_COUNT;
+    stats->slot_size = EVENT_POOL_SLOT_SIZE;
+    stats->in_use = s_in_use;
+    stats->high_water = s_high_water;
+    stats->acquired = s_acquired;
+    stats->heap_fallbacks = s_heap_fallbacks;
+    portEXIT_CRITICAL(&s_pool_lock);
+}
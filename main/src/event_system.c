@@ -7,26 +7,44 @@
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
-#include "cJSON.h"
+#include "sdkconfig.h"
 #include "event_system.h"
 #include "esp_log.h"
+#include "esp_heap_caps.h"
 #include "lvgl.h"
 #include "ntp_time.h"
 #include "esp_task_wdt.h"
 #include "esp32_mqtt_client.h"
 #include "http_service.h" // Added as per instruction
+#include "http_async.h"
+#include "net_reachability.h"
 #include "homeassistant.h"
 #include "album_art_manager.h"
 #include "ui_common.h"
+#include "event_pool.h"
+#include "ui_update_channel.h"
+#include "mqtt_dispatch.h"
+#include "event_metrics.h"
+#include "mqtt_ring.h"
+#include "json_extract.h"
+#include "json_stream.h"
+#include "lyrics_player.h"
+#include "playback_clock.h"
+#if CONFIG_SMART_PANEL_HA_WEBSOCKET
+#include "ha_websocket.h"
+#endif
+#include "freertos/semphr.h"
 
 static const char *TAG = "event_system";
 
 // 外部WiFi状态检查函数
 extern bool is_wifi_connected(void);
 
-// 事件队列句柄
-QueueHandle_t g_system_event_queue = NULL;    // 系统事件队列
-QueueHandle_t g_ui_event_queue = NULL;        // UI事件队列
+// 事件队列：每个队列分交互和批量两个通道
+static QueueHandle_t s_lanes[EVENT_QUEUE_MAX][EVENT_LANE_MAX];
+
+// 队列门铃：任一通道有新事件时唤醒消费者
+static SemaphoreHandle_t s_doorbells[EVENT_QUEUE_MAX];
 
 // 外部变量声明
 extern lv_subject_t song_lyrics_subject;
@@ -48,13 +66,6 @@ extern lv_subject_t indoor_temp_subject;
 extern lv_subject_t indoor_hum_subject;
 
 // 当前值存储，用于数据比对
-static char current_song_lyrics[256] = "";
-static char current_song_name[128] = "";
-static char current_song_artist[128] = "";
-static char current_song_time[32] = "";
-static int current_play_progress = -1;
-static int current_volume = -1;
-static float current_power = -1.0;
 static float current_daily_energy = -1.0;
 static float current_monthly_energy = -1.0;
 
@@ -65,6 +76,30 @@ static char current_indoor_hum[16] = "";
 // 24小时天气数据存储
 static hourly_weather_t g_24h_weather_data[24];
 static int g_24h_weather_count = 0;
+// 每条天气数据的小时（time 字段），无法解析时为 -1
+static int g_24h_weather_hour[24];
+// g_24h_weather_data 对应响应的校验值，数据可能不完整时清零
+static http_validators_t g_weather_validators;
+
+// 智能插座电量数据，MQTT 事件处理任务写入，其他任务通过 get_plug_energy_data 读取副本
+static plug_energy_t g_plug_energy = {0};
+static portMUX_TYPE s_plug_energy_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// HA 实体状态缓存的自旋锁：HTTP轮询和 statestream 推送在不同任务中更新缓存
+static portMUX_TYPE s_ha_state_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// 开关序号对应的 HA 实体（序号0未使用）
+#define HA_SWITCH_COUNT 5
+static const char *const s_ha_switch_entities[HA_SWITCH_COUNT] = {
+    NULL, "switch.tasmota", "switch.new_dc1_3", "switch.new_dc1_4", "switch.tasmota_2"
+};
+
+// 开关状态缓存，-1 表示未知
+static int s_ha_switch_states[HA_SWITCH_COUNT] = {-1, -1, -1, -1, -1};
+
+// 室内温湿度实体
+#define HA_ENTITY_INDOOR_TEMP "sensor.zhimi_cn_94444656_ma2_temperature_p_3_3"
+#define HA_ENTITY_INDOOR_HUM  "sensor.zhimi_cn_94444656_ma2_relative_humidity_p_3_1"
 
 /**
  * @brief 将 Open-Meteo (WMO) 天气代码转换为中文描述
@@ -107,99 +142,1013 @@ static const char* get_weather_desc(int code)
     }
 }
 
-// 事件队列长度
+// HA 的实体不可用时状态为 unavailable/unknown，不覆盖已显示的值
+static bool ha_state_valid(const char *state)
+{
+    return state[0] != '\0' && strcmp(state, "unavailable") != 0 && strcmp(state, "unknown") != 0;
+}
+
+// 每日/每月能耗：与缓存相差超过0.01时发布UI更新
+static void ha_post_energy(ui_update_type_t type, const char *state)
+{
+    if (!ha_state_valid(state)) {
+        return;
+    }
+    float *cache = (type == UI_UPDATE_TYPE_DAILY_ENERGY) ? &current_daily_energy : &current_monthly_energy;
+    float value = atof(state);
+    bool changed = false;
+    portENTER_CRITICAL(&s_ha_state_lock);
+    if (fabs(value - *cache) > 0.01) {
+        *cache = value;
+        changed = true;
+    }
+    portEXIT_CRITICAL(&s_ha_state_lock);
+    if (!changed) {
+        return;
+    }
+
+    char text[64];
+    ui_update_t uu = {0};
+    uu.type = type;
+    snprintf(text, sizeof(text), " #FF0000 %.1f# #5F6777 kW##04905E $%.2f#", value, value * 1.2);
+    ui_update_set_str(&uu, text);
+    event_system_post_ui_update(&uu);
+}
+
+// 室内温度/湿度：状态字符串变化时发布UI更新
+static void ha_post_indoor(ui_update_type_t type, const char *state)
+{
+    if (!ha_state_valid(state)) {
+        return;
+    }
+    char *cache = (type == UI_UPDATE_TYPE_INDOOR_TEMP) ? current_indoor_temp : current_indoor_hum;
+    bool changed = false;
+    portENTER_CRITICAL(&s_ha_state_lock);
+    if (strncmp(state, cache, sizeof(current_indoor_temp) - 1) != 0) {
+        strncpy(cache, state, sizeof(current_indoor_temp) - 1);
+        changed = true;
+    }
+    portEXIT_CRITICAL(&s_ha_state_lock);
+    if (!changed) {
+        return;
+    }
+
+    char text[24];
+    ui_update_t uu = {0};
+    uu.type = type;
+    snprintf(text, sizeof(text), (type == UI_UPDATE_TYPE_INDOOR_TEMP) ? "%s°C" : "%s%%", state);
+    ui_update_set_str(&uu, text);
+    event_system_post_ui_update(&uu);
+}
+
+// 开关：状态变化时发布UI更新，值为 (序号 << 8) | 状态
+static void ha_post_switch(int index, const char *state)
+{
+    if (!ha_state_valid(state)) {
+        return;
+    }
+    int on = (strcmp(state, "on") == 0 || strcmp(state, "ON") == 0) ? 1 : 0;
+    bool changed = false;
+    portENTER_CRITICAL(&s_ha_state_lock);
+    if (s_ha_switch_states[index] != on) {
+        s_ha_switch_states[index] = on;
+        changed = true;
+    }
+    portEXIT_CRITICAL(&s_ha_state_lock);
+    if (!changed) {
+        return;
+    }
+
+    ui_update_t uu = {0};
+    uu.type = UI_UPDATE_TYPE_SWITCH_STATE;
+    uu.value.int_value = (index << 8) | on;
+    event_system_post_ui_update(&uu);
+    ESP_LOGI(TAG, "开关 %d (%s) 状态更新: %d", index, s_ha_switch_entities[index], on);
+}
+
+// 面板显示的全部 HA 实体：HTTP 批量轮询和 WebSocket 订阅列表
+static const char *const s_ha_entities[] = {
+    HA_ENTITY_DAILY_ENERGY, HA_ENTITY_MONTHLY_ENERGY, HA_ENTITY_INDOOR_TEMP, HA_ENTITY_INDOOR_HUM,
+    "switch.tasmota", "switch.new_dc1_3", "switch.new_dc1_4", "switch.tasmota_2",
+};
+
+void event_system_apply_ha_state(const char *entity_id, const char *state)
+{
+    if (entity_id == NULL || state == NULL) {
+        return;
+    }
+    if (strcmp(entity_id, HA_ENTITY_DAILY_ENERGY) == 0) {
+        ha_post_energy(UI_UPDATE_TYPE_DAILY_ENERGY, state);
+    } else if (strcmp(entity_id, HA_ENTITY_MONTHLY_ENERGY) == 0) {
+        ha_post_energy(UI_UPDATE_TYPE_MONTHLY_ENERGY, state);
+    } else if (strcmp(entity_id, HA_ENTITY_INDOOR_TEMP) == 0) {
+        ha_post_indoor(UI_UPDATE_TYPE_INDOOR_TEMP, state);
+    } else if (strcmp(entity_id, HA_ENTITY_INDOOR_HUM) == 0) {
+        ha_post_indoor(UI_UPDATE_TYPE_INDOOR_HUM, state);
+    } else {
+        for (int i = 1; i < HA_SWITCH_COUNT; i++) {
+            if (strcmp(entity_id, s_ha_switch_entities[i]) == 0) {
+                ha_post_switch(i, state);
+                break;
+            }
+        }
+    }
+}
+
+// MQTT订阅QoS
+#define MQTT_ROUTE_QOS 0
+
+// 文本类主题：原样显示
+static bool parse_text(const mqtt_message_t *msg, ui_update_t *update)
+{
+    // 直接引用环形缓冲区中的数据，发布时由UI更新通道拷贝
+    update->tag = UI_VALUE_STR;
+    update->len = (msg->data_len > UINT16_MAX) ? UINT16_MAX : (uint16_t)msg->data_len;
+    update->value.str_value = msg->data;
+    return true;
+}
+
+// 逐行歌词：已加载完整LRC时由本地调度显示，忽略逐行消息
+static bool parse_lyrics_line(const mqtt_message_t *msg, ui_update_t *update)
+{
+    if (lyrics_player_active()) {
+        return false;
+    }
+    return parse_text(msg, update);
+}
+
+// 完整LRC：每首歌一次，解析为本地歌词表，空数据表示当前歌曲没有歌词
+static bool parse_lrc(const mqtt_message_t *msg, ui_update_t *update)
+{
+    if (lyrics_player_load(msg->data, msg->data_len) != ESP_OK) {
+        ESP_LOGW(TAG, "加载LRC失败 (%d 字节)", msg->data_len);
+    }
+    return false;
+}
+
+// 播放位置：0~1 的小数，同步本地播放时钟；时钟可用时由 LVGL 任务逐帧推算进度，不再发布
+static bool parse_position(const mqtt_message_t *msg, ui_update_t *update)
+{
+    double position = atof(msg->data);
+    uint32_t duration_ms = playback_clock_duration();
+    if (duration_ms != 0) {
+        playback_clock_sync((uint32_t)(position * duration_ms), msg->recv_time);
+    }
+    if (playback_clock_active()) {
+        return false;
+    }
+    update->value.int_value = (int)(position * PLAYBACK_PROGRESS_MAX);
+    return true;
+}
+
+// 解析 "mm:ss" 为毫秒
+static bool parse_mmss(const char *str, uint32_t *ms)
+{
+    unsigned int minutes;
+    unsigned int seconds;
+    if (sscanf(str, " %u:%u", &minutes, &seconds) != 2) {
+        return false;
+    }
+    *ms = (minutes * 60 + seconds) * 1000;
+    return true;
+}
+
+// 播放进度 "mm:ss / mm:ss"：取出曲目时长并校验本地播放时钟，时钟可用时由 LVGL 任务本地格式化
+static bool parse_progress(const mqtt_message_t *msg, ui_update_t *update)
+{
+    const char *sep = strchr(msg->data, '/');
+    uint32_t position_ms;
+    uint32_t duration_ms;
+    if (sep != NULL && parse_mmss(msg->data, &position_ms) && parse_mmss(sep + 1, &duration_ms)) {
+        playback_clock_set_duration(duration_ms);
+        playback_clock_sync_coarse(position_ms, 1000, msg->recv_time);
+    }
+    if (playback_clock_active()) {
+        return false;
+    }
+    return parse_text(msg, update);
+}
+
+// 音量：整数
+static bool parse_int(const mqtt_message_t *msg, ui_update_t *update)
+{
+    update->value.int_value = atoi(msg->data);
+    return true;
+}
+
+// Tasmota 能耗：单遍提取 ENERGY 下的功率、电压、电流和累计电量，功率以 0.1W 为单位发布
+static bool parse_tasmota_power(const mqtt_message_t *msg, ui_update_t *update)
+{
+    json_field_t fields[] = {
+        {.path = "ENERGY.Power"},
+        {.path = "ENERGY.Voltage"},
+        {.path = "ENERGY.Current"},
+        {.path = "ENERGY.Total"},
+    };
+    json_extract(msg->data, msg->data_len, fields, sizeof(fields) / sizeof(fields[0]));
+
+    double power;
+    if (!json_field_number(&fields[0], &power)) {
+        return false;
+    }
+
+    // 先在局部变量中合成，再整体替换，读取者不会看到一半新一半旧的数据
+    portENTER_CRITICAL(&s_plug_energy_lock);
+    plug_energy_t energy = g_plug_energy;
+    portEXIT_CRITICAL(&s_plug_energy_lock);
+
+    double value;
+    energy.power = (float)power;
+    if (json_field_number(&fields[1], &value)) {
+        energy.voltage = (float)value;
+    }
+    if (json_field_number(&fields[2], &value)) {
+        energy.current = (float)value;
+    }
+    if (json_field_number(&fields[3], &value)) {
+        energy.total = (float)value;
+    }
+    energy.valid = true;
+
+    portENTER_CRITICAL(&s_plug_energy_lock);
+    g_plug_energy = energy;
+    portEXIT_CRITICAL(&s_plug_energy_lock);
+
+    update->value.int_value = (int)(power * 10.0);
+    return true;
+}
+
+// 专辑封面 URL：交给封面下载任务，解码完成后由其发布UI更新
+static bool parse_album_url(const mqtt_message_t *msg, ui_update_t *update)
+{
+    ESP_LOGI(TAG, "收到专辑封面 URL: %s", msg->data);
+    request_album_art_update(msg->data, 100, 100, false);
+    return false;
+}
+
+// 播放状态：ON/OFF
+static bool parse_play_state(const mqtt_message_t *msg, ui_update_t *update)
+{
+    update->value.int_value = (strcmp(msg->data, "ON") == 0) ? 1 : 0;
+    playback_clock_set_playing(update->value.int_value != 0);
+    return true;
+}
+
+// MQTT主题路由表，订阅列表也由此表生成
+static const mqtt_route_t s_mqtt_routes[] = {
+    {"homeassistant/sensor/esp32_music_player/lyrics/state",    MQTT_ROUTE_QOS, UI_UPDATE_TYPE_LYRICS,        parse_lyrics_line,   MQTT_CHANGE_STR,     EVENT_LANE_BULK},
+    {"homeassistant/sensor/esp32_music_player/lrc/state",       MQTT_ROUTE_QOS, UI_UPDATE_TYPE_LYRICS,        parse_lrc,           MQTT_CHANGE_ALWAYS,  EVENT_LANE_BULK},
+    {"homeassistant/sensor/esp32_music_player/song/state",      MQTT_ROUTE_QOS, UI_UPDATE_TYPE_SONG_NAME,     parse_text,          MQTT_CHANGE_STR,     EVENT_LANE_BULK},
+    {"homeassistant/sensor/esp32_music_player/artist/state",    MQTT_ROUTE_QOS, UI_UPDATE_TYPE_ARTIST,        parse_text,          MQTT_CHANGE_STR,     EVENT_LANE_BULK},
+    {"homeassistant/number/esp32_music_player/position/state",  MQTT_ROUTE_QOS, UI_UPDATE_TYPE_PLAY_PROGRESS, parse_position,      MQTT_CHANGE_INT,     EVENT_LANE_BULK},
+    {"homeassistant/number/esp32_music_player/volume/state",    MQTT_ROUTE_QOS, UI_UPDATE_TYPE_VOLUME,        parse_int,           MQTT_CHANGE_INT,     EVENT_LANE_INTERACTIVE},
+    {"homeassistant/sensor/esp32_music_player/progress/state",  MQTT_ROUTE_QOS, UI_UPDATE_TYPE_SONG_TIME,     parse_progress,      MQTT_CHANGE_STR,     EVENT_LANE_BULK},
+    // 能耗相关主题 - Tasmota设备
+    {"tele/tasmota_A0DA50/SENSOR",                              MQTT_ROUTE_QOS, UI_UPDATE_TYPE_POWER,         parse_tasmota_power, MQTT_CHANGE_INT,     EVENT_LANE_BULK},
+    {"homeassistant/sensor/esp32_music_player/url/state",       MQTT_ROUTE_QOS, UI_UPDATE_TYPE_ALBUM_ART,     parse_album_url,     MQTT_CHANGE_ALWAYS,  EVENT_LANE_BULK},
+    {"homeassistant/switch/esp32_music_player/play/state",      MQTT_ROUTE_QOS, UI_UPDATE_TYPE_PLAY_STATE,    parse_play_state,    MQTT_CHANGE_ALWAYS,  EVENT_LANE_INTERACTIVE},
+};
+
+#if CONFIG_SMART_PANEL_HA_STATESTREAM
+// HA mqtt_statestream 发布的实体状态主题：<base_topic>/<domain>/<object_id>/state，数据为状态字符串
+#define HA_STATESTREAM_TOPIC(domain, object_id) CONFIG_SMART_PANEL_HA_STATESTREAM_BASE_TOPIC "/" domain "/" object_id "/state"
+
+// 开关序号对应的 statestream 主题，与 s_ha_switch_entities 一一对应
+static const char *const s_ha_switch_topics[HA_SWITCH_COUNT] = {
+    NULL,
+    HA_STATESTREAM_TOPIC("switch", "tasmota"),
+    HA_STATESTREAM_TOPIC("switch", "new_dc1_3"),
+    HA_STATESTREAM_TOPIC("switch", "new_dc1_4"),
+    HA_STATESTREAM_TOPIC("switch", "tasmota_2"),
+};
+
+// statestream 推送的状态与HTTP轮询共用缓存和格式化，由辅助函数直接发布UI更新
+static bool parse_ha_daily_energy(const mqtt_message_t *msg, ui_update_t *update)
+{
+    ha_post_energy(UI_UPDATE_TYPE_DAILY_ENERGY, msg->data);
+    return false;
+}
+
+static bool parse_ha_monthly_energy(const mqtt_message_t *msg, ui_update_t *update)
+{
+    ha_post_energy(UI_UPDATE_TYPE_MONTHLY_ENERGY, msg->data);
+    return false;
+}
+
+static bool parse_ha_indoor(const mqtt_message_t *msg, ui_update_t *update)
+{
+    ha_post_indoor(update->type, msg->data);
+    return false;
+}
+
+static bool parse_ha_switch(const mqtt_message_t *msg, ui_update_t *update)
+{
+    for (int i = 1; i < HA_SWITCH_COUNT; i++) {
+        if (strcmp(msg->topic, s_ha_switch_topics[i]) == 0) {
+            ha_post_switch(i, msg->data);
+            break;
+        }
+    }
+    return false;
+}
+
+// HA 实体状态推送路由，替代30秒一次的HTTP轮询
+static const mqtt_route_t s_statestream_routes[] = {
+    {HA_STATESTREAM_TOPIC("sensor", "daily_energy_consumption"),            MQTT_ROUTE_QOS, UI_UPDATE_TYPE_DAILY_ENERGY,   parse_ha_daily_energy,   MQTT_CHANGE_ALWAYS, EVENT_LANE_BULK},
+    {HA_STATESTREAM_TOPIC("sensor", "monthly_energy_consumption"),          MQTT_ROUTE_QOS, UI_UPDATE_TYPE_MONTHLY_ENERGY, parse_ha_monthly_energy, MQTT_CHANGE_ALWAYS, EVENT_LANE_BULK},
+    {HA_STATESTREAM_TOPIC("sensor", "zhimi_cn_94444656_ma2_temperature_p_3_3"),       MQTT_ROUTE_QOS, UI_UPDATE_TYPE_INDOOR_TEMP, parse_ha_indoor, MQTT_CHANGE_ALWAYS, EVENT_LANE_BULK},
+    {HA_STATESTREAM_TOPIC("sensor", "zhimi_cn_94444656_ma2_relative_humidity_p_3_1"), MQTT_ROUTE_QOS, UI_UPDATE_TYPE_INDOOR_HUM,  parse_ha_indoor, MQTT_CHANGE_ALWAYS, EVENT_LANE_BULK},
+    {HA_STATESTREAM_TOPIC("switch", "tasmota"),                             MQTT_ROUTE_QOS, UI_UPDATE_TYPE_SWITCH_STATE,   parse_ha_switch,         MQTT_CHANGE_ALWAYS, EVENT_LANE_INTERACTIVE},
+    {HA_STATESTREAM_TOPIC("switch", "new_dc1_3"),                           MQTT_ROUTE_QOS, UI_UPDATE_TYPE_SWITCH_STATE,   parse_ha_switch,         MQTT_CHANGE_ALWAYS, EVENT_LANE_INTERACTIVE},
+    {HA_STATESTREAM_TOPIC("switch", "new_dc1_4"),                           MQTT_ROUTE_QOS, UI_UPDATE_TYPE_SWITCH_STATE,   parse_ha_switch,         MQTT_CHANGE_ALWAYS, EVENT_LANE_INTERACTIVE},
+    {HA_STATESTREAM_TOPIC("switch", "tasmota_2"),                           MQTT_ROUTE_QOS, UI_UPDATE_TYPE_SWITCH_STATE,   parse_ha_switch,         MQTT_CHANGE_ALWAYS, EVENT_LANE_INTERACTIVE},
+};
+#endif
+
+#if CONFIG_SMART_PANEL_MQTT_WILDCARD_SUBSCRIBE
+// 通配符订阅：音乐播放器的状态主题合并为一个过滤器，路由表之外的主题在本地丢弃
+static const esp_mqtt_topic_t s_mqtt_wildcards[] = {
+    {.filter = "homeassistant/+/esp32_music_player/+/state", .qos = MQTT_ROUTE_QOS},
+};
+#endif
+
+// 每个通道的事件队列长度
 #define EVENT_QUEUE_LENGTH 10
 
 // 事件队列项大小
 #define EVENT_ITEM_SIZE sizeof(event_t)
 
-// 事件处理任务句柄
-static TaskHandle_t g_event_handler_tasks[EVENT_TYPE_MAX] = {NULL};
+// 事件负载头部，位于 event_system_alloc 返回的指针之前，8字节以保持负载对齐
+typedef struct {
+    uint32_t refcount;             // 引用计数，归零时归还负载
+    uint32_t reserved;
+} event_payload_hdr_t;
+
+// 事件负载池槽位必须能容纳最大的事件负载
+_Static_assert(sizeof(ui_update_t) + sizeof(event_payload_hdr_t) <= EVENT_POOL_SLOT_SIZE, "EVENT_POOL_SLOT_SIZE 小于 ui_update_t");
+
+// 订阅表
+typedef struct {
+    bool active;                   // 是否在用
+    event_type_t type;             // 订阅的事件类型
+    event_subscriber_t subscriber; // 订阅者
+} event_subscription_entry_t;
+
+static event_subscription_entry_t s_subscriptions[EVENT_SUBSCRIBER_MAX];
+
+// 保护订阅表的自旋锁
+static portMUX_TYPE s_subscription_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// 事件发送策略表项
+typedef struct {
+    event_post_policy_t policy;    // 队列已满时的处理方式
+    uint32_t deadline_ms;          // EVENT_POLICY_BLOCK 的最长等待时间
+    event_lane_t lane;             // 默认优先级通道
+} event_policy_t;
+
+// 按事件类型配置的发送策略
+// 网络协议栈回调（WiFi事件、esp-mqtt、SNTP）发送的事件一律不阻塞，避免被慢速消费者拖住
+static const event_policy_t s_event_policies[EVENT_TYPE_MAX] = {
+    [EVENT_TYPE_WIFI_CONNECTED]        = {EVENT_POLICY_DROP_OLDEST, 0,          EVENT_LANE_BULK},
+    [EVENT_TYPE_WIFI_DISCONNECTED]     = {EVENT_POLICY_DROP_OLDEST, 0,          EVENT_LANE_BULK},
+    [EVENT_TYPE_BUTTON_CLICK]          = {EVENT_POLICY_DROP_NEWEST, 0,          EVENT_LANE_INTERACTIVE},
+    [EVENT_TYPE_TOUCH_EVENT]           = {EVENT_POLICY_DROP_NEWEST, 0,          EVENT_LANE_INTERACTIVE},
+    [EVENT_TYPE_LOAD_XML]              = {EVENT_POLICY_COALESCE,    0,          EVENT_LANE_BULK},
+    [EVENT_TYPE_XML_LOADED]            = {EVENT_POLICY_BLOCK,       UINT32_MAX, EVENT_LANE_BULK},   // 后台任务发送，结果不可丢弃
+    [EVENT_TYPE_REFRESH_XML]           = {EVENT_POLICY_COALESCE,    0,          EVENT_LANE_INTERACTIVE},
+    [EVENT_TYPE_NTP_TIME_UPDATED]      = {EVENT_POLICY_COALESCE,    0,          EVENT_LANE_BULK},
+    [EVENT_TYPE_MQTT_CONNECTED]        = {EVENT_POLICY_DROP_OLDEST, 0,          EVENT_LANE_BULK},
+    [EVENT_TYPE_MQTT_DISCONNECTED]     = {EVENT_POLICY_DROP_OLDEST, 0,          EVENT_LANE_BULK},
+    [EVENT_TYPE_MQTT_MESSAGE_RECEIVED] = {EVENT_POLICY_COALESCE,    0,          EVENT_LANE_BULK},   // 环形缓冲区门铃，按路由表可改投交互通道
+    [EVENT_TYPE_UI_UPDATE]             = {EVENT_POLICY_COALESCE,    0,          EVENT_LANE_BULK},   // 实际写入UI更新通道
+    [EVENT_TYPE_HTTP_COMPLETE]         = {EVENT_POLICY_BLOCK,       UINT32_MAX, EVENT_LANE_BULK},   // 工作任务发送，携带响应不可丢弃，按请求的通道投递
+};
+
+// 事件队列统计信息
+static event_queue_stats_t s_queue_stats[EVENT_QUEUE_MAX];
+
+// 各事件类型在各通道中尚未被取走的数量，用于合并策略
+static uint16_t s_pending[EVENT_TYPE_MAX][EVENT_LANE_MAX];
+
+// 保护统计信息和待处理计数的自旋锁
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// 事件类型对应的队列
+static event_queue_id_t queue_id_for_type(event_type_t type)
+{
+    if (type == EVENT_TYPE_XML_LOADED || type == EVENT_TYPE_NTP_TIME_UPDATED || type == EVENT_TYPE_HTTP_COMPLETE) {
+        // UI相关事件发送到UI事件队列
+        return EVENT_QUEUE_UI;
+    }
+    // 其他事件发送到系统事件队列
+    return EVENT_QUEUE_SYSTEM;
+}
+
+
+// 记录事件已被取出队列
+static void note_dequeued(event_type_t type, event_lane_t lane)
+{
+    portENTER_CRITICAL(&s_stats_lock);
+    if (type < EVENT_TYPE_MAX && s_pending[type][lane] > 0) {
+        s_pending[type][lane]--;
+    }
+    portEXIT_CRITICAL(&s_stats_lock);
+}
+
+// 按事件类型的策略将事件放入队列的指定通道，失败时负载已释放
+static esp_err_t enqueue_event(event_queue_id_t queue_id, event_lane_t lane, event_t *event)
+{
+    QueueHandle_t queue = s_lanes[queue_id][lane];
+    event_queue_stats_t *stats = &s_queue_stats[queue_id];
+    const event_policy_t *policy = &s_event_policies[event->type];
+    bool sent = false;
+
+    // 先计入待处理数再入队：消费者可能在入队后立即取走事件，晚计数会让计数永远不归零。
+    // 合并策略的检查和计数在同一个临界区内，并发发送时只有一个事件入队
+    bool pending = false;
+    portENTER_CRITICAL(&s_stats_lock);
+    if (policy->policy == EVENT_POLICY_COALESCE && s_pending[event->type][lane] > 0) {
+        pending = true;
+        stats->coalesced++;
+    } else {
+        s_pending[event->type][lane]++;
+    }
+    portEXIT_CRITICAL(&s_stats_lock);
+
+    switch (policy->policy) {
+        case EVENT_POLICY_COALESCE:
+            // 同类型事件还在队列中，新事件由它代表
+            if (pending) {
+                event_system_free(event->data);
+                return ESP_OK;
+            }
+            sent = (xQueueSend(queue, event, 0) == pdPASS);
+            break;
+        case EVENT_POLICY_BLOCK: {
+            TickType_t wait = (policy->deadline_ms == UINT32_MAX) ? portMAX_DELAY : pdMS_TO_TICKS(policy->deadline_ms);
+            sent = (xQueueSend(queue, event, wait) == pdPASS);
+            break;
+        }
+        case EVENT_POLICY_DROP_OLDEST:
+            // 队列满时取出最旧的事件丢弃；与消费者竞争时最多重试一次
+            for (int attempt = 0; attempt < 2 && !sent; attempt++) {
+                sent = (xQueueSend(queue, event, 0) == pdPASS);
+                event_t oldest;
+                if (!sent && xQueueReceive(queue, &oldest, 0) == pdPASS) {
+                    note_dequeued(oldest.type, lane);
+                    event_system_free(oldest.data);
+                    portENTER_CRITICAL(&s_stats_lock);
+                    stats->dropped++;
+                    portEXIT_CRITICAL(&s_stats_lock);
+                    ESP_LOGD(TAG, "队列已满，丢弃最旧的事件: %d", oldest.type);
+                }
+            }
+            break;
+        case EVENT_POLICY_DROP_NEWEST:
+        default:
+            sent = (xQueueSend(queue, event, 0) == pdPASS);
+            break;
+    }
+
+    if (!sent) {
+        portENTER_CRITICAL(&s_stats_lock);
+        if (s_pending[event->type][lane] > 0) {
+            s_pending[event->type][lane]--;
+        }
+        stats->dropped++;
+        portEXIT_CRITICAL(&s_stats_lock);
+        ESP_LOGD(TAG, "队列已满，丢弃事件: %d", event->type);
+        event_system_free(event->data);
+        return ESP_ERR_TIMEOUT;
+    }
+
+    // 唤醒消费者
+    xSemaphoreGive(s_doorbells[queue_id]);
+
+    UBaseType_t depth = uxQueueMessagesWaiting(s_lanes[queue_id][EVENT_LANE_INTERACTIVE]) +
+                        uxQueueMessagesWaiting(s_lanes[queue_id][EVENT_LANE_BULK]);
+    portENTER_CRITICAL(&s_stats_lock);
+    stats->posted++;
+    if (depth > stats->high_water) {
+        stats->high_water = depth;
+    }
+    portEXIT_CRITICAL(&s_stats_lock);
+    return ESP_OK;
+}
 
 // 事件队列初始化
 esp_err_t event_system_init(void)
 {
     ESP_LOGI(TAG, "初始化事件系统");
     
-    // 创建系统事件队列
-    g_system_event_queue = xQueueCreate(EVENT_QUEUE_LENGTH, EVENT_ITEM_SIZE);
-    if (g_system_event_queue == NULL) {
-        ESP_LOGE(TAG, "创建系统事件队列失败");
-        return ESP_FAIL;
+    // 创建系统事件队列和UI事件队列，每个队列含交互和批量两个通道
+    for (int q = 0; q < EVENT_QUEUE_MAX; q++) {
+        for (int lane = 0; lane < EVENT_LANE_MAX; lane++) {
+            s_lanes[q][lane] = xQueueCreate(EVENT_QUEUE_LENGTH, EVENT_ITEM_SIZE);
+            if (s_lanes[q][lane] == NULL) {
+                ESP_LOGE(TAG, "创建事件队列失败: %d/%d", q, lane);
+                return ESP_FAIL;
+            }
+        }
+        s_doorbells[q] = xSemaphoreCreateBinary();
+        if (s_doorbells[q] == NULL) {
+            ESP_LOGE(TAG, "创建事件队列门铃失败: %d", q);
+            return ESP_FAIL;
+        }
+    }
+    
+    // 划分UI更新通道的字符串池
+    esp_err_t err = ui_update_channel_init();
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "初始化UI更新通道失败");
+        return err;
+    }
+    
+    // 本地歌词调度
+    err = lyrics_player_init();
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "初始化歌词调度失败");
+        return err;
+    }
+    
+    // 注册MQTT主题路由
+    err = mqtt_dispatch_register(s_mqtt_routes, sizeof(s_mqtt_routes) / sizeof(s_mqtt_routes[0]));
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "注册MQTT路由失败");
+        return err;
+    }
+    
+#if CONFIG_SMART_PANEL_HA_STATESTREAM
+    err = mqtt_dispatch_register(s_statestream_routes, sizeof(s_statestream_routes) / sizeof(s_statestream_routes[0]));
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "注册HA statestream路由失败");
+        return err;
     }
+#endif
     
-    // 创建UI事件队列
-    g_ui_event_queue = xQueueCreate(EVENT_QUEUE_LENGTH, EVENT_ITEM_SIZE);
-    if (g_ui_event_queue == NULL) {
-        ESP_LOGE(TAG, "创建UI事件队列失败");
-        return ESP_FAIL;
+#if CONFIG_SMART_PANEL_MQTT_WILDCARD_SUBSCRIBE
+    err = mqtt_dispatch_register_wildcards(s_mqtt_wildcards, sizeof(s_mqtt_wildcards) / sizeof(s_mqtt_wildcards[0]));
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "注册MQTT通配符订阅失败");
+        return err;
+    }
+#endif
+    
+    for (int i = 0; i < EVENT_QUEUE_MAX; i++) {
+        s_queue_stats[i].capacity = EVENT_QUEUE_LENGTH * EVENT_LANE_MAX;
     }
     
     ESP_LOGI(TAG, "事件系统初始化成功");
     return ESP_OK;
 }
 
-// 发送事件
-esp_err_t event_system_post(event_type_t type, void *data, size_t data_len)
+// 分配事件负载，引用计数初始为1
+void *event_system_alloc(size_t size)
+{
+    event_payload_hdr_t *hdr = event_pool_alloc(sizeof(event_payload_hdr_t) + size);
+    if (hdr == NULL) {
+        return NULL;
+    }
+    hdr->refcount = 1;
+    return hdr + 1;
+}
+
+// 增加事件负载的引用计数
+void *event_system_retain(void *data)
+{
+    if (data != NULL) {
+        event_payload_hdr_t *hdr = (event_payload_hdr_t *)data - 1;
+        __atomic_fetch_add(&hdr->refcount, 1, __ATOMIC_RELAXED);
+    }
+    return data;
+}
+
+// 释放事件负载，最后一个持有者负责归还
+void event_system_free(void *data)
+{
+    if (data == NULL) {
+        return;
+    }
+    event_payload_hdr_t *hdr = (event_payload_hdr_t *)data - 1;
+    if (__atomic_sub_fetch(&hdr->refcount, 1, __ATOMIC_ACQ_REL) == 0) {
+        event_pool_free(hdr);
+    }
+}
+
+// 释放已处理事件的负载
+void event_system_release(event_t *event)
+{
+    if (event == NULL) {
+        return;
+    }
+    event_system_free(event->data);
+    event->data = NULL;
+}
+
+// 发送事件并转移所有权
+esp_err_t event_system_post_owned(event_type_t type, void *data, size_t data_len)
 {
     if (type >= EVENT_TYPE_MAX) {
         ESP_LOGE(TAG, "无效的事件类型: %d", type);
+        event_system_free(data);
         return ESP_ERR_INVALID_ARG;
     }
     
+    return event_system_post_owned_lane(type, data, data_len, s_event_policies[type].lane);
+}
+
+// 发送事件到指定优先级通道并转移所有权
+esp_err_t event_system_post_owned_lane(event_type_t type, void *data, size_t data_len, event_lane_t lane)
+{
+    if (type >= EVENT_TYPE_MAX) {
+        ESP_LOGE(TAG, "无效的事件类型: %d", type);
+        event_system_free(data);
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (lane >= EVENT_LANE_MAX) {
+        ESP_LOGE(TAG, "无效的事件通道: %d", lane);
+        event_system_free(data);
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    // UI更新不进入队列，直接写入合并通道
+    if (type == EVENT_TYPE_UI_UPDATE) {
+        esp_err_t err = ESP_ERR_INVALID_ARG;
+        if (data != NULL && data_len >= sizeof(ui_update_t)) {
+            err = ui_update_channel_publish((const ui_update_t *)data);
+        }
+        event_system_free(data);
+        return err;
+    }
+    
     event_t event;
     event.type = type;
-    event.data_len = data_len;
+    event.data = data;
+    event.data_len = (data != NULL) ? data_len : 0;
     
-    // 记录事件发送时间戳（单位：tick）
-    event.send_time = xTaskGetTickCount();
+    // 记录事件发送时间戳（单位：微秒）
+    event.send_time = event_metrics_now_us();
     
-    // 如果有数据，复制数据
+    // 负载所有权随事件转移给消费者，入队失败时已释放
+    esp_err_t err = enqueue_event(queue_id_for_type(type), lane, &event);
+    if (err == ESP_OK) {
+        ESP_LOGD(TAG, "成功发送事件: %d", type);
+    }
+    return err;
+}
+
+// 取出事件，交互通道优先
+esp_err_t event_system_receive(event_queue_id_t queue_id, event_t *event, TickType_t timeout)
+{
+    if (queue_id >= EVENT_QUEUE_MAX || event == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    TickType_t start = xTaskGetTickCount();
+    while (1) {
+        for (int lane = 0; lane < EVENT_LANE_MAX; lane++) {
+            if (xQueueReceive(s_lanes[queue_id][lane], event, 0) == pdPASS) {
+                note_dequeued(event->type, lane);
+                return ESP_OK;
+            }
+        }
+        
+        // 两个通道都为空，等待门铃直到超时
+        TickType_t elapsed = xTaskGetTickCount() - start;
+        if (elapsed >= timeout) {
+            return ESP_ERR_TIMEOUT;
+        }
+        TickType_t wait = (timeout == portMAX_DELAY) ? portMAX_DELAY : timeout - elapsed;
+        xSemaphoreTake(s_doorbells[queue_id], wait);
+    }
+}
+
+// 只从指定通道取出事件
+esp_err_t event_system_receive_lane(event_queue_id_t queue_id, event_lane_t lane, event_t *event, TickType_t timeout)
+{
+    if (queue_id >= EVENT_QUEUE_MAX || lane >= EVENT_LANE_MAX || event == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (xQueueReceive(s_lanes[queue_id][lane], event, timeout) != pdPASS) {
+        return ESP_ERR_TIMEOUT;
+    }
+    note_dequeued(event->type, lane);
+    return ESP_OK;
+}
+
+// 获取事件队列统计信息
+void event_system_get_queue_stats(event_queue_id_t queue_id, event_queue_stats_t *stats)
+{
+    if (queue_id >= EVENT_QUEUE_MAX || stats == NULL) {
+        return;
+    }
+    portENTER_CRITICAL(&s_stats_lock);
+    *stats = s_queue_stats[queue_id];
+    portEXIT_CRITICAL(&s_stats_lock);
+}
+
+// 发送事件
+esp_err_t event_system_post(event_type_t type, void *data, size_t data_len)
+{
+    if (type >= EVENT_TYPE_MAX) {
+        ESP_LOGE(TAG, "无效的事件类型: %d", type);
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    // UI更新直接复制进合并通道，无需经过事件负载池
+    if (type == EVENT_TYPE_UI_UPDATE) {
+        if (data == NULL || data_len < sizeof(ui_update_t)) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        return ui_update_channel_publish((const ui_update_t *)data);
+    }
+    
+    // 如果有数据，复制到事件负载池
+    void *copy = NULL;
     if (data != NULL && data_len > 0) {
-        event.data = malloc(data_len);
-        if (event.data == NULL) {
+        copy = event_system_alloc(data_len);
+        if (copy == NULL) {
             ESP_LOGE(TAG, "分配事件数据内存失败");
             return ESP_ERR_NO_MEM;
         }
-        memcpy(event.data, data, data_len);
-    } else {
-        event.data = NULL;
+        memcpy(copy, data, data_len);
     }
     
-    // 根据事件类型选择目标队列
-    QueueHandle_t target_queue;
-    if (type == EVENT_TYPE_XML_LOADED || type == EVENT_TYPE_NTP_TIME_UPDATED || type == EVENT_TYPE_UI_UPDATE) {
-        // UI相关事件发送到UI事件队列
-        target_queue = g_ui_event_queue;
-    } else {
-        // 其他事件发送到系统事件队列
-        target_queue = g_system_event_queue;
+    return event_system_post_owned(type, copy, data_len);
+}
+
+// 发布UI更新
+esp_err_t event_system_post_ui_update(const ui_update_t *update)
+{
+    return ui_update_channel_publish(update);
+}
+
+// 订阅事件
+esp_err_t event_system_subscribe(event_type_t type, const event_subscriber_t *subscriber, event_subscription_t *handle)
+{
+    if (type >= EVENT_TYPE_MAX || subscriber == NULL) {
+        ESP_LOGE(TAG, "无效的订阅参数: %d", type);
+        return ESP_ERR_INVALID_ARG;
+    }
+    if ((subscriber->delivery == EVENT_DELIVERY_CALLBACK && subscriber->callback == NULL) ||
+        (subscriber->delivery == EVENT_DELIVERY_TASK && subscriber->task == NULL)) {
+        ESP_LOGE(TAG, "订阅者缺少回调函数或任务句柄: %d", type);
+        return ESP_ERR_INVALID_ARG;
     }
     
-    // 将事件发送到队列
-    if (xQueueSend(target_queue, &event, portMAX_DELAY) != pdPASS) {
-        ESP_LOGE(TAG, "发送事件到队列失败");
-        if (event.data != NULL) {
-            free(event.data);
+    int index = -1;
+    portENTER_CRITICAL(&s_subscription_lock);
+    for (int i = 0; i < EVENT_SUBSCRIBER_MAX; i++) {
+        if (!s_subscriptions[i].active) {
+            s_subscriptions[i].type = type;
+            s_subscriptions[i].subscriber = *subscriber;
+            s_subscriptions[i].active = true;
+            index = i;
+            break;
         }
-        return ESP_FAIL;
     }
+    portEXIT_CRITICAL(&s_subscription_lock);
     
-    ESP_LOGD(TAG, "成功发送事件: %d", type);
+    if (index < 0) {
+        ESP_LOGE(TAG, "订阅数量已达上限: %d", EVENT_SUBSCRIBER_MAX);
+        return ESP_ERR_NO_MEM;
+    }
+    if (handle != NULL) {
+        *handle = index;
+    }
+    ESP_LOGD(TAG, "订阅事件成功: %d -> %d", type, index);
     return ESP_OK;
 }
 
-// 注册事件处理函数
-esp_err_t event_system_register_handler(event_type_t type, TaskHandle_t handler_task)
+// 取消订阅（正在进行的投递可能仍会完成最后一次）
+esp_err_t event_system_unsubscribe(event_subscription_t handle)
 {
-    if (type >= EVENT_TYPE_MAX) {
-        ESP_LOGE(TAG, "无效的事件类型: %d", type);
+    if (handle < 0 || handle >= EVENT_SUBSCRIBER_MAX) {
         return ESP_ERR_INVALID_ARG;
     }
     
-    g_event_handler_tasks[type] = handler_task;
-    ESP_LOGI(TAG, "注册事件处理函数成功: %d -> 任务句柄: %p", type, handler_task);
-    return ESP_OK;
+    portENTER_CRITICAL(&s_subscription_lock);
+    bool was_active = s_subscriptions[handle].active;
+    s_subscriptions[handle].active = false;
+    portEXIT_CRITICAL(&s_subscription_lock);
+    
+    return was_active ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+// 将事件投递给所有订阅者
+void event_system_dispatch(const event_t *event)
+{
+    if (event == NULL || event->type >= EVENT_TYPE_MAX) {
+        return;
+    }
+    
+    // 在锁内复制匹配的订阅者，投递时不持锁，回调中可以订阅或取消订阅
+    event_subscriber_t targets[EVENT_SUBSCRIBER_MAX];
+    int count = 0;
+    portENTER_CRITICAL(&s_subscription_lock);
+    for (int i = 0; i < EVENT_SUBSCRIBER_MAX; i++) {
+        if (s_subscriptions[i].active && s_subscriptions[i].type == event->type) {
+            targets[count++] = s_subscriptions[i].subscriber;
+        }
+    }
+    portEXIT_CRITICAL(&s_subscription_lock);
+    
+    if (count == 0) {
+        ESP_LOGD(TAG, "事件没有订阅者: %d", event->type);
+        return;
+    }
+    
+    for (int i = 0; i < count; i++) {
+        const event_subscriber_t *sub = &targets[i];
+        if (sub->delivery == EVENT_DELIVERY_CALLBACK) {
+            sub->callback(event, sub->ctx);
+            continue;
+        }
+        
+        // 任务投递：事件副本共享同一份负载，由订阅任务处理后释放
+        if (sub->queue != NULL) {
+            event_t copy = *event;
+            event_system_retain(copy.data);
+            if (xQueueSend(sub->queue, &copy, 0) != pdPASS) {
+                ESP_LOGW(TAG, "订阅者队列已满，丢弃事件: %d", event->type);
+                event_system_release(&copy);
+                continue;
+            }
+        }
+        uint32_t bits = (sub->notify_bits != 0) ? sub->notify_bits : (1u << event->type);
+        xTaskNotify(sub->task, bits, eSetBits);
+    }
+}
+
+// 注册事件处理任务
+esp_err_t event_system_register_handler(event_type_t type, TaskHandle_t handler_task)
+{
+    event_subscriber_t subscriber = {
+        .delivery = EVENT_DELIVERY_TASK,
+        .task = handler_task,
+    };
+    esp_err_t err = event_system_subscribe(type, &subscriber, NULL);
+    if (err == ESP_OK) {
+        ESP_LOGI(TAG, "注册事件处理函数成功: %d -> 任务句柄: %p", type, handler_task);
+    }
+    return err;
+}
+
+#if CONFIG_SMART_PANEL_HTTP_BENCH
+// 连接池基准的轮数
+#define HTTP_BENCH_ROUNDS 5
+
+// 批量读取基准只计时，不更新UI
+static void ha_bench_ignore_state(const char *entity_id, const char *state)
+{
+}
+
+// HTTP基准：每轮读取全部实体状态，对比每次新建连接、复用长连接逐个读取、一次模板请求批量读取的耗时
+static void ha_http_bench(void)
+{
+    static const char *const mode_names[] = {"每次新建连接", "长连接", "批量读取"};
+    const size_t count = sizeof(s_ha_entities) / sizeof(s_ha_entities[0]);
+    for (int mode = 0; mode < 3; mode++) {
+        http_service_set_pool_enabled(mode > 0);
+        int64_t total_us = 0;
+        int64_t min_us = INT64_MAX;
+        int64_t max_us = 0;
+        for (int round = 0; round < HTTP_BENCH_ROUNDS; round++) {
+            int64_t start = esp_timer_get_time();
+            if (mode == 2) {
+                get_entity_states(s_ha_entities, count, ha_bench_ignore_state);
+                esp_task_wdt_reset();
+            } else {
+                for (size_t i = 0; i < count; i++) {
+                    free(get_entity_state(s_ha_entities[i]));
+                    esp_task_wdt_reset();
+                }
+            }
+            int64_t elapsed = esp_timer_get_time() - start;
+            total_us += elapsed;
+            min_us = (elapsed < min_us) ? elapsed : min_us;
+            max_us = (elapsed > max_us) ? elapsed : max_us;
+        }
+        ESP_LOGI(TAG, "HTTP基准 [%s] %u 个实体: 平均 %lld ms, 最短 %lld ms, 最长 %lld ms",
+                 mode_names[mode], (unsigned int)count,
+                 (long long)(total_us / HTTP_BENCH_ROUNDS / 1000), (long long)(min_us / 1000), (long long)(max_us / 1000));
+    }
+
+    http_pool_stats_t stats;
+    http_service_get_pool_stats(&stats);
+    ESP_LOGI(TAG, "HTTP连接池: 命中 %u, 未命中 %u, 失效重连 %u", (unsigned int)stats.hits,
+             (unsigned int)stats.misses, (unsigned int)stats.stale);
+}
+#endif
+
+#define WEATHER_HOURS_MAX ((int)(sizeof(g_24h_weather_data) / sizeof(g_24h_weather_data[0])))
+
+// 天气数据流式解析的上下文：先解析到本地，整个响应解析成功后才复制到全局数据
+typedef struct {
+    json_stream_t parser;
+    int count;                      // time 数组的长度，不超过 WEATHER_HOURS_MAX
+    hourly_weather_t data[WEATHER_HOURS_MAX];
+    int hour[WEATHER_HOURS_MAX];    // 每条数据的小时，无法解析时为 -1
+} weather_parse_t;
+
+// hourly.time[*]：如 "2025-06-01T13:00"，记录小时数和每条数据的小时
+static void weather_on_time(void *ctx, const json_field_t *field, int index)
+{
+    weather_parse_t *weather = ctx;
+    char time_str[24];
+    int hour;
+    if (index < 0 || index >= WEATHER_HOURS_MAX) {
+        return;
+    }
+    if (index + 1 > weather->count) {
+        weather->count = index + 1;
+    }
+    if (json_field_string(field, time_str, sizeof(time_str)) && sscanf(time_str, "%*[^T]T%d", &hour) == 1) {
+        weather->hour[index] = hour;
+    } else {
+        weather->hour[index] = -1;
+    }
+}
+
+// hourly 中的数值数组：按下标写入解析上下文
+static void weather_on_value(void *ctx, const json_field_t *field, int index)
+{
+    weather_parse_t *weather = ctx;
+    double value;
+    if (index < 0 || index >= WEATHER_HOURS_MAX || !json_field_number(field, &value)) {
+        return;
+    }
+    hourly_weather_t *hour = &weather->data[index];
+    // 路径以 "hourly." 开头，按后面的数组名区分
+    const char *name = field->path + strlen("hourly.");
+    if (strncmp(name, "temperature_2m", 14) == 0) {
+        hour->temperature = value;
+    } else if (strncmp(name, "apparent_temperature", 20) == 0) {
+        hour->apparent_temperature = value;
+    } else if (strncmp(name, "weather_code", 12) == 0) {
+        hour->weather_code = (int)value;
+    } else {
+        hour->humidity = (int)value;
+    }
+}
+
+static bool weather_stream_cb(void *ctx, const char *data, int len)
+{
+    weather_parse_t *weather = ctx;
+    // 在 http_async 工作任务中执行，该任务未订阅看门狗；等待中的 ha_monitor_task 由 http_async_perform 喂狗
+    return json_stream_feed(&weather->parser, data, len) == 0;
+}
+
+// 更新当前小时的天气显示
+static void weather_show_hour(int current_hour)
+{
+    for (int idx = 0; idx < g_24h_weather_count; idx++) {
+        if (g_24h_weather_hour[idx] != current_hour) {
+            continue;
+        }
+        const hourly_weather_t *hour = &g_24h_weather_data[idx];
+        const char *desc = get_weather_desc(hour->weather_code);
+
+        char text[32];
+        ui_update_t uu = {0};
+        uu.type = UI_UPDATE_TYPE_WEATHER_DESC;
+        ui_update_set_str(&uu, desc);
+        event_system_post_ui_update(&uu);
+        uu.type = UI_UPDATE_TYPE_WEATHER_TEMP;
+        snprintf(text, sizeof(text), "%d|%dC", (int)hour->temperature, (int)hour->apparent_temperature);
+        ui_update_set_str(&uu, text);
+        event_system_post_ui_update(&uu);
+        uu.type = UI_UPDATE_TYPE_WEATHER_HUM;
+        snprintf(text, sizeof(text), "%d%%", hour->humidity);
+        ui_update_set_str(&uu, text);
+        event_system_post_ui_update(&uu);
+        return;
+    }
+}
+
+// HA 实体的HTTP轮询间隔：statestream 或 WebSocket 推送正常时只做低频对账，否则每30秒轮询
+static TickType_t ha_entity_poll_interval(void)
+{
+#if CONFIG_SMART_PANEL_HA_STATESTREAM
+    if (mqtt_client_is_connected()) {
+        return pdMS_TO_TICKS(CONFIG_SMART_PANEL_HA_RECONCILE_INTERVAL_S * 1000);
+    }
+#endif
+#if CONFIG_SMART_PANEL_HA_WEBSOCKET
+    if (ha_websocket_is_ready()) {
+        return pdMS_TO_TICKS(CONFIG_SMART_PANEL_HA_RECONCILE_INTERVAL_S * 1000);
+    }
+#endif
+    return pdMS_TO_TICKS(30000);
+}
+
+// 内部RAM碎片率（千分比）：1 - 最大空闲块 / 空闲总量
+static uint32_t heap_fragmentation_permille(void)
+{
+    size_t free_size = heap_caps_get_free_size(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    size_t largest = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    return (free_size > 0) ? (uint32_t)(1000 - (uint64_t)largest * 1000 / free_size) : 0;
 }
 
 // HomeAssistant 监控任务：处理所有同步的 HTTP 轮询
@@ -208,17 +1157,28 @@ void ha_monitor_task(void *arg)
     ESP_LOGI(TAG, "启动 HA 监控任务");
     
     // 初始化定时器
-    TickType_t last_energy_update = xTaskGetTickCount() - pdMS_TO_TICKS(30000);
-    TickType_t last_switch_update = xTaskGetTickCount() - pdMS_TO_TICKS(30000);
+    TickType_t last_entity_update = 0;
+    bool entities_polled = false;     // 启动后先完整轮询一次，之后按间隔轮询
     TickType_t last_weather_update = 0;
+    TickType_t last_metrics_report = xTaskGetTickCount();
+    http_buffer_stats_t last_buffer_stats = {0};
+    uint32_t worst_fragmentation = 0;   // 本统计周期内碎片率的最大值（千分比）
     
-    const TickType_t energy_update_interval = pdMS_TO_TICKS(30000);
-    const TickType_t switch_update_interval = pdMS_TO_TICKS(30000); // 开关刷新频率降至 30s
     const TickType_t weather_update_interval = pdMS_TO_TICKS(30 * 60 * 1000);
-
-    // 开关状态缓存
-    static int cached_switch_states[5] = {-1, -1, -1, -1, -1};
-    const char *switch_entities[5] = {NULL, "switch.tasmota", "switch.new_dc1_3", "switch.new_dc1_4", "switch.tasmota_2"};
+    const TickType_t metrics_report_interval = pdMS_TO_TICKS(60000);
+    
+    // 未设置访问令牌时HA会拒绝所有请求，只更新天气
+    const bool ha_enabled = ha_token_configured();
+    if (!ha_enabled) {
+        ESP_LOGE(TAG, "未设置HA访问令牌 (CONFIG_SMART_PANEL_HA_TOKEN)，不连接 Home Assistant");
+    }
+    
+#if CONFIG_SMART_PANEL_HA_WEBSOCKET
+    // WebSocket 客户端自行重连，WiFi断开期间也无需停止
+    if (ha_enabled && ha_websocket_start(s_ha_entities, sizeof(s_ha_entities) / sizeof(s_ha_entities[0])) != ESP_OK) {
+        ESP_LOGE(TAG, "启动HA WebSocket客户端失败，继续使用HTTP轮询");
+    }
+#endif
     
     // 注册到看门狗
     esp_task_wdt_add(NULL);
@@ -226,6 +1186,12 @@ void ha_monitor_task(void *arg)
     while (1) {
         esp_task_wdt_reset();
         
+        // 每轮采样一次内部RAM碎片率，统计周期内取最大值
+        uint32_t fragmentation = heap_fragmentation_permille();
+        if (fragmentation > worst_fragmentation) {
+            worst_fragmentation = fragmentation;
+        }
+        
         // 检查WiFi连接状态,如果未连接则跳过所有HTTP请求
         if (!is_wifi_connected()) {
             ESP_LOGD(TAG, "WiFi未连接,跳过HA监控任务");
@@ -233,104 +1199,27 @@ void ha_monitor_task(void *arg)
             continue;
         }
         
+#if CONFIG_SMART_PANEL_HTTP_BENCH
+        static bool bench_done = false;
+        if (!bench_done && ha_enabled) {
+            bench_done = true;
+            ha_http_bench();
+        }
+#endif
+        
         TickType_t now = xTaskGetTickCount();
 
-        // 1. 更新能耗数据 (30秒)
-        if ((now - last_energy_update) >= energy_update_interval) {
-            last_energy_update = now;
-            
-            // 获取每日能耗
-            char *d_s = get_daily_energy();
-            if (d_s) {
-                float d_v = atof(d_s);
-                if (fabs(d_v - current_daily_energy) > 0.01) {
-                    ui_update_t *uu = malloc(sizeof(ui_update_t));
-                    if (uu) {
-                        uu->type = UI_UPDATE_TYPE_DAILY_ENERGY;
-                        sprintf(uu->value.str_value, " #FF0000 %.1f# #5F6777 kW##04905E $%.2f#", d_v, d_v * 1.2);
-                        event_system_post(EVENT_TYPE_UI_UPDATE, uu, sizeof(ui_update_t));
-                    }
-                    current_daily_energy = d_v;
-                }
-                free(d_s);
-            }
-            esp_task_wdt_reset(); // 重置看门狗
-            
-            // 获取每月能耗
-            char *m_s = get_monthly_energy();
-            if (m_s) {
-                float m_v = atof(m_s);
-                if (fabs(m_v - current_monthly_energy) > 0.01) {
-                    ui_update_t *uu = malloc(sizeof(ui_update_t));
-                    if (uu) {
-                        uu->type = UI_UPDATE_TYPE_MONTHLY_ENERGY;
-                        sprintf(uu->value.str_value, " #FF0000 %.1f# #5F6777 kW##04905E $%.2f#", m_v, m_v * 1.2);
-                        event_system_post(EVENT_TYPE_UI_UPDATE, uu, sizeof(ui_update_t));
-                    }
-                    current_monthly_energy = m_v;
-                }
-                free(m_s);
-            }
-            esp_task_wdt_reset(); // 重置看门狗
-
-            // 获取室内温度
-            char *i_t = get_entity_state("sensor.zhimi_cn_94444656_ma2_temperature_p_3_3");
-            if (i_t) {
-                if (strcmp(i_t, current_indoor_temp) != 0) {
-                    ui_update_t *uu = malloc(sizeof(ui_update_t));
-                    if (uu) {
-                        uu->type = UI_UPDATE_TYPE_INDOOR_TEMP;
-                        sprintf(uu->value.str_value, "%s°C", i_t);
-                        event_system_post(EVENT_TYPE_UI_UPDATE, uu, sizeof(ui_update_t));
-                    }
-                    strncpy(current_indoor_temp, i_t, sizeof(current_indoor_temp)-1);
-                }
-                free(i_t);
-            }
-            esp_task_wdt_reset(); // 重置看门狗
-            
-            // 获取室内湿度
-            char *i_h = get_entity_state("sensor.zhimi_cn_94444656_ma2_relative_humidity_p_3_1");
-            if (i_h) {
-                if (strcmp(i_h, current_indoor_hum) != 0) {
-                    ui_update_t *uu = malloc(sizeof(ui_update_t));
-                    if (uu) {
-                        uu->type = UI_UPDATE_TYPE_INDOOR_HUM;
-                        sprintf(uu->value.str_value, "%s%%", i_h);
-                        event_system_post(EVENT_TYPE_UI_UPDATE, uu, sizeof(ui_update_t));
-                    }
-                    strncpy(current_indoor_hum, i_h, sizeof(current_indoor_hum)-1);
-                }
-                free(i_h);
-            }
+        // 1. 更新能耗、室内数据和开关状态 (30秒，有推送时降为对账)，一次请求读取全部实体
+        TickType_t entity_update_interval = ha_entity_poll_interval();
+        if (ha_enabled && (!entities_polled || (now - last_entity_update) >= entity_update_interval)) {
+            last_entity_update = now;
+            entities_polled = true;
+            get_entity_states(s_ha_entities, sizeof(s_ha_entities) / sizeof(s_ha_entities[0]),
+                              event_system_apply_ha_state);
             esp_task_wdt_reset(); // 重置看门狗
         }
 
-        // 2. 更新开关状态 (30秒)
-        now = xTaskGetTickCount();
-        if ((now - last_switch_update) >= switch_update_interval) {
-            last_switch_update = now;
-            for (int i = 1; i <= 4; i++) {
-                char *state_str = get_entity_state(switch_entities[i]);
-                if (state_str) {
-                    int state = (strcmp(state_str, "on") == 0 || strcmp(state_str, "ON") == 0) ? 1 : 0;
-                    if (state != cached_switch_states[i]) {
-                        ui_update_t *uu = malloc(sizeof(ui_update_t));
-                        if (uu) {
-                            uu->type = UI_UPDATE_TYPE_SWITCH_STATE;
-                            uu->value.int_value = (i << 8) | state;
-                            event_system_post(EVENT_TYPE_UI_UPDATE, uu, sizeof(ui_update_t));
-                        }
-                        cached_switch_states[i] = state;
-                        ESP_LOGI(TAG, "开关 %d (%s) 状态更新: %d", i, switch_entities[i], state);
-                    }
-                    free(state_str);
-                }
-                esp_task_wdt_reset();
-            }
-        }
-
-        // 3. 获取室外天气 (30分钟)
+        // 2. 获取室外天气 (30分钟)
         now = xTaskGetTickCount();
         bool time_synced = (time(NULL) > 1700000000); 
         if (time_synced && (last_weather_update == 0 || (now - last_weather_update) >= weather_update_interval)) {
@@ -353,268 +1242,192 @@ void ha_monitor_task(void *arg)
             
             esp_task_wdt_reset(); // 重置看门狗
 
-            http_config_t http_cfg = {
-                .url = weather_url,
-                .method = HTTP_METHOD_GET,
-                .timeout_ms = 5000 // 减少超时时间从8秒到5秒
+            http_async_request_t weather_req = {
+                .http = {
+                    .url = weather_url,
+                    .method = HTTP_METHOD_GET,
+                    .timeout_ms = 5000, // 减少超时时间从8秒到5秒
+                    .validators = &g_weather_validators, // 同一天的数据未变化时服务器返回304
+                },
+                .max_retries = 3, // 最多尝试3次
+                .lane = EVENT_LANE_BULK,
+                .on_data = weather_stream_cb,
             };
 
-            char *response = http_send_request_with_retry(&http_cfg, 3); // 使用重试机制，最多重试3次
+            // 响应边接收边解析，不保留响应文本也不构建DOM；中途失败时不改动 g_24h_weather_data
+            weather_parse_t weather = {0};
+            const json_stream_sub_t weather_subs[] = {
+                {"hourly.time[*]", weather_on_time, &weather},
+                {"hourly.temperature_2m[*]", weather_on_value, &weather},
+                {"hourly.apparent_temperature[*]", weather_on_value, &weather},
+                {"hourly.weather_code[*]", weather_on_value, &weather},
+                {"hourly.relative_humidity_2m[*]", weather_on_value, &weather},
+            };
+            json_stream_init(&weather.parser, weather_subs, sizeof(weather_subs) / sizeof(weather_subs[0]));
+            weather_req.stream_ctx = &weather;
+            http_async_result_t weather_result;
+            esp_err_t err = http_async_perform(&weather_req, &weather_result); // 在HTTP工作任务中接收，本任务等待期间喂狗
+            http_async_release(&weather_result);
             esp_task_wdt_reset(); // 重置看门狗，HTTP请求完成后立即重置
-            
-            if (response) {
-                cJSON *root = cJSON_Parse(response);
-                if (root) {
-                    cJSON *hourly = cJSON_GetObjectItem(root, "hourly");
-                    if (hourly) {
-                        cJSON *times = cJSON_GetObjectItem(hourly, "time");
-                        cJSON *codes = cJSON_GetObjectItem(hourly, "weather_code");
-                        cJSON *temps = cJSON_GetObjectItem(hourly, "temperature_2m");
-                        cJSON *hums = cJSON_GetObjectItem(hourly, "relative_humidity_2m");
-                        cJSON *apparent_temps = cJSON_GetObjectItem(hourly, "apparent_temperature");
-                        
-                        if (times && codes && temps && hums && apparent_temps) {
-                            int size = cJSON_GetArraySize(times);
-                            int current_hour = timeinfo.tm_hour;
-                            int idx = -1;
-                            
-                            // 保存24小时天气数据
-                            g_24h_weather_count = (size > 24) ? 24 : size;
-                            for (int i = 0; i < g_24h_weather_count; i++) {
-                                cJSON *t = cJSON_GetArrayItem(temps, i);
-                                cJSON *c = cJSON_GetArrayItem(codes, i);
-                                cJSON *h = cJSON_GetArrayItem(hums, i);
-                                cJSON *at = cJSON_GetArrayItem(apparent_temps, i);
-                                
-                                if (t && c && h && at) {
-                                    g_24h_weather_data[i].temperature = t->valuedouble;
-                                    g_24h_weather_data[i].apparent_temperature = at->valuedouble;
-                                    g_24h_weather_data[i].weather_code = c->valueint;
-                                    g_24h_weather_data[i].humidity = (int)h->valuedouble;
-                                }
-                            }
-                            ESP_LOGI(TAG, "已保存 %d 小时天气数据", g_24h_weather_count);
-                            
-                            esp_task_wdt_reset(); // 重置看门狗
-                            
-                            // 查找当前小时的索引用于UI更新
-                            for (int i = 0; i < size; i++) {
-                                cJSON *time_item = cJSON_GetArrayItem(times, i);
-                                if (time_item && cJSON_IsString(time_item)) {
-                                    int h_val;
-                                    if (sscanf(time_item->valuestring, "%*[^T]T%d", &h_val) == 1) {
-                                        if (h_val == current_hour) {
-                                            idx = i;
-                                            break;
-                                        }
-                                    }
-                                }
-                            }
-                            
-                            esp_task_wdt_reset(); // 重置看门狗
-                            
-                            // 更新当前小时的UI显示
-                            if (idx != -1) {
-                                cJSON *c = cJSON_GetArrayItem(codes, idx);
-                                cJSON *t = cJSON_GetArrayItem(temps, idx);
-                                cJSON *h = cJSON_GetArrayItem(hums, idx);
-                                if (c && t && h) {
-                                    const char *desc = get_weather_desc(c->valueint);
-                                    
-                                    ui_update_t *uu;
-                                    uu = malloc(sizeof(ui_update_t));
-                                    if (uu) { uu->type = UI_UPDATE_TYPE_WEATHER_DESC; sprintf(uu->value.str_value, "%s", desc); event_system_post(EVENT_TYPE_UI_UPDATE, uu, sizeof(ui_update_t)); }
-                                    cJSON *at = cJSON_GetArrayItem(apparent_temps, idx);
-                                    uu = malloc(sizeof(ui_update_t));
-                                    if (uu) { uu->type = UI_UPDATE_TYPE_WEATHER_TEMP; sprintf(uu->value.str_value, "%d|%dC", (int)t->valuedouble, (int)at->valuedouble); event_system_post(EVENT_TYPE_UI_UPDATE, uu, sizeof(ui_update_t)); }
-                                    uu = malloc(sizeof(ui_update_t));
-                                    if (uu) { uu->type = UI_UPDATE_TYPE_WEATHER_HUM; sprintf(uu->value.str_value, "%.0f%%", h->valuedouble); event_system_post(EVENT_TYPE_UI_UPDATE, uu, sizeof(ui_update_t)); }
-                                }
-                            }
-                        }
-                        cJSON_Delete(root);
-                    }
+
+            if (err == ESP_ERR_HTTP_NOT_MODIFIED) {
+                // 数据未变化：没有接收和解析，按当前小时更新显示
+                ESP_LOGI(TAG, "天气数据未变化，沿用 %d 小时数据", g_24h_weather_count);
+                weather_show_hour(timeinfo.tm_hour);
+            } else if (err == ESP_OK && json_stream_finish(&weather.parser) == 0) {
+                memcpy(g_24h_weather_data, weather.data, sizeof(g_24h_weather_data));
+                memcpy(g_24h_weather_hour, weather.hour, sizeof(g_24h_weather_hour));
+                g_24h_weather_count = weather.count;
+                ESP_LOGI(TAG, "已保存 %d 小时天气数据", g_24h_weather_count);
+                weather_show_hour(timeinfo.tm_hour);
+            } else {
+                // 接收或解析失败，保留原有数据；校验值可能已换成这次响应的，下次不发送条件请求
+                memset(&g_weather_validators, 0, sizeof(g_weather_validators));
+                if (err == ESP_OK) {
+                    ESP_LOGE(TAG, "天气数据JSON不完整");
                 }
-                free(response);
             }
             esp_task_wdt_reset(); // 重置看门狗
         }
 
+        // 3. 上报事件延迟统计 (60秒)，每个周期重新统计
+        now = xTaskGetTickCount();
+        if ((now - last_metrics_report) >= metrics_report_interval) {
+            last_metrics_report = now;
+            event_metrics_dump();
+            event_metrics_publish();
+            event_metrics_reset();
+            
+            http_pool_stats_t pool_stats;
+            http_service_get_pool_stats(&pool_stats);
+            ESP_LOGI(TAG, "HTTP连接池: 命中 %u, 未命中 %u, 失效重连 %u, 网络状态: %s", (unsigned int)pool_stats.hits,
+                     (unsigned int)pool_stats.misses, (unsigned int)pool_stats.stale,
+                     net_reachability_state_name(net_reachability_get_state()));
+            
+            // 响应缓冲区：本周期读入缓冲区的响应数、分配次数和304次数，稳定后分配次数应为0
+            http_buffer_stats_t buffer_stats;
+            http_service_get_buffer_stats(&buffer_stats);
+            ESP_LOGI(TAG, "HTTP响应缓冲区: 响应 %u, 分配 %u, 最大容量 %u, 304 %u (省去 %u 字节); "
+                     "内部RAM 空闲 %u, 最大块 %u, 最差碎片率 %u.%u%%",
+                     (unsigned int)(buffer_stats.responses - last_buffer_stats.responses),
+                     (unsigned int)(buffer_stats.allocs - last_buffer_stats.allocs),
+                     (unsigned int)buffer_stats.peak_cap,
+                     (unsigned int)(buffer_stats.not_modified - last_buffer_stats.not_modified),
+                     (unsigned int)(buffer_stats.saved_bytes - last_buffer_stats.saved_bytes),
+                     (unsigned int)heap_caps_get_free_size(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT),
+                     (unsigned int)heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT),
+                     (unsigned int)(worst_fragmentation / 10), (unsigned int)(worst_fragmentation % 10));
+            last_buffer_stats = buffer_stats;
+            worst_fragmentation = 0;
+            esp_task_wdt_reset(); // 重置看门狗
+        }
+
         vTaskDelay(pdMS_TO_TICKS(1000));
     }
 }
 
+// 每次门铃事件处理批量通道MQTT消息的时间预算（微秒）
+#define MQTT_BULK_BUDGET_US 5000
+
+// 原地处理环形缓冲区中的MQTT消息，返回 false 表示超出预算时仍有剩余
+static bool drain_mqtt_ring(event_lane_t lane, uint32_t budget_us)
+{
+    mqtt_ring_t *ring = mqtt_client_get_ring(lane);
+    uint32_t start = event_metrics_now_us();
+    mqtt_message_t mqtt_msg;
+    
+    while (mqtt_ring_peek(ring, &mqtt_msg)) {
+        mqtt_dispatch_message(&mqtt_msg);
+        mqtt_ring_pop(ring);
+        if (event_metrics_now_us() - start >= budget_us) {
+            return !mqtt_ring_peek(ring, &mqtt_msg);
+        }
+    }
+    return true;
+}
+
+// 先取完交互通道的MQTT消息，再在预算内处理批量通道
+static void drain_mqtt_rings(void)
+{
+    drain_mqtt_ring(EVENT_LANE_INTERACTIVE, UINT32_MAX);
+    if (!drain_mqtt_ring(EVENT_LANE_BULK, MQTT_BULK_BUDGET_US)) {
+        // 批量消息未处理完，重新敲门铃，让队列中的其他事件先得到处理
+        event_system_post_owned_lane(EVENT_TYPE_MQTT_MESSAGE_RECEIVED, NULL, 0, EVENT_LANE_BULK);
+    }
+}
+
+// MQTT门铃事件：消息本身在环形缓冲区中
+static void on_mqtt_doorbell(const event_t *event, void *ctx)
+{
+    drain_mqtt_rings();
+}
+
+// 系统事件日志，ctx 为日志文本
+static void log_system_event(const event_t *event, void *ctx)
+{
+    ESP_LOGI(TAG, "%s", (const char *)ctx);
+}
+
+// 内置的系统事件订阅
+static const struct {
+    event_type_t type;
+    event_callback_t callback;
+    const char *ctx;
+} s_builtin_subscriptions[] = {
+    {EVENT_TYPE_WIFI_CONNECTED,        log_system_event, "WiFi连接成功事件处理"},
+    {EVENT_TYPE_WIFI_DISCONNECTED,     log_system_event, "WiFi断开事件处理"},
+    {EVENT_TYPE_BUTTON_CLICK,          log_system_event, "按钮点击事件处理"},
+    {EVENT_TYPE_TOUCH_EVENT,           log_system_event, "触摸事件处理"},
+    {EVENT_TYPE_LOAD_XML,              log_system_event, "加载XML事件处理"},
+    {EVENT_TYPE_REFRESH_XML,           log_system_event, "刷新XML事件处理"},
+    {EVENT_TYPE_MQTT_CONNECTED,        log_system_event, "MQTT连接成功事件处理"},
+    {EVENT_TYPE_MQTT_DISCONNECTED,     log_system_event, "MQTT断开连接事件处理"},
+    {EVENT_TYPE_MQTT_MESSAGE_RECEIVED, on_mqtt_doorbell, NULL},
+};
+
 // 事件处理任务
 void event_system_task(void *arg)
 {
     ESP_LOGI(TAG, "启动事件处理任务");
     
+    // 订阅内置的系统事件处理，其他模块可以为同一事件类型追加订阅
+    for (size_t i = 0; i < sizeof(s_builtin_subscriptions) / sizeof(s_builtin_subscriptions[0]); i++) {
+        event_subscriber_t subscriber = {
+            .delivery = EVENT_DELIVERY_CALLBACK,
+            .callback = s_builtin_subscriptions[i].callback,
+            .ctx = (void *)s_builtin_subscriptions[i].ctx,
+        };
+        event_system_subscribe(s_builtin_subscriptions[i].type, &subscriber, NULL);
+    }
+    
     // 注册到看门狗
     esp_task_wdt_add(NULL);
     
     while (1) {
         // 等待系统事件队列中的事件
         event_t event;
-        BaseType_t ret = xQueueReceive(g_system_event_queue, &event, pdMS_TO_TICKS(10));
+        esp_err_t ret = event_system_receive(EVENT_QUEUE_SYSTEM, &event, pdMS_TO_TICKS(10));
         
         // 喂狗
         esp_task_wdt_reset();
 
-        if (ret == pdPASS) {
+        if (ret == ESP_OK) {
             // 计算事件从发送到接收的耗时
-            TickType_t receive_time = xTaskGetTickCount();
-            TickType_t delay_ticks = receive_time - event.send_time;
-            uint32_t delay_ms = pdTICKS_TO_MS(delay_ticks);
-            ESP_LOGD(TAG, "收到系统事件: %d, 耗时: %u ms", event.type, delay_ms);
+            uint32_t receive_time = event_metrics_now_us();
+            uint32_t wait_us = receive_time - event.send_time;
+            event_metrics_record_event(event.type, EVENT_METRIC_QUEUE_WAIT, wait_us);
+            ESP_LOGD(TAG, "收到系统事件: %d, 耗时: %u us", event.type, (unsigned int)wait_us);
             
-            // 根据事件类型处理系统事件
-            switch (event.type) {
-                case EVENT_TYPE_WIFI_CONNECTED:
-                    ESP_LOGI(TAG, "WiFi连接成功事件处理");
-                    break;
-                case EVENT_TYPE_WIFI_DISCONNECTED:
-                    ESP_LOGI(TAG, "WiFi断开事件处理");
-                    break;
-                case EVENT_TYPE_BUTTON_CLICK:
-                    ESP_LOGI(TAG, "按钮点击事件处理");
-                    break;
-                case EVENT_TYPE_TOUCH_EVENT:
-                    ESP_LOGI(TAG, "触摸事件处理");
-                    break;
-                case EVENT_TYPE_LOAD_XML:
-                    ESP_LOGI(TAG, "加载XML事件处理");
-                    break;
-                case EVENT_TYPE_REFRESH_XML:
-                    ESP_LOGI(TAG, "刷新XML事件处理");
-                    break;
-                case EVENT_TYPE_MQTT_CONNECTED:
-                    ESP_LOGI(TAG, "MQTT连接成功事件处理");
-                    break;
-                case EVENT_TYPE_MQTT_DISCONNECTED:
-                    ESP_LOGI(TAG, "MQTT断开连接事件处理");
-                    break;
-                case EVENT_TYPE_MQTT_MESSAGE_RECEIVED:
-                    // 只有在有数据时才处理
-                    if (event.data != NULL) {
-                        mqtt_message_t *mqtt_msg = (mqtt_message_t *)event.data;
-                        if (mqtt_msg->topic != NULL && mqtt_msg->data != NULL) {
-                            if (strcmp(mqtt_msg->topic, "homeassistant/number/esp32_music_player/volume/set") == 0) {
-                                ESP_LOGI(TAG, "忽略自己发布的音量设置消息");
-                            } else if (strcmp(mqtt_msg->topic, "homeassistant/sensor/esp32_music_player/lyrics/state") == 0) {
-                                if (strcmp(mqtt_msg->data, current_song_lyrics) != 0) {
-                                    ui_update_t *ui_update = malloc(sizeof(ui_update_t));
-                                    if (ui_update != NULL) {
-                                        ui_update->type = UI_UPDATE_TYPE_LYRICS;
-                                        strncpy(ui_update->value.str_value, mqtt_msg->data, sizeof(ui_update->value.str_value) - 1);
-                                        ui_update->value.str_value[sizeof(ui_update->value.str_value)-1] = '\0';
-                                        event_system_post(EVENT_TYPE_UI_UPDATE, ui_update, sizeof(ui_update_t));
-                                    }
-                                    strncpy(current_song_lyrics, mqtt_msg->data, sizeof(current_song_lyrics)-1);
-                                }
-                            } else if (strcmp(mqtt_msg->topic, "homeassistant/sensor/esp32_music_player/song/state") == 0) {
-                                if (strcmp(mqtt_msg->data, current_song_name) != 0) {
-                                    ui_update_t *ui_update = malloc(sizeof(ui_update_t));
-                                    if (ui_update != NULL) {
-                                        ui_update->type = UI_UPDATE_TYPE_SONG_NAME;
-                                        strncpy(ui_update->value.str_value, mqtt_msg->data, sizeof(ui_update->value.str_value) - 1);
-                                        ui_update->value.str_value[sizeof(ui_update->value.str_value)-1] = '\0';
-                                        event_system_post(EVENT_TYPE_UI_UPDATE, ui_update, sizeof(ui_update_t));
-                                    }
-                                    strncpy(current_song_name, mqtt_msg->data, sizeof(current_song_name)-1);
-                                }
-                            } else if (strcmp(mqtt_msg->topic, "homeassistant/sensor/esp32_music_player/artist/state") == 0) {
-                                if (strcmp(mqtt_msg->data, current_song_artist) != 0) {
-                                    ui_update_t *ui_update = malloc(sizeof(ui_update_t));
-                                    if (ui_update != NULL) {
-                                        ui_update->type = UI_UPDATE_TYPE_ARTIST;
-                                        strncpy(ui_update->value.str_value, mqtt_msg->data, sizeof(ui_update->value.str_value) - 1);
-                                        ui_update->value.str_value[sizeof(ui_update->value.str_value)-1] = '\0';
-                                        event_system_post(EVENT_TYPE_UI_UPDATE, ui_update, sizeof(ui_update_t));
-                                    }
-                                    strncpy(current_song_artist, mqtt_msg->data, sizeof(current_song_artist)-1);
-                                }
-                            } else if (strcmp(mqtt_msg->topic, "homeassistant/number/esp32_music_player/position/state") == 0) {
-                                float p_f = atof(mqtt_msg->data);
-                                int p = (int)(p_f * 100);
-                                if (p != current_play_progress) {
-                                    ui_update_t *ui_update = malloc(sizeof(ui_update_t));
-                                    if (ui_update != NULL) {
-                                        ui_update->type = UI_UPDATE_TYPE_PLAY_PROGRESS;
-                                        ui_update->value.int_value = p;
-                                        event_system_post(EVENT_TYPE_UI_UPDATE, ui_update, sizeof(ui_update_t));
-                                    }
-                                    current_play_progress = p;
-                                }
-                            } else if (strcmp(mqtt_msg->topic, "homeassistant/number/esp32_music_player/volume/state") == 0) {
-                                int vol = atoi(mqtt_msg->data);
-                                if (vol != current_volume) {
-                                    ui_update_t *ui_update = malloc(sizeof(ui_update_t));
-                                    if (ui_update != NULL) {
-                                        ui_update->type = UI_UPDATE_TYPE_VOLUME;
-                                        ui_update->value.int_value = vol;
-                                        event_system_post(EVENT_TYPE_UI_UPDATE, ui_update, sizeof(ui_update_t));
-                                    }
-                                    current_volume = vol;
-                                }
-                            } else if (strcmp(mqtt_msg->topic, "homeassistant/sensor/esp32_music_player/progress/state") == 0) {
-                                if (strcmp(mqtt_msg->data, current_song_time) != 0) {
-                                    ui_update_t *ui_update = malloc(sizeof(ui_update_t));
-                                    if (ui_update != NULL) {
-                                        ui_update->type = UI_UPDATE_TYPE_SONG_TIME;
-                                        strncpy(ui_update->value.str_value, mqtt_msg->data, sizeof(ui_update->value.str_value) - 1);
-                                        ui_update->value.str_value[sizeof(ui_update->value.str_value)-1] = '\0';
-                                        event_system_post(EVENT_TYPE_UI_UPDATE, ui_update, sizeof(ui_update_t));
-                                    }
-                                    strncpy(current_song_time, mqtt_msg->data, sizeof(current_song_time)-1);
-                                }
-                            } else if (strcmp(mqtt_msg->topic, "tele/tasmota_A0DA50/SENSOR") == 0) {
-                                cJSON *root = cJSON_Parse(mqtt_msg->data);
-                                if (root != NULL) {
-                                    cJSON *energy = cJSON_GetObjectItem(root, "ENERGY");
-                                    if (energy != NULL) {
-                                        cJSON *power = cJSON_GetObjectItem(energy, "Power");
-                                        if (power != NULL && cJSON_IsNumber(power)) {
-                                            float pv = power->valuedouble;
-                                            if (fabs(pv - current_power) > 0.1) {
-                                                ui_update_t *ui_update = malloc(sizeof(ui_update_t));
-                                                if (ui_update != NULL) {
-                                                    ui_update->type = UI_UPDATE_TYPE_POWER;
-                                                    ui_update->value.int_value = (int)(pv * 10.0);
-                                                    event_system_post(EVENT_TYPE_UI_UPDATE, ui_update, sizeof(ui_update_t));
-                                                }
-                                                current_power = pv;
-                                            }
-                                        }
-                                    }
-                                    cJSON_Delete(root);
-                                }
-                            } else if (strcmp(mqtt_msg->topic, "homeassistant/sensor/esp32_music_player/url/state") == 0) {
-                                ESP_LOGI(TAG, "收到专辑封面 URL: %s", mqtt_msg->data);
-                                request_album_art_update(mqtt_msg->data, 100, 100, false);
-                            } else if (strcmp(mqtt_msg->topic, "homeassistant/switch/esp32_music_player/play/state") == 0) {
-                                bool is_on = (strcmp(mqtt_msg->data, "ON") == 0);
-                                ui_update_t *ui_update = malloc(sizeof(ui_update_t));
-                                if (ui_update != NULL) {
-                                    ui_update->type = UI_UPDATE_TYPE_PLAY_STATE;
-                                    ui_update->value.int_value = is_on ? 1 : 0;
-                                    event_system_post(EVENT_TYPE_UI_UPDATE, ui_update, sizeof(ui_update_t));
-                                }
-                            }
-                        }
-                        // 统一释放子内存
-                        if (mqtt_msg->topic) free(mqtt_msg->topic);
-                        if (mqtt_msg->data) free(mqtt_msg->data);
-                    }
-                    break;
-                default:
-                    ESP_LOGE(TAG, "未知系统事件类型: %d", event.type);
-                    break;
-            }
+            // 投递给所有订阅者
+            event_system_dispatch(&event);
             
-            // 释放事件容器内存 (mqtt_msg 等)
-            if (event.data != NULL) {
-                free(event.data);
-            }
+            event_metrics_record_event(event.type, EVENT_METRIC_HANDLER, event_metrics_now_us() - receive_time);
+            
+            // 归还事件负载
+            event_system_release(&event);
+        } else {
+            // 兜底：门铃事件丢失时（队列满等），空闲超时后直接检查环形缓冲区，入站消息不会一直积压
+            drain_mqtt_rings();
         }
         // 核心任务只负责处理队列，不再包含同步 HTTP 轮询逻辑
         // 轮询逻辑已迁移至 ha_monitor_task
@@ -629,3 +1442,14 @@ const hourly_weather_t* get_24h_weather_data(int *count)
     }
     return g_24h_weather_data;
 }
+
+// 获取最近一次收到的智能插座电量数据（副本）
+void get_plug_energy_data(plug_energy_t *data)
+{
+    if (data == NULL) {
+        return;
+    }
+    portENTER_CRITICAL(&s_plug_energy_lock);
+    *data = g_plug_energy;
+    portEXIT_CRITICAL(&s_plug_energy_lock);
+}
@@ -0,0 +1,376 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_websocket_client.h"
+#include "cJSON.h"
+#include "event_system.h"
+#include "homeassistant.h"
+#include "ha_websocket.h"
+
+static const char *TAG = "ha_websocket";
+
+// HA WebSocket API 地址
+#define HA_WS_URI "ws://" HA_HOST "/api/websocket"
+
+// 单条消息的最大长度，subscribe_entities 的首条消息包含全部实体的属性
+#define HA_WS_RX_MAX (16 * 1024)
+
+// 发送超时，只在发送任务中等待，不阻塞LVGL任务
+#define HA_WS_SEND_TIMEOUT_MS 1000
+
+// 待发送命令队列长度，队列满时服务调用改用HTTP
+#define HA_WS_TX_QUEUE_LEN 8
+
+// 服务调用各字段的最大长度（含结尾的 '\0'）
+#define HA_WS_DOMAIN_MAX 32
+#define HA_WS_SERVICE_MAX 32
+#define HA_WS_ENTITY_MAX 64
+
+// 断开后的重连间隔
+#define HA_WS_RECONNECT_MS 5000
+
+static esp_websocket_client_handle_t s_client = NULL;
+static const char *const *s_entity_ids = NULL;
+static size_t s_entity_count = 0;
+
+// 认证通过后才能发送命令；订阅成功后实体状态由推送更新
+static volatile bool s_authenticated = false;
+static volatile bool s_subscribed = false;
+
+// 带ID的命令，由发送任务依次分配ID并发出
+typedef enum {
+    HA_WS_CMD_SUBSCRIBE,
+    HA_WS_CMD_CALL_SERVICE,
+} ha_ws_cmd_type_t;
+
+typedef struct {
+    ha_ws_cmd_type_t type;
+    char domain[HA_WS_DOMAIN_MAX];
+    char service[HA_WS_SERVICE_MAX];
+    char entity_id[HA_WS_ENTITY_MAX];
+} ha_ws_cmd_t;
+
+static QueueHandle_t s_tx_queue = NULL;
+
+// 命令ID，HA 要求同一连接内严格递增；只在发送任务中分配，分配与发送的顺序一致
+static int s_next_id = 1;
+static volatile int s_subscribe_id = 0;
+
+// 分段到达的消息在此拼接
+static char *s_rx_buf = NULL;
+static size_t s_rx_len = 0;
+
+static esp_err_t send_text(const char *text, int len)
+{
+    if (esp_websocket_client_send_text(s_client, text, len, pdMS_TO_TICKS(HA_WS_SEND_TIMEOUT_MS)) < 0) {
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+static void send_auth(void)
+{
+    static const char auth[] = "{\"type\":\"auth\",\"access_token\":\"" HA_ACCESS_TOKEN "\"}";
+    if (send_text(auth, sizeof(auth) - 1) != ESP_OK) {
+        ESP_LOGE(TAG, "发送认证消息失败");
+    }
+}
+
+// 订阅面板显示的实体，HA 先推送全部实体的当前状态，之后只推送变化
+static void send_subscribe(void)
+{
+    char msg[1024];
+    s_subscribe_id = s_next_id++;
+    int len = snprintf(msg, sizeof(msg), "{\"id\":%d,\"type\":\"subscribe_entities\",\"entity_ids\":[", s_subscribe_id);
+    for (size_t i = 0; i < s_entity_count && len < (int)sizeof(msg); i++) {
+        len += snprintf(msg + len, sizeof(msg) - len, "%s\"%s\"", (i > 0) ? "," : "", s_entity_ids[i]);
+    }
+    if (len < (int)sizeof(msg)) {
+        len += snprintf(msg + len, sizeof(msg) - len, "]}");
+    }
+    if (len >= (int)sizeof(msg)) {
+        ESP_LOGE(TAG, "订阅消息过长");
+        return;
+    }
+    if (send_text(msg, len) != ESP_OK) {
+        ESP_LOGE(TAG, "发送实体订阅失败");
+    }
+}
+
+static void send_call_service(const ha_ws_cmd_t *cmd)
+{
+    char msg[256];
+    int id = s_next_id++;
+    int len = snprintf(msg, sizeof(msg),
+                       "{\"id\":%d,\"type\":\"call_service\",\"domain\":\"%s\",\"service\":\"%s\","
+                       "\"target\":{\"entity_id\":\"%s\"}}",
+                       id, cmd->domain, cmd->service, cmd->entity_id);
+    if (len >= (int)sizeof(msg)) {
+        ESP_LOGE(TAG, "服务调用消息过长");
+        return;
+    }
+    if (send_text(msg, len) != ESP_OK) {
+        ESP_LOGE(TAG, "发送服务调用失败: %s.%s", cmd->domain, cmd->service);
+    }
+}
+
+// 发送任务：依次发出订阅和服务调用，发送可能等待 HA_WS_SEND_TIMEOUT_MS，不占用LVGL和客户端任务
+static void tx_task(void *arg)
+{
+    ha_ws_cmd_t cmd;
+    while (1) {
+        if (xQueueReceive(s_tx_queue, &cmd, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        if (!s_authenticated) {
+            // 入队后连接已断开，重连认证后会重新订阅
+            ESP_LOGW(TAG, "连接已断开，丢弃待发送命令");
+            continue;
+        }
+        if (cmd.type == HA_WS_CMD_SUBSCRIBE) {
+            send_subscribe();
+        } else {
+            send_call_service(&cmd);
+        }
+    }
+}
+
+// 应用一个实体的压缩状态 {"s": 状态, "a": 属性, ...}，只关心状态
+static void apply_compressed_state(const char *entity_id, const cJSON *compressed)
+{
+    const cJSON *state = cJSON_GetObjectItem(compressed, "s");
+    if (cJSON_IsString(state)) {
+        event_system_apply_ha_state(entity_id, state->valuestring);
+    }
+}
+
+// subscribe_entities 事件："a" 为新增实体的完整状态，"c" 为变化实体的差异（"+" 中为变化的字段）
+static void handle_entities_event(const cJSON *event)
+{
+    const cJSON *item;
+    const cJSON *added = cJSON_GetObjectItem(event, "a");
+    cJSON_ArrayForEach(item, added) {
+        apply_compressed_state(item->string, item);
+    }
+
+    const cJSON *changed = cJSON_GetObjectItem(event, "c");
+    cJSON_ArrayForEach(item, changed) {
+        apply_compressed_state(item->string, cJSON_GetObjectItem(item, "+"));
+    }
+}
+
+static void handle_result(const cJSON *root, int id)
+{
+    bool success = cJSON_IsTrue(cJSON_GetObjectItem(root, "success"));
+    if (id == s_subscribe_id) {
+        s_subscribed = success;
+        if (success) {
+            ESP_LOGI(TAG, "已订阅 %u 个实体", (unsigned int)s_entity_count);
+        } else {
+            ESP_LOGE(TAG, "实体订阅失败");
+        }
+        return;
+    }
+    if (!success) {
+        const cJSON *message = cJSON_GetObjectItem(cJSON_GetObjectItem(root, "error"), "message");
+        ESP_LOGE(TAG, "命令 %d 失败: %s", id, cJSON_IsString(message) ? message->valuestring : "未知错误");
+    }
+}
+
+static void handle_message(const char *data, size_t len)
+{
+    cJSON *root = cJSON_ParseWithLength(data, len);
+    if (root == NULL) {
+        ESP_LOGE(TAG, "JSON解析失败");
+        return;
+    }
+
+    const cJSON *type = cJSON_GetObjectItem(root, "type");
+    const cJSON *id = cJSON_GetObjectItem(root, "id");
+    const char *type_str = cJSON_IsString(type) ? type->valuestring : "";
+
+    if (strcmp(type_str, "auth_required") == 0) {
+        send_auth();
+    } else if (strcmp(type_str, "auth_ok") == 0) {
+        ESP_LOGI(TAG, "认证成功");
+        // 先标记已认证，发送任务才不会丢弃订阅；订阅插到队首，ID仍由发送任务按发送顺序分配
+        s_authenticated = true;
+        const ha_ws_cmd_t cmd = {.type = HA_WS_CMD_SUBSCRIBE};
+        xQueueSendToFront(s_tx_queue, &cmd, 0);
+    } else if (strcmp(type_str, "auth_invalid") == 0) {
+        const cJSON *message = cJSON_GetObjectItem(root, "message");
+        ESP_LOGE(TAG, "认证失败: %s", cJSON_IsString(message) ? message->valuestring : "");
+    } else if (strcmp(type_str, "result") == 0 && cJSON_IsNumber(id)) {
+        handle_result(root, id->valueint);
+    } else if (strcmp(type_str, "event") == 0 && cJSON_IsNumber(id) && id->valueint == s_subscribe_id) {
+        handle_entities_event(cJSON_GetObjectItem(root, "event"));
+    }
+
+    cJSON_Delete(root);
+}
+
+// 一条消息超过客户端缓冲区时分多次回调，按偏移拼接完整后再解析
+static void handle_data(const esp_websocket_event_data_t *data)
+{
+    // 0x01 文本帧，其余（ping/pong/close 等）由客户端自行处理
+    if (data->op_code != 0x01 || data->data_len <= 0) {
+        return;
+    }
+    if (data->payload_offset == 0 && data->data_len == data->payload_len) {
+        handle_message(data->data_ptr, data->data_len);
+        return;
+    }
+
+    if (data->payload_len > HA_WS_RX_MAX) {
+        if (data->payload_offset == 0) {
+            ESP_LOGW(TAG, "消息过长，丢弃: %d 字节", data->payload_len);
+        }
+        return;
+    }
+    if (data->payload_offset == 0) {
+        s_rx_len = 0;
+    }
+    if (data->payload_offset != (int)s_rx_len) {
+        // 丢失了前面的分段
+        return;
+    }
+    memcpy(s_rx_buf + s_rx_len, data->data_ptr, data->data_len);
+    s_rx_len += data->data_len;
+    if (s_rx_len == (size_t)data->payload_len) {
+        handle_message(s_rx_buf, s_rx_len);
+        s_rx_len = 0;
+    }
+}
+
+static void websocket_event_handler(void *handler_args, esp_event_base_t base, int32_t event_id, void *event_data)
+{
+    esp_websocket_event_data_t *data = (esp_websocket_event_data_t *)event_data;
+
+    switch (event_id) {
+        case WEBSOCKET_EVENT_CONNECTED:
+            ESP_LOGI(TAG, "已连接，等待认证");
+            s_rx_len = 0;
+            break;
+        case WEBSOCKET_EVENT_DISCONNECTED:
+            ESP_LOGW(TAG, "连接断开");
+            s_authenticated = false;
+            s_subscribed = false;
+            // 断开前未发出的命令作废
+            xQueueReset(s_tx_queue);
+            break;
+        case WEBSOCKET_EVENT_DATA:
+            handle_data(data);
+            break;
+        case WEBSOCKET_EVENT_ERROR:
+            ESP_LOGE(TAG, "连接错误");
+            break;
+        default:
+            break;
+    }
+}
+
+esp_err_t ha_websocket_start(const char *const *entity_ids, size_t count)
+{
+    if (entity_ids == NULL || count == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_client != NULL || !ha_token_configured()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // 优先使用 PSRAM，失败时回退到内部RAM
+    s_rx_buf = heap_caps_malloc(HA_WS_RX_MAX, MALLOC_CAP_SPIRAM);
+    if (s_rx_buf == NULL) {
+        s_rx_buf = heap_caps_malloc(HA_WS_RX_MAX, MALLOC_CAP_8BIT);
+    }
+    if (s_rx_buf == NULL) {
+        ESP_LOGE(TAG, "分配接收缓冲区失败");
+        return ESP_ERR_NO_MEM;
+    }
+
+    s_tx_queue = xQueueCreate(HA_WS_TX_QUEUE_LEN, sizeof(ha_ws_cmd_t));
+    if (s_tx_queue == NULL) {
+        heap_caps_free(s_rx_buf);
+        s_rx_buf = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    s_entity_ids = entity_ids;
+    s_entity_count = count;
+
+    esp_websocket_client_config_t config = {
+        .uri = HA_WS_URI,
+        .reconnect_timeout_ms = HA_WS_RECONNECT_MS,
+        .network_timeout_ms = 10000,
+    };
+    s_client = esp_websocket_client_init(&config);
+    if (s_client == NULL) {
+        vQueueDelete(s_tx_queue);
+        s_tx_queue = NULL;
+        heap_caps_free(s_rx_buf);
+        s_rx_buf = NULL;
+        return ESP_FAIL;
+    }
+
+    esp_websocket_register_events(s_client, WEBSOCKET_EVENT_ANY, websocket_event_handler, NULL);
+    TaskHandle_t tx_handle = NULL;
+    esp_err_t err = ESP_ERR_NO_MEM;
+    if (xTaskCreate(tx_task, "ha_ws_tx", 4096, NULL, 4, &tx_handle) == pdPASS) {
+        err = esp_websocket_client_start(s_client);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "启动客户端失败: %s", esp_err_to_name(err));
+        if (tx_handle != NULL) {
+            vTaskDelete(tx_handle);
+        }
+        esp_websocket_client_destroy(s_client);
+        s_client = NULL;
+        vQueueDelete(s_tx_queue);
+        s_tx_queue = NULL;
+        heap_caps_free(s_rx_buf);
+        s_rx_buf = NULL;
+        return err;
+    }
+
+    ESP_LOGI(TAG, "连接 %s", HA_WS_URI);
+    return ESP_OK;
+}
+
+bool ha_websocket_is_ready(void)
+{
+    return s_subscribed;
+}
+
+esp_err_t ha_websocket_call_service(const char *domain, const char *service, const char *entity_id)
+{
+    if (domain == NULL || service == NULL || entity_id == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_client == NULL || !s_authenticated) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    ha_ws_cmd_t cmd = {.type = HA_WS_CMD_CALL_SERVICE};
+    if (strlcpy(cmd.domain, domain, sizeof(cmd.domain)) >= sizeof(cmd.domain) ||
+        strlcpy(cmd.service, service, sizeof(cmd.service)) >= sizeof(cmd.service) ||
+        strlcpy(cmd.entity_id, entity_id, sizeof(cmd.entity_id)) >= sizeof(cmd.entity_id)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    // 只入队不等待，由发送任务分配ID并发出
+    if (xQueueSend(s_tx_queue, &cmd, 0) != pdTRUE) {
+        ESP_LOGW(TAG, "发送队列已满: %s.%s", domain, service);
+        return ESP_ERR_TIMEOUT;
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,319 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_task_wdt.h"
+#include "http_async.h"
+
+static const char *TAG = "http_async";
+
+// 每个通道的请求队列长度，队列满时提交失败而不是阻塞调用者
+#define HTTP_ASYNC_QUEUE_LEN 8
+
+// 工作任务的栈大小（esp_http_client 和流式接收的256字节缓冲区都在此栈上）
+#define HTTP_ASYNC_STACK_SIZE 6144
+
+// 请求头最多复制的键值对数量
+#define HTTP_ASYNC_HEADERS_MAX 8
+
+// 同步等待时每隔多久喂一次看门狗
+#define HTTP_ASYNC_WAIT_SLICE_MS 1000
+
+// 借出响应缓冲区后等待归还的超时，超时仅记录警告后继续等待（缓冲区可能仍在被读取）
+#define HTTP_ASYNC_LEASE_WARN_MS 10000
+
+// 排队中的请求，url、post_data 和请求头复制在 strings 中
+typedef struct {
+    http_config_t http;
+    int max_retries;
+    event_lane_t lane;
+    http_stream_cb_t on_data;
+    void *stream_ctx;
+    http_async_done_t done;
+    void *ctx;
+    int64_t submit_us;
+    http_async_result_t *sync_result;   // http_async_perform: 结果写到这里
+    SemaphoreHandle_t sync_done;        // http_async_perform: 完成后释放
+    const char *headers[HTTP_ASYNC_HEADERS_MAX * 2 + 1];
+    char strings[];
+} http_async_job_t;
+
+// 完成事件的负载，由LVGL任务调用回调
+typedef struct {
+    http_async_done_t done;
+    void *ctx;
+    esp_err_t err;
+    http_view_t response;
+    int64_t elapsed_us;
+    SemaphoreHandle_t lease;
+} http_async_done_event_t;
+
+// 每个通道一个工作任务：交互请求不会排在封面下载、XML加载等后台请求之后
+static QueueHandle_t s_queues[EVENT_LANE_MAX];
+
+// 每个工作任务复用一个响应缓冲区，借出后由接收者通过信号量归还
+static http_arena_t s_arenas[EVENT_LANE_MAX];
+static SemaphoreHandle_t s_leases[EVENT_LANE_MAX];
+
+static const struct {
+    const char *name;
+    UBaseType_t priority;
+} s_workers[EVENT_LANE_MAX] = {
+    [EVENT_LANE_INTERACTIVE] = {"http_async_ia", 4},
+    [EVENT_LANE_BULK]        = {"http_async_bulk", 3},
+};
+
+static char *copy_string(char **dst, const char *src)
+{
+    char *start = *dst;
+    size_t len = strlen(src) + 1;
+    memcpy(start, src, len);
+    *dst += len;
+    return start;
+}
+
+// 复制请求，调用者的字符串在提交返回后即可释放
+static http_async_job_t *job_create(const http_async_request_t *req)
+{
+    size_t header_count = 0;
+    size_t size = strlen(req->http.url) + 1;
+    if (req->http.post_data != NULL) {
+        size += strlen(req->http.post_data) + 1;
+    }
+    if (req->http.headers != NULL) {
+        while (req->http.headers[header_count] != NULL && req->http.headers[header_count + 1] != NULL) {
+            if (header_count >= HTTP_ASYNC_HEADERS_MAX * 2) {
+                ESP_LOGE(TAG, "请求头过多: %s", req->http.url);
+                return NULL;
+            }
+            size += strlen(req->http.headers[header_count]) + strlen(req->http.headers[header_count + 1]) + 2;
+            header_count += 2;
+        }
+    }
+
+    http_async_job_t *job = calloc(1, sizeof(http_async_job_t) + size);
+    if (job == NULL) {
+        return NULL;
+    }
+    char *strings = job->strings;
+    job->http = req->http;
+    job->http.url = copy_string(&strings, req->http.url);
+    if (req->http.post_data != NULL) {
+        job->http.post_data = copy_string(&strings, req->http.post_data);
+    }
+    for (size_t i = 0; i < header_count; i++) {
+        job->headers[i] = copy_string(&strings, req->http.headers[i]);
+    }
+    job->http.headers = (header_count > 0) ? job->headers : NULL;
+
+    job->submit_us = esp_timer_get_time();
+    job->http.deadline_us = (req->deadline_ms > 0) ? job->submit_us + (int64_t)req->deadline_ms * 1000 : 0;
+    job->max_retries = (req->max_retries > 0) ? req->max_retries : 1;
+    job->lane = (req->lane < EVENT_LANE_MAX) ? req->lane : EVENT_LANE_BULK;
+    job->on_data = req->on_data;
+    job->stream_ctx = req->stream_ctx;
+    return job;
+}
+
+static bool deadline_passed(const http_async_job_t *job)
+{
+    return job->http.deadline_us > 0 && esp_timer_get_time() >= job->http.deadline_us;
+}
+
+static void job_run(http_async_job_t *job, http_arena_t *arena, http_async_result_t *result)
+{
+    memset(result, 0, sizeof(*result));
+    if (deadline_passed(job)) {
+        // 排队期间已超时，不再发出请求
+        result->err = ESP_ERR_TIMEOUT;
+    } else if (job->on_data != NULL) {
+        result->err = http_send_request_stream(&job->http, job->max_retries, job->on_data, job->stream_ctx);
+    } else {
+        result->err = http_send_request_arena(&job->http, job->max_retries, arena, &result->response);
+    }
+    if (result->err != ESP_OK && result->err != ESP_ERR_HTTP_NOT_MODIFIED && deadline_passed(job)) {
+        result->err = ESP_ERR_TIMEOUT;
+    }
+    result->elapsed_us = esp_timer_get_time() - job->submit_us;
+}
+
+// 等待接收者归还响应缓冲区
+static void wait_lease(event_lane_t lane, const char *url)
+{
+    while (xSemaphoreTake(s_leases[lane], pdMS_TO_TICKS(HTTP_ASYNC_LEASE_WARN_MS)) != pdTRUE) {
+        ESP_LOGW(TAG, "响应缓冲区尚未归还: %s", url);
+    }
+}
+
+// 把结果交给LVGL任务，返回 true 表示响应缓冲区已借出，须等待回调返回
+static bool post_done(const http_async_job_t *job, http_async_result_t *result)
+{
+    if (job->done == NULL) {
+        return false;
+    }
+
+    http_async_done_event_t *ev = event_system_alloc(sizeof(http_async_done_event_t));
+    if (ev == NULL) {
+        ESP_LOGE(TAG, "分配完成事件失败，丢弃结果: %s", job->http.url);
+        return false;
+    }
+    ev->done = job->done;
+    ev->ctx = job->ctx;
+    ev->err = result->err;
+    ev->response = result->response;
+    ev->elapsed_us = result->elapsed_us;
+    ev->lease = s_leases[job->lane];
+
+    if (event_system_post_owned_lane(EVENT_TYPE_HTTP_COMPLETE, ev, sizeof(http_async_done_event_t), job->lane) != ESP_OK) {
+        ESP_LOGE(TAG, "发送完成事件失败: %s", job->http.url);
+        return false;
+    }
+    return true;
+}
+
+static void worker_task(void *arg)
+{
+    event_lane_t lane = (event_lane_t)(intptr_t)arg;
+    http_async_job_t *job;
+    while (1) {
+        if (xQueueReceive(s_queues[lane], &job, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+
+        http_async_result_t result;
+        job_run(job, &s_arenas[lane], &result);
+        ESP_LOGD(TAG, "请求完成: %s, %s, %lld ms", job->http.url, esp_err_to_name(result.err),
+                 (long long)(result.elapsed_us / 1000));
+
+        // 响应在本任务的缓冲区中，借出后等接收者归还再处理下一个请求
+        bool lent;
+        if (job->sync_done != NULL) {
+            lent = (result.response.data != NULL);
+            result.lease = lent ? s_leases[lane] : NULL;
+            *job->sync_result = result;
+            xSemaphoreGive(job->sync_done);
+        } else {
+            lent = post_done(job, &result);
+        }
+        if (lent) {
+            wait_lease(lane, job->http.url);
+        }
+        free(job);
+    }
+}
+
+// 完成事件，在消费UI事件队列的 LVGL 任务中执行
+static void on_http_complete(const event_t *event, void *ctx)
+{
+    const http_async_done_event_t *ev = event->data;
+    http_async_result_t result = {
+        .err = ev->err,
+        .response = ev->response,
+        .elapsed_us = ev->elapsed_us,
+    };
+    ev->done(&result, ev->ctx);
+    xSemaphoreGive(ev->lease);
+}
+
+esp_err_t http_async_init(void)
+{
+    for (int lane = 0; lane < EVENT_LANE_MAX; lane++) {
+        if (s_queues[lane] != NULL) {
+            continue;
+        }
+        s_leases[lane] = xSemaphoreCreateBinary();
+        s_queues[lane] = xQueueCreate(HTTP_ASYNC_QUEUE_LEN, sizeof(http_async_job_t *));
+        if (s_queues[lane] == NULL || s_leases[lane] == NULL) {
+            ESP_LOGE(TAG, "创建请求队列失败");
+            return ESP_ERR_NO_MEM;
+        }
+        if (xTaskCreate(worker_task, s_workers[lane].name, HTTP_ASYNC_STACK_SIZE, (void *)(intptr_t)lane,
+                        s_workers[lane].priority, NULL) != pdPASS) {
+            ESP_LOGE(TAG, "创建工作任务失败");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    event_subscriber_t subscriber = {
+        .delivery = EVENT_DELIVERY_CALLBACK,
+        .callback = on_http_complete,
+    };
+    return event_system_subscribe(EVENT_TYPE_HTTP_COMPLETE, &subscriber, NULL);
+}
+
+static esp_err_t enqueue(http_async_job_t *job)
+{
+    if (s_queues[job->lane] == NULL || xQueueSend(s_queues[job->lane], &job, 0) != pdTRUE) {
+        ESP_LOGW(TAG, "请求队列已满，丢弃请求: %s", job->http.url);
+        free(job);
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t http_async_submit(const http_async_request_t *req, http_async_done_t done, void *ctx)
+{
+    if (req == NULL || req->http.url == NULL || req->on_data != NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    http_async_job_t *job = job_create(req);
+    if (job == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    job->done = done;
+    job->ctx = ctx;
+    return enqueue(job);
+}
+
+esp_err_t http_async_perform(const http_async_request_t *req, http_async_result_t *result)
+{
+    if (req == NULL || req->http.url == NULL || result == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(result, 0, sizeof(*result));
+
+    StaticSemaphore_t sem_buf;
+    SemaphoreHandle_t sem = xSemaphoreCreateBinaryStatic(&sem_buf);
+    http_async_job_t *job = job_create(req);
+    if (job == NULL) {
+        result->err = ESP_ERR_NO_MEM;
+        return result->err;
+    }
+    job->sync_result = result;
+    job->sync_done = sem;
+    if (enqueue(job) != ESP_OK) {
+        result->err = ESP_ERR_NO_MEM;
+        return result->err;
+    }
+
+    // 流式接收的上下文在调用者栈上，必须等到工作任务完成，由截止时间限制等待时长
+    bool watched = (esp_task_wdt_status(NULL) == ESP_OK);
+    while (xSemaphoreTake(sem, pdMS_TO_TICKS(HTTP_ASYNC_WAIT_SLICE_MS)) != pdTRUE) {
+        if (watched) {
+            esp_task_wdt_reset();
+        }
+    }
+    vSemaphoreDelete(sem);
+    return result->err;
+}
+
+void http_async_release(http_async_result_t *result)
+{
+    if (result != NULL && result->lease != NULL) {
+        SemaphoreHandle_t lease = result->lease;
+        result->lease = NULL;
+        result->response.data = NULL;
+        result->response.len = 0;
+        xSemaphoreGive(lease);
+    }
+}
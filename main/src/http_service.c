@@ -1,52 +1,340 @@
 #include <string.h>
+#include <strings.h>
 #include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
 #include "esp_http_client.h"
 #include "http_service.h"
+#include "net_reachability.h"
 #include "lwip/ip4_addr.h"
-#include "lwip/netdb.h"
 
 static const char *TAG = "http_service";
 
-// 外部WiFi状态检查函数
-extern bool is_wifi_connected(void);
+// 连接池大小：HA、XML/封面服务器、天气API各一条，再留一条给并发请求
+#define HTTP_POOL_SIZE 4
 
-// 网络可达性检查函数
-static bool is_network_reachable(void) {
-    struct addrinfo hints, *res;
-    int err;
-    
-    memset(&hints, 0, sizeof(hints));
-    hints.ai_family = AF_INET;
-    hints.ai_socktype = SOCK_STREAM;
-    
-    // 尝试解析Google DNS服务器，检查网络可达性
-    err = getaddrinfo("8.8.8.8", "53", &hints, &res);
-    if (err != 0) {
-        ESP_LOGD(TAG, "网络不可达: 错误码 %d", err);
+// 空闲连接的最长保留时间，超过后服务器多半已关闭连接，直接重建
+#define HTTP_POOL_IDLE_MS 30000
+
+// 连接池按 "scheme://host:port" 区分主机
+#define HTTP_POOL_HOST_MAX 64
+
+// 连接池槽位
+typedef struct {
+    esp_http_client_handle_t client;    // 复用的客户端，NULL 表示空槽位
+    char host[HTTP_POOL_HOST_MAX];      // 所属主机
+    bool busy;                          // 是否正被某个请求使用
+    bool reusable;                      // 上次响应已完整读取且服务器未要求关闭
+    bool server_close;                  // 本次响应头含 Connection: close
+    int64_t last_used_us;               // 上次使用结束的时刻
+    char etag[HTTP_ETAG_MAX];           // 本次响应头中的 ETag
+    char last_modified[HTTP_LAST_MODIFIED_MAX]; // 本次响应头中的 Last-Modified
+} http_pool_slot_t;
+
+static http_pool_slot_t s_pool[HTTP_POOL_SIZE];
+static http_pool_stats_t s_pool_stats;
+static bool s_pool_enabled = true;
+
+// 保护连接池槽位分配和统计的自旋锁，建立连接和收发数据不在锁内
+static portMUX_TYPE s_pool_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// 流式接收时每次读取的字节数，缓冲区在调用者的栈上
+#define HTTP_STREAM_CHUNK 256
+
+// 流式请求成功时 perform_request 返回的占位指针
+static const char s_stream_ok[] = "";
+
+// 条件请求返回 304 时 perform_request 返回的占位指针
+static const char s_not_modified[] = "";
+
+// 记录响应长度的端点数量（按 URL 去掉查询参数区分），满时轮流替换
+#define HTTP_SIZE_HINTS 8
+
+// 没有长度记录且响应未给出 Content-Length 时的初始容量
+#define HTTP_ARENA_MIN 4096
+
+// 扩容或按长度记录预留时多留的字节数：响应略有增长时不必再次扩容
+#define HTTP_ARENA_SLACK 512
+
+// 端点出现过的最大响应长度，长度未知（chunked）时据此一次预留缓冲区
+typedef struct {
+    uint32_t key;               // URL 路径部分的哈希，0 表示空
+    uint32_t max_len;
+} http_size_hint_t;
+
+static http_size_hint_t s_size_hints[HTTP_SIZE_HINTS];
+static int s_size_hint_next = 0;
+static http_buffer_stats_t s_buffer_stats;
+
+// 从URL中取出 "scheme://host:port" 作为连接池的主机键
+static bool url_host_key(const char *url, char *key, size_t size)
+{
+    const char *authority = strstr(url, "://");
+    if (authority == NULL) {
         return false;
     }
-    
-    freeaddrinfo(res);
+    authority += 3;
+    size_t len = strcspn(authority, "/?#") + (authority - url);
+    if (len >= size) {
+        return false;
+    }
+    memcpy(key, url, len);
+    key[len] = '\0';
     return true;
 }
 
-// 内部HTTP请求函数
-static char* http_send_request_internal(const http_config_t *config) {
+// URL 的 FNV-1a 哈希，遇到 stop 中的字符时结束，不为0
+static uint32_t url_hash(const char *url, const char *stop)
+{
+    uint32_t hash = 2166136261u;
+    for (const char *p = url; *p != '\0' && strchr(stop, *p) == NULL; p++) {
+        hash = (hash ^ (uint8_t)*p) * 16777619u;
+    }
+    return (hash != 0) ? hash : 1;
+}
+
+// 端点键：URL 去掉查询参数，同一接口不同参数的响应长度相近
+static uint32_t size_hint_key(const char *url)
+{
+    return url_hash(url, "?#");
+}
+
+// 校验值的键：完整 URL，查询参数不同的是不同的资源
+static uint32_t validator_key(const char *url)
+{
+    return url_hash(url, "#");
+}
+
+static size_t size_hint_get(const char *url)
+{
+    uint32_t key = size_hint_key(url);
+    size_t max_len = 0;
+    portENTER_CRITICAL(&s_pool_lock);
+    for (int i = 0; i < HTTP_SIZE_HINTS; i++) {
+        if (s_size_hints[i].key == key) {
+            max_len = s_size_hints[i].max_len;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&s_pool_lock);
+    return max_len;
+}
+
+static void size_hint_update(const char *url, size_t len)
+{
+    uint32_t key = size_hint_key(url);
+    portENTER_CRITICAL(&s_pool_lock);
+    int i = 0;
+    while (i < HTTP_SIZE_HINTS && s_size_hints[i].key != key) {
+        i++;
+    }
+    if (i == HTTP_SIZE_HINTS) {
+        i = s_size_hint_next;
+        s_size_hint_next = (s_size_hint_next + 1) % HTTP_SIZE_HINTS;
+        s_size_hints[i].key = key;
+        s_size_hints[i].max_len = 0;
+    }
+    if (len > s_size_hints[i].max_len) {
+        s_size_hints[i].max_len = len;
+    }
+    portEXIT_CRITICAL(&s_pool_lock);
+}
+
+// 保证缓冲区至少有 size 字节，优先使用PSRAM，已有内容在扩容后保留
+static bool arena_reserve(http_arena_t *arena, size_t size)
+{
+    if (arena->cap >= size) {
+        return true;
+    }
+    size += HTTP_ARENA_SLACK;
+    char *buf = heap_caps_realloc(arena->buf, size, MALLOC_CAP_SPIRAM);
+    if (buf == NULL) {
+        buf = heap_caps_realloc(arena->buf, size, MALLOC_CAP_8BIT);
+    }
+    if (buf == NULL) {
+        ESP_LOGE(TAG, "响应缓冲区扩容失败: %u 字节", (unsigned int)size);
+        return false;
+    }
+    arena->buf = buf;
+    arena->cap = size;
+
+    portENTER_CRITICAL(&s_pool_lock);
+    s_buffer_stats.allocs++;
+    if (size > s_buffer_stats.peak_cap) {
+        s_buffer_stats.peak_cap = size;
+    }
+    portEXIT_CRITICAL(&s_pool_lock);
+    return true;
+}
+
+// 复制响应头的值，放不下时记为空（截断的校验值不能用于条件请求）
+static void copy_header_value(char *dst, size_t size, const char *value)
+{
+    size_t len = strlen(value);
+    if (len < size) {
+        memcpy(dst, value, len + 1);
+    } else {
+        dst[0] = '\0';
+    }
+}
+
+// 记录服务器是否要求关闭连接，以及响应的校验值
+static esp_err_t http_event_handler(esp_http_client_event_t *evt)
+{
+    http_pool_slot_t *slot = evt->user_data;
+    if (slot == NULL || evt->event_id != HTTP_EVENT_ON_HEADER) {
+        return ESP_OK;
+    }
+    if (strcasecmp(evt->header_key, "Connection") == 0 && strcasecmp(evt->header_value, "close") == 0) {
+        slot->server_close = true;
+    } else if (strcasecmp(evt->header_key, "ETag") == 0) {
+        copy_header_value(slot->etag, sizeof(slot->etag), evt->header_value);
+    } else if (strcasecmp(evt->header_key, "Last-Modified") == 0) {
+        copy_header_value(slot->last_modified, sizeof(slot->last_modified), evt->header_value);
+    }
+    return ESP_OK;
+}
+
+// 清除上次响应头的记录，每次尝试前调用
+static void reset_response_headers(http_pool_slot_t *slot)
+{
+    slot->server_close = false;
+    slot->etag[0] = '\0';
+    slot->last_modified[0] = '\0';
+}
+
+// 2xx 响应后把校验值更新为本次响应的，服务器未给出时清零
+static void validators_update(http_validators_t *validators, const char *url, const http_pool_slot_t *headers,
+                              size_t len)
+{
+    if (headers->etag[0] == '\0' && headers->last_modified[0] == '\0') {
+        memset(validators, 0, sizeof(*validators));
+        return;
+    }
+    validators->key = validator_key(url);
+    validators->len = len;
+    strcpy(validators->etag, headers->etag);
+    strcpy(validators->last_modified, headers->last_modified);
+}
+
+/**
+ * @brief 为请求分配连接池槽位
+ * @param host 主机键
+ * @param reused 输出：是否命中可复用的空闲连接
+ * @return http_pool_slot_t* 槽位，连接池已满时返回 NULL（使用一次性客户端）
+ */
+static http_pool_slot_t *pool_acquire(const char *host, bool *reused)
+{
+    http_pool_slot_t *slot = NULL;
+    int64_t now = esp_timer_get_time();
+    *reused = false;
+
+    portENTER_CRITICAL(&s_pool_lock);
+    // 1. 同一主机的空闲连接
+    for (int i = 0; i < HTTP_POOL_SIZE && slot == NULL; i++) {
+        if (s_pool[i].client != NULL && !s_pool[i].busy && strcmp(s_pool[i].host, host) == 0) {
+            slot = &s_pool[i];
+            *reused = slot->reusable && (now - slot->last_used_us) < (int64_t)HTTP_POOL_IDLE_MS * 1000;
+        }
+    }
+    // 2. 空槽位，否则 3. 最久未用的其他主机的空闲连接
+    for (int i = 0; i < HTTP_POOL_SIZE && slot == NULL; i++) {
+        if (s_pool[i].client == NULL && !s_pool[i].busy) {
+            slot = &s_pool[i];
+        }
+    }
+    for (int i = 0; i < HTTP_POOL_SIZE && slot == NULL; i++) {
+        if (!s_pool[i].busy) {
+            for (int j = i; j < HTTP_POOL_SIZE; j++) {
+                if (!s_pool[j].busy && s_pool[j].last_used_us < s_pool[i].last_used_us) {
+                    i = j;
+                }
+            }
+            slot = &s_pool[i];
+        }
+    }
+    if (slot != NULL) {
+        slot->busy = true;
+    }
+    if (*reused) {
+        s_pool_stats.hits++;
+    } else {
+        s_pool_stats.misses++;
+    }
+    portEXIT_CRITICAL(&s_pool_lock);
+    return slot;
+}
+
+static void pool_release(http_pool_slot_t *slot, bool reusable)
+{
+    portENTER_CRITICAL(&s_pool_lock);
+    slot->reusable = reusable;
+    slot->last_used_us = esp_timer_get_time();
+    slot->busy = false;
+    portEXIT_CRITICAL(&s_pool_lock);
+}
+
+// 本次尝试的超时：默认3秒，有截止时刻时不超过剩余时间
+static int request_timeout_ms(const http_config_t *config)
+{
+    int timeout_ms = config->timeout_ms > 0 ? config->timeout_ms : 3000; // 减少默认超时时间从5秒到3秒
+    if (config->deadline_us > 0) {
+        int64_t remaining_ms = (config->deadline_us - esp_timer_get_time()) / 1000;
+        if (remaining_ms < timeout_ms) {
+            timeout_ms = (remaining_ms > 0) ? (int)remaining_ms : 1;
+        }
+    }
+    return timeout_ms;
+}
+
+static bool deadline_passed(const http_config_t *config)
+{
+    return config->deadline_us > 0 && esp_timer_get_time() >= config->deadline_us;
+}
+
+static esp_http_client_handle_t create_client(const http_config_t *config, http_pool_slot_t *slot)
+{
     esp_http_client_config_t client_config = {
         .url = config->url,
         .method = config->method,
-        .timeout_ms = config->timeout_ms > 0 ? config->timeout_ms : 3000, // 减少默认超时时间从5秒到3秒
+        .timeout_ms = request_timeout_ms(config),
+        .buffer_size_tx = 1024,             // 封面转换地址带编码后的文件路径，请求行较长
+        .event_handler = http_event_handler,
+        .user_data = slot,
 #if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
         .crt_bundle_attach = NULL, // 明确禁用证书包，防止 HTTPS 干扰
 #endif
     };
+    return esp_http_client_init(&client_config);
+}
 
-    esp_http_client_handle_t client = esp_http_client_init(&client_config);
-    if (client == NULL) {
-        ESP_LOGE(TAG, "Failed to initialize HTTP client");
-        return NULL;
-    }
+/**
+ * @brief 在已有客户端上执行一次请求
+ * @param client 客户端（可能保持着上次请求的连接）
+ * @param config 请求配置
+ * @param on_data 流式接收回调，NULL 表示把响应读入 arena
+ * @param ctx 回调上下文
+ * @param arena 非流式接收时的响应缓冲区
+ * @param out_len 输出：响应长度
+ * @param streamed 输出：是否已有响应内容交给回调（此后失败不能重试）
+ * @param transport_error 输出：是否在收到响应头之前失败（复用的连接可能已被服务器关闭）
+ * @param complete 输出：响应是否已完整读取（连接可以继续复用）
+ * @return char* 响应内容（即 arena->buf），失败返回 NULL；流式接收成功或 304 时返回非 NULL 的占位指针
+ */
+static char *perform_request(esp_http_client_handle_t client, const http_config_t *config,
+                             http_stream_cb_t on_data, void *ctx, http_arena_t *arena, size_t *out_len,
+                             bool *streamed, bool *transport_error, bool *complete)
+{
+    *streamed = false;
+    *transport_error = false;
+    *complete = false;
+
+    esp_http_client_set_url(client, config->url);
+    esp_http_client_set_method(client, config->method);
+    esp_http_client_set_timeout_ms(client, request_timeout_ms(config));
 
     // 设置请求头
     if (config->headers != NULL) {
@@ -55,94 +343,251 @@ static char* http_send_request_internal(const http_config_t *config) {
         }
     }
 
-    // 设置 POST 数据
+    // 条件请求：调用者仍持有同一 URL 上次响应的内容
+    const http_validators_t *validators = NULL;
+    if (config->validators != NULL && config->validators->key != 0 &&
+        config->validators->key == validator_key(config->url)) {
+        validators = config->validators;
+        if (validators->etag[0] != '\0') {
+            esp_http_client_set_header(client, "If-None-Match", validators->etag);
+        }
+        if (validators->last_modified[0] != '\0') {
+            esp_http_client_set_header(client, "If-Modified-Since", validators->last_modified);
+        }
+    }
+
+    // 设置 POST 数据，复用的客户端须清除上次请求的数据
+    int post_len = 0;
     if (config->method == HTTP_METHOD_POST && config->post_data != NULL) {
-        esp_http_client_set_post_field(client, config->post_data, strlen(config->post_data));
+        post_len = strlen(config->post_data);
+        esp_http_client_set_post_field(client, config->post_data, post_len);
+    } else {
+        esp_http_client_set_post_field(client, NULL, 0);
     }
 
     char *response_buf = NULL;
     int total_read_len = 0;
-    
-    // 打开连接
-    esp_err_t err = esp_http_client_open(client, config->method == HTTP_METHOD_POST ? strlen(config->post_data) : 0);
+
+    // 打开连接，已连接时直接复用
+    esp_err_t err = esp_http_client_open(client, post_len);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Failed to open connection: %s", esp_err_to_name(err));
-        esp_http_client_cleanup(client);
-        return NULL;
+        *transport_error = true;
+        goto cleanup;
     }
 
     // 如果是 POST 且有数据，写入数据
-    if (config->method == HTTP_METHOD_POST && config->post_data != NULL) {
-        int wlen = esp_http_client_write(client, config->post_data, strlen(config->post_data));
+    if (post_len > 0) {
+        int wlen = esp_http_client_write(client, config->post_data, post_len);
         if (wlen < 0) {
             ESP_LOGE(TAG, "Failed to write post data");
-            esp_http_client_cleanup(client);
-            return NULL;
+            *transport_error = true;
+            goto cleanup;
         }
     }
 
     int content_length = esp_http_client_fetch_headers(client);
     int status_code = esp_http_client_get_status_code(client);
+    if (content_length < 0 && status_code == 0) {
+        *transport_error = true;
+        goto cleanup;
+    }
     ESP_LOGI(TAG, "HTTP Status = %d, content_length = %d", status_code, content_length);
 
-    if (status_code >= 200 && status_code < 300) {
-        // 动态分配缓冲区
-        int alloc_size = (content_length > 0) ? (content_length + 1) : 4096; 
-        response_buf = malloc(alloc_size);
-        if (response_buf) {
-            memset(response_buf, 0, alloc_size);
-            while (1) {
-                // 确保我们至少还有一点空间来读取和存放 null 终止符
-                if (total_read_len >= alloc_size - 1) {
-                    alloc_size += 4096;
-                    char *new_buf = realloc(response_buf, alloc_size);
-                    if (new_buf == NULL) {
-                        ESP_LOGE(TAG, "Failed to realloc buffer");
-                        break;
-                    }
-                    response_buf = new_buf;
-                }
-
-                int read_len = esp_http_client_read(client, response_buf + total_read_len, alloc_size - 1 - total_read_len);
-                if (read_len < 0) {
-                    ESP_LOGE(TAG, "Error reading from HTTP stream");
-                    break;
-                }
-                if (read_len == 0) break;
-                
-                total_read_len += read_len;
+    if (status_code >= 200 && status_code < 300 && on_data != NULL) {
+        // 流式接收：每块读到栈上的小缓冲区后立即交给回调，不保留完整响应
+        char chunk[HTTP_STREAM_CHUNK];
+        bool ok = true;
+        while (ok) {
+            int read_len = esp_http_client_read(client, chunk, sizeof(chunk));
+            if (read_len < 0) {
+                ESP_LOGE(TAG, "Error reading from HTTP stream");
+                ok = false;
+                break;
             }
-            response_buf[total_read_len] = '\0';
-            ESP_LOGI(TAG, "Read successful, total length: %d", total_read_len);
-        } else {
-            ESP_LOGE(TAG, "Failed to allocate memory for response");
+            if (read_len == 0) break;
+            *streamed = true;
+            total_read_len += read_len;
+            ok = on_data(ctx, chunk, read_len);
+        }
+        if (ok && content_length > 0 && total_read_len < content_length) {
+            ESP_LOGE(TAG, "Response truncated: %d/%d", total_read_len, content_length);
+            ok = false;
+        }
+        ESP_LOGI(TAG, "Stream %s, total length: %d", ok ? "successful" : "aborted", total_read_len);
+        if (ok) {
+            *out_len = total_read_len;
+            response_buf = (char *)s_stream_ok;
+        }
+    } else if (status_code >= 200 && status_code < 300) {
+        // 读入复用的缓冲区：长度已知时按长度预留，未知时按该端点出现过的最大长度预留，
+        // 稳定后不再分配内存；只写入实际收到的字节，不清零
+        size_t hint = (content_length > 0) ? 0 : size_hint_get(config->url);
+        size_t expected = HTTP_ARENA_MIN;
+        if (content_length > 0) {
+            expected = content_length;
+        } else if (hint > 0) {
+            expected = hint + HTTP_ARENA_SLACK;
         }
+        size_t used = 0;
+        bool ok = arena_reserve(arena, expected + 1);
+        while (ok) {
+            if (content_length > 0 && used >= (size_t)content_length) break;
+            // 至少留出 '\0' 的位置，不够时容量翻倍
+            if (used + 1 >= arena->cap && !arena_reserve(arena, arena->cap * 2)) {
+                ok = false;
+                break;
+            }
+            int read_len = esp_http_client_read(client, arena->buf + used, arena->cap - 1 - used);
+            if (read_len < 0) {
+                ESP_LOGE(TAG, "Error reading from HTTP stream");
+                ok = false;
+                break;
+            }
+            if (read_len == 0) break;
+            used += read_len;
+        }
+        if (ok && content_length > 0 && used < (size_t)content_length) {
+            // 连接提前断开：截断的内容不能当作成功，也不能记录长度和校验值
+            ESP_LOGE(TAG, "Response truncated: %u/%d", (unsigned int)used, content_length);
+            ok = false;
+        }
+        if (ok) {
+            arena->buf[used] = '\0';
+            *out_len = used;
+            response_buf = arena->buf;
+            size_hint_update(config->url, used);
+            portENTER_CRITICAL(&s_pool_lock);
+            s_buffer_stats.responses++;
+            portEXIT_CRITICAL(&s_pool_lock);
+            ESP_LOGI(TAG, "Read successful, total length: %u", (unsigned int)used);
+        }
+    } else if (status_code == 304 && validators != NULL) {
+        // 内容未变化：304 没有响应内容，调用者继续使用已有的
+        esp_http_client_flush_response(client, NULL);
+        response_buf = (char *)s_not_modified;
+        portENTER_CRITICAL(&s_pool_lock);
+        s_buffer_stats.not_modified++;
+        s_buffer_stats.saved_bytes += validators->len;
+        portEXIT_CRITICAL(&s_pool_lock);
+        ESP_LOGI(TAG, "Not modified, skipped %u bytes", (unsigned int)validators->len);
     } else {
         ESP_LOGE(TAG, "HTTP request failed with status: %d", status_code);
+        // 读掉错误响应的内容，连接仍可复用
+        esp_http_client_flush_response(client, NULL);
     }
+    *complete = esp_http_client_is_complete_data_received(client);
 
-    esp_http_client_cleanup(client);
+cleanup:
+    // 请求头保存在客户端中，删除后再给下一个请求复用
+    if (config->headers != NULL) {
+        for (int i = 0; config->headers[i] != NULL && config->headers[i+1] != NULL; i += 2) {
+            esp_http_client_delete_header(client, config->headers[i]);
+        }
+    }
+    if (validators != NULL) {
+        esp_http_client_delete_header(client, "If-None-Match");
+        esp_http_client_delete_header(client, "If-Modified-Since");
+    }
     return response_buf;
 }
 
-// HTTP请求重试函数
-char* http_send_request_with_retry(const http_config_t *config, int max_retries) {
+// 内部HTTP请求函数：同一主机的请求复用连接池中的长连接
+static char* http_send_request_internal(const http_config_t *config, http_stream_cb_t on_data, void *ctx,
+                                        http_arena_t *arena, size_t *out_len, bool *streamed) {
+    char host[HTTP_POOL_HOST_MAX];
+    http_pool_slot_t *slot = NULL;
+    http_pool_slot_t oneshot = {0};     // 一次性客户端的响应头记录
+    bool reused = false;
+    if (s_pool_enabled && url_host_key(config->url, host, sizeof(host))) {
+        slot = pool_acquire(host, &reused);
+    }
+
+    esp_http_client_handle_t client;
+    if (slot == NULL) {
+        // 未启用连接池或连接池已满：一次性客户端
+        client = create_client(config, &oneshot);
+    } else if (slot->client != NULL && strcmp(slot->host, host) == 0) {
+        client = slot->client;
+        if (!reused) {
+            // 连接空闲过久或上次未完整读取，重新建立
+            esp_http_client_close(client);
+        }
+    } else {
+        // 空槽位或换给其他主机
+        if (slot->client != NULL) {
+            esp_http_client_cleanup(slot->client);
+        }
+        strcpy(slot->host, host);
+        slot->client = create_client(config, slot);
+        client = slot->client;
+    }
+    if (client == NULL) {
+        ESP_LOGE(TAG, "Failed to initialize HTTP client");
+        if (slot != NULL) {
+            pool_release(slot, false);
+        }
+        return NULL;
+    }
+
+    http_pool_slot_t *headers = (slot != NULL) ? slot : &oneshot;
+    reset_response_headers(headers);
+
+    bool transport_error;
+    bool complete;
+    char *response = perform_request(client, config, on_data, ctx, arena, out_len, streamed,
+                                     &transport_error, &complete);
+    if (transport_error && reused) {
+        // 复用的连接已被服务器关闭，重新连接后再试一次
+        ESP_LOGD(TAG, "复用的连接已失效，重新连接: %s", host);
+        portENTER_CRITICAL(&s_pool_lock);
+        s_pool_stats.stale++;
+        portEXIT_CRITICAL(&s_pool_lock);
+        esp_http_client_close(client);
+        reset_response_headers(headers);
+        response = perform_request(client, config, on_data, ctx, arena, out_len, streamed,
+                                   &transport_error, &complete);
+    }
+    if (response != NULL && response != s_not_modified && config->validators != NULL) {
+        validators_update(config->validators, config->url, headers, *out_len);
+    }
+    // 服务器有响应即说明网络可达，连接失败或超时计入连续失败
+    net_reachability_report(!transport_error);
+
+    if (slot == NULL) {
+        esp_http_client_cleanup(client);
+        return response;
+    }
+    bool reusable = complete && !transport_error && !slot->server_close;
+    if (!reusable) {
+        esp_http_client_close(client);
+    }
+    pool_release(slot, reusable);
+    return response;
+}
+
+// 带重试地把响应读入 arena，失败返回 NULL
+static char *send_with_retry(const http_config_t *config, int max_retries, http_arena_t *arena, size_t *out_len) {
     char *response = NULL;
     int retries = 0;
     
     while (retries < max_retries) {
-        // 检查网络可达性
-        if (!is_network_reachable()) {
+        // 检查缓存的网络状态（由WiFi事件和请求结果维护，不再逐次探测）
+        if (!net_reachability_allow_request()) {
             ESP_LOGW(TAG, "网络不可达,跳过HTTP请求重试: %s", config->url);
             break;
         }
         
-        response = http_send_request_internal(config);
+        bool streamed;
+        response = http_send_request_internal(config, NULL, NULL, arena, out_len, &streamed);
         if (response != NULL) {
             break;
         }
         
         retries++;
+        if (retries >= max_retries || deadline_passed(config)) {
+            break;
+        }
         ESP_LOGW(TAG, "HTTP请求失败，重试 %d/%d", retries, max_retries);
         vTaskDelay(pdMS_TO_TICKS(500 * retries)); // 指数退避延迟
     }
@@ -150,24 +595,135 @@ char* http_send_request_with_retry(const http_config_t *config, int max_retries)
     return response;
 }
 
+// HTTP请求重试函数：一次性缓冲区，成功后整块交给调用者
+char* http_send_request_with_retry(const http_config_t *config, int max_retries) {
+    http_arena_t arena = {0};
+    size_t len;
+    char *response = send_with_retry(config, max_retries, &arena, &len);
+    if (response == NULL || response == s_not_modified) {
+        // 只返回调用者可以释放的缓冲区，条件请求应使用 http_send_request_arena
+        http_arena_free(&arena);
+        return NULL;
+    }
+    return response;
+}
+
 char* http_send_request(const http_config_t *config) {
     if (config == NULL || config->url == NULL) {
         ESP_LOGE(TAG, "Invalid arguments");
         return NULL;
     }
 
-    // 检查WiFi连接状态
-    if (!is_wifi_connected()) {
-        ESP_LOGW(TAG, "WiFi未连接,跳过HTTP请求: %s", config->url);
+    // 检查缓存的网络状态：WiFi未连接或离线退避期间跳过
+    if (!net_reachability_allow_request()) {
+        ESP_LOGW(TAG, "网络不可达,跳过HTTP请求: %s (%s)", config->url,
+                 net_reachability_state_name(net_reachability_get_state()));
         return NULL;
     }
-    
-    // 检查网络可达性
-    if (!is_network_reachable()) {
-        ESP_LOGW(TAG, "网络不可达,跳过HTTP请求: %s", config->url);
+
+    // 直接调用内部函数，不使用重试机制
+    http_arena_t arena = {0};
+    size_t len;
+    bool streamed;
+    char *response = http_send_request_internal(config, NULL, NULL, &arena, &len, &streamed);
+    if (response == NULL || response == s_not_modified) {
+        http_arena_free(&arena);
         return NULL;
     }
+    return response;
+}
 
-    // 直接调用内部函数，不使用重试机制
-    return http_send_request_internal(config);
+esp_err_t http_send_request_arena(const http_config_t *config, int max_retries, http_arena_t *arena,
+                                  http_view_t *view)
+{
+    if (config == NULL || config->url == NULL || arena == NULL || view == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    view->data = NULL;
+    view->len = 0;
+    if (!net_reachability_allow_request()) {
+        ESP_LOGW(TAG, "网络不可达,跳过HTTP请求: %s", config->url);
+        return ESP_ERR_INVALID_STATE;
+    }
+    size_t len = 0;
+    char *response = send_with_retry(config, max_retries, arena, &len);
+    if (response == NULL) {
+        return ESP_FAIL;
+    }
+    if (response == s_not_modified) {
+        return ESP_ERR_HTTP_NOT_MODIFIED;
+    }
+    view->data = response;
+    view->len = len;
+    return ESP_OK;
+}
+
+void http_arena_free(http_arena_t *arena)
+{
+    if (arena != NULL) {
+        heap_caps_free(arena->buf);
+        arena->buf = NULL;
+        arena->cap = 0;
+    }
+}
+
+esp_err_t http_send_request_stream(const http_config_t *config, int max_retries, http_stream_cb_t on_data, void *ctx)
+{
+    if (config == NULL || config->url == NULL || on_data == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    for (int retries = 0; retries < max_retries; retries++) {
+        if (!net_reachability_allow_request()) {
+            ESP_LOGW(TAG, "网络不可达,跳过HTTP请求: %s", config->url);
+            return ESP_ERR_INVALID_STATE;
+        }
+        if (retries > 0) {
+            if (deadline_passed(config)) {
+                return ESP_ERR_TIMEOUT;
+            }
+            ESP_LOGW(TAG, "HTTP请求失败，重试 %d/%d", retries, max_retries);
+            vTaskDelay(pdMS_TO_TICKS(500 * retries));
+        }
+
+        bool streamed = false;
+        size_t len = 0;
+        char *response = http_send_request_internal(config, on_data, ctx, NULL, &len, &streamed);
+        if (response == s_not_modified) {
+            return ESP_ERR_HTTP_NOT_MODIFIED;
+        }
+        if (response != NULL) {
+            return ESP_OK;
+        }
+        if (streamed) {
+            // 回调已收到部分内容，重试会让解析器看到重复的数据
+            return ESP_FAIL;
+        }
+    }
+    return ESP_FAIL;
+}
+
+void http_service_set_pool_enabled(bool enabled)
+{
+    s_pool_enabled = enabled;
+}
+
+void http_service_get_pool_stats(http_pool_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    portENTER_CRITICAL(&s_pool_lock);
+    *stats = s_pool_stats;
+    portEXIT_CRITICAL(&s_pool_lock);
+}
+
+void http_service_get_buffer_stats(http_buffer_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    portENTER_CRITICAL(&s_pool_lock);
+    *stats = s_buffer_stats;
+    portEXIT_CRITICAL(&s_pool_lock);
 }
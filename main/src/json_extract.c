@@ -0,0 +1,411 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "json_extract.h"
+
+// 数字转换时的最大字符数
+#define JSON_NUMBER_MAX_LEN 32
+
+// 扫描结果：出错、继续、所有字段已找到
+#define SCAN_ERROR  -1
+#define SCAN_OK     0
+#define SCAN_DONE   1
+
+// 字段路径与当前位置的关系
+typedef enum {
+    PATH_NONE,                  // 不在当前位置及其子节点中
+    PATH_EXACT,                 // 就是当前位置
+    PATH_PREFIX,                // 在当前位置的子节点中
+} path_relation_t;
+
+typedef struct {
+    const char *p;              // 当前位置
+    const char *end;            // 文本结尾
+    json_field_t *fields;
+    size_t count;
+    size_t found;
+    int depth;                  // 当前键路径的层数
+    const char *keys[JSON_EXTRACT_MAX_DEPTH];
+    size_t key_lens[JSON_EXTRACT_MAX_DEPTH];
+} json_scanner_t;
+
+static void skip_ws(json_scanner_t *s)
+{
+    while (s->p < s->end && (*s->p == ' ' || *s->p == '\t' || *s->p == '\n' || *s->p == '\r')) {
+        s->p++;
+    }
+}
+
+// 扫描字符串，输出不含引号的内容
+static int scan_string(json_scanner_t *s, const char **str, size_t *len)
+{
+    if (s->p >= s->end || *s->p != '"') {
+        return SCAN_ERROR;
+    }
+    const char *start = ++s->p;
+    while (s->p < s->end) {
+        char c = *s->p;
+        if (c == '\\') {
+            s->p += 2;
+        } else if (c == '"') {
+            *str = start;
+            *len = s->p - start;
+            s->p++;
+            return SCAN_OK;
+        } else {
+            s->p++;
+        }
+    }
+    return SCAN_ERROR;
+}
+
+// 跳过任意值，对象和数组只做括号配对
+static int skip_value(json_scanner_t *s)
+{
+    if (s->p >= s->end) {
+        return SCAN_ERROR;
+    }
+
+    const char *str;
+    size_t len;
+    char c = *s->p;
+    if (c == '"') {
+        return scan_string(s, &str, &len);
+    }
+
+    if (c == '{' || c == '[') {
+        int nesting = 0;
+        while (s->p < s->end) {
+            c = *s->p;
+            if (c == '"') {
+                if (scan_string(s, &str, &len) != SCAN_OK) {
+                    return SCAN_ERROR;
+                }
+                continue;
+            }
+            if (c == '{' || c == '[') {
+                nesting++;
+            } else if (c == '}' || c == ']') {
+                if (--nesting == 0) {
+                    s->p++;
+                    return SCAN_OK;
+                }
+            }
+            s->p++;
+        }
+        return SCAN_ERROR;
+    }
+
+    // 数字、true、false、null
+    const char *start = s->p;
+    while (s->p < s->end && *s->p != ',' && *s->p != '}' && *s->p != ']' &&
+           *s->p != ' ' && *s->p != '\t' && *s->p != '\n' && *s->p != '\r') {
+        s->p++;
+    }
+    return (s->p > start) ? SCAN_OK : SCAN_ERROR;
+}
+
+static path_relation_t path_relation(const json_scanner_t *s, const char *path)
+{
+    for (int i = 0; i < s->depth; i++) {
+        const char *seg_end = path;
+        while (*seg_end != '\0' && *seg_end != '.') {
+            seg_end++;
+        }
+        size_t seg_len = seg_end - path;
+        if (seg_len != s->key_lens[i] || memcmp(path, s->keys[i], seg_len) != 0) {
+            return PATH_NONE;
+        }
+        if (*seg_end == '\0') {
+            return (i == s->depth - 1) ? PATH_EXACT : PATH_NONE;
+        }
+        path = seg_end + 1;
+    }
+    return PATH_PREFIX;
+}
+
+static json_field_kind_t value_kind(char c)
+{
+    switch (c) {
+        case '"': return JSON_FIELD_STRING;
+        case '{': return JSON_FIELD_OBJECT;
+        case '[': return JSON_FIELD_ARRAY;
+        case 't':
+        case 'f': return JSON_FIELD_BOOL;
+        case 'n': return JSON_FIELD_NULL;
+        default:  return JSON_FIELD_NUMBER;
+    }
+}
+
+static int scan_object(json_scanner_t *s);
+
+// 扫描当前路径上的值：有字段在其子节点中时进入对象，否则整体跳过
+static int scan_value(json_scanner_t *s)
+{
+    skip_ws(s);
+    if (s->p >= s->end) {
+        return SCAN_ERROR;
+    }
+
+    bool exact = false;
+    bool prefix = false;
+    for (size_t i = 0; i < s->count; i++) {
+        if (s->fields[i].kind != JSON_FIELD_MISSING) {
+            continue;
+        }
+        path_relation_t rel = path_relation(s, s->fields[i].path);
+        exact |= (rel == PATH_EXACT);
+        prefix |= (rel == PATH_PREFIX);
+    }
+
+    const char *start = s->p;
+    int ret;
+    if (prefix && *s->p == '{' && s->depth < JSON_EXTRACT_MAX_DEPTH) {
+        ret = scan_object(s);
+    } else {
+        ret = skip_value(s);
+    }
+    if (ret != SCAN_OK || !exact) {
+        return ret;
+    }
+
+    json_field_kind_t kind = value_kind(*start);
+    const char *value = start;
+    size_t value_len = s->p - start;
+    if (kind == JSON_FIELD_STRING) {
+        value++;
+        value_len -= 2;
+    }
+    for (size_t i = 0; i < s->count; i++) {
+        json_field_t *field = &s->fields[i];
+        if (field->kind == JSON_FIELD_MISSING && path_relation(s, field->path) == PATH_EXACT) {
+            field->kind = kind;
+            field->value = value;
+            field->value_len = value_len;
+            s->found++;
+        }
+    }
+    return (s->found == s->count) ? SCAN_DONE : SCAN_OK;
+}
+
+static int scan_object(json_scanner_t *s)
+{
+    s->p++;
+    skip_ws(s);
+    if (s->p < s->end && *s->p == '}') {
+        s->p++;
+        return SCAN_OK;
+    }
+
+    while (s->p < s->end) {
+        const char *key;
+        size_t key_len;
+        if (scan_string(s, &key, &key_len) != SCAN_OK) {
+            return SCAN_ERROR;
+        }
+        skip_ws(s);
+        if (s->p >= s->end || *s->p != ':') {
+            return SCAN_ERROR;
+        }
+        s->p++;
+
+        s->keys[s->depth] = key;
+        s->key_lens[s->depth] = key_len;
+        s->depth++;
+        int ret = scan_value(s);
+        s->depth--;
+        if (ret != SCAN_OK) {
+            return ret;
+        }
+
+        skip_ws(s);
+        if (s->p >= s->end) {
+            break;
+        }
+        if (*s->p == '}') {
+            s->p++;
+            return SCAN_OK;
+        }
+        if (*s->p != ',') {
+            break;
+        }
+        s->p++;
+        skip_ws(s);
+    }
+    return SCAN_ERROR;
+}
+
+int json_extract(const char *json, size_t len, json_field_t *fields, size_t count)
+{
+    if (json == NULL || fields == NULL) {
+        return -1;
+    }
+    for (size_t i = 0; i < count; i++) {
+        fields[i].kind = JSON_FIELD_MISSING;
+        fields[i].value = NULL;
+        fields[i].value_len = 0;
+    }
+
+    json_scanner_t s = {
+        .p = json,
+        .end = json + len,
+        .fields = fields,
+        .count = count,
+    };
+    if (count == 0) {
+        return 0;
+    }
+    if (scan_value(&s) == SCAN_ERROR) {
+        return -1;
+    }
+    return (int)s.found;
+}
+
+bool json_field_number(const json_field_t *field, double *out)
+{
+    if (field == NULL || field->kind != JSON_FIELD_NUMBER || field->value_len >= JSON_NUMBER_MAX_LEN) {
+        return false;
+    }
+
+    // 值不一定以 '\0' 结尾，先拷贝再转换
+    char buf[JSON_NUMBER_MAX_LEN];
+    memcpy(buf, field->value, field->value_len);
+    buf[field->value_len] = '\0';
+    char *end = NULL;
+    double value = strtod(buf, &end);
+    if (end != buf + field->value_len) {
+        return false;
+    }
+    *out = value;
+    return true;
+}
+
+// \u 后的4位十六进制数，不足4位或含非十六进制字符时返回 -1
+static long parse_hex4(const char *p, const char *end)
+{
+    if (end - p < 4) {
+        return -1;
+    }
+    long value = 0;
+    for (int i = 0; i < 4; i++) {
+        char c = p[i];
+        int digit;
+        if (c >= '0' && c <= '9') {
+            digit = c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            digit = c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            digit = c - 'A' + 10;
+        } else {
+            return -1;
+        }
+        value = (value << 4) | digit;
+    }
+    return value;
+}
+
+static size_t utf8_encode(long cp, char *out)
+{
+    if (cp < 0x80) {
+        out[0] = (char)cp;
+        return 1;
+    }
+    if (cp < 0x800) {
+        out[0] = (char)(0xC0 | (cp >> 6));
+        out[1] = (char)(0x80 | (cp & 0x3F));
+        return 2;
+    }
+    if (cp < 0x10000) {
+        out[0] = (char)(0xE0 | (cp >> 12));
+        out[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (cp & 0x3F));
+        return 3;
+    }
+    out[0] = (char)(0xF0 | (cp >> 18));
+    out[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (cp & 0x3F));
+    return 4;
+}
+
+// 解码 *p 处的一个转义序列到 out（最多4字节），返回字节数；序列不完整时返回 0
+static size_t decode_escape(const char **p, const char *end, char *out)
+{
+    const char *q = *p;
+    if (end - q < 2) {
+        return 0;
+    }
+    char e = q[1];
+    q += 2;
+    size_t n = 1;
+    switch (e) {
+        case 'b': out[0] = '\b'; break;
+        case 'f': out[0] = '\f'; break;
+        case 'n': out[0] = '\n'; break;
+        case 'r': out[0] = '\r'; break;
+        case 't': out[0] = '\t'; break;
+        case 'u': {
+            long cp = parse_hex4(q, end);
+            if (cp < 0) {
+                return 0;
+            }
+            q += 4;
+            // UTF-16 代理对：高位后紧跟 \uDC00-\uDFFF 的低位
+            if (cp >= 0xD800 && cp <= 0xDBFF && end - q >= 6 && q[0] == '\\' && q[1] == 'u') {
+                long low = parse_hex4(q + 2, end);
+                if (low >= 0xDC00 && low <= 0xDFFF) {
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    q += 6;
+                }
+            }
+            if (cp >= 0xD800 && cp <= 0xDFFF) {
+                cp = 0xFFFD;        // 不成对的代理项
+            }
+            n = utf8_encode(cp, out);
+            break;
+        }
+        default:
+            out[0] = e;             // \" \\ \/
+            break;
+    }
+    *p = q;
+    return n;
+}
+
+bool json_field_string(const json_field_t *field, char *buf, size_t size)
+{
+    if (field == NULL || field->kind != JSON_FIELD_STRING || buf == NULL || size == 0) {
+        return false;
+    }
+    const char *p = field->value;
+    const char *end = field->value + field->value_len;
+    size_t len = 0;
+    while (p < end && len < size - 1) {
+        const char *escape = memchr(p, '\\', end - p);
+        size_t plain = (escape ? escape : end) - p;
+        if (plain > size - 1 - len) {
+            plain = size - 1 - len;
+        }
+        memcpy(buf + len, p, plain);
+        len += plain;
+        p += plain;
+        if (p != escape) {
+            continue;
+        }
+        // 截断时不拆开转义得到的多字节字符，末尾不完整的转义序列丢弃
+        char ch[4];
+        size_t n = decode_escape(&p, end, ch);
+        if (n == 0 || n > size - 1 - len) {
+            break;
+        }
+        memcpy(buf + len, ch, n);
+        len += n;
+    }
+    buf[len] = '\0';
+    return true;
+}
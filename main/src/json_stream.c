@@ -0,0 +1,289 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <string.h>
+#include "json_stream.h"
+
+// 解析状态
+enum {
+    ST_VALUE,                   // 等待一个值
+    ST_VALUE_OR_END,            // '[' 之后：值或 ']'
+    ST_KEY_OR_END,              // '{' 之后：键或 '}'
+    ST_KEY,                     // 对象中 ',' 之后：键
+    ST_COLON,                   // 键之后：':'
+    ST_COMMA_OR_END,            // 容器中的值之后：',' 或结束括号
+    ST_STRING,                  // 字符串中
+    ST_LITERAL,                 // 数字、true、false、null 中
+    ST_DONE,                    // 顶层值已结束，只允许空白
+    ST_ERROR,
+};
+
+static bool is_ws(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+// 比较路径中的一层与当前容器，输出剩余路径
+static bool match_frame(const json_stream_frame_t *f, const char **path)
+{
+    const char *p = *path;
+    if (f->type == '{') {
+        if (*p == '.') {
+            p++;
+        }
+        size_t len = strcspn(p, ".[");
+        if (f->key_len == UINT8_MAX || len != f->key_len || memcmp(p, f->key, len) != 0) {
+            return false;
+        }
+        *path = p + len;
+        return true;
+    }
+
+    if (*p != '[') {
+        return false;
+    }
+    p++;
+    if (*p == '*') {
+        p++;
+    } else {
+        int index = 0;
+        const char *digits = p;
+        while (*p >= '0' && *p <= '9') {
+            index = index * 10 + (*p++ - '0');
+        }
+        if (p == digits || index != f->index) {
+            return false;
+        }
+    }
+    if (*p != ']') {
+        return false;
+    }
+    *path = p + 1;
+    return true;
+}
+
+// 标量值解析完成：与每个订阅的路径比较
+static void emit(json_stream_t *s, json_field_kind_t kind)
+{
+    int index = -1;
+    for (int d = s->depth - 1; d >= 0; d--) {
+        if (s->stack[d].type == '[') {
+            index = s->stack[d].index;
+            break;
+        }
+    }
+
+    s->token[s->token_len] = '\0';
+    for (size_t i = 0; i < s->sub_count; i++) {
+        const char *path = s->subs[i].path;
+        int d = 0;
+        while (d < s->depth && match_frame(&s->stack[d], &path)) {
+            d++;
+        }
+        if (d == s->depth && *path == '\0') {
+            json_field_t field = {
+                .path = s->subs[i].path,
+                .kind = kind,
+                .value = s->token,
+                .value_len = s->token_len,
+            };
+            s->subs[i].cb(s->subs[i].ctx, &field, index);
+        }
+    }
+}
+
+// 一个值（标量或容器）结束后的状态
+static void value_done(json_stream_t *s)
+{
+    s->state = (s->depth == 0) ? ST_DONE : ST_COMMA_OR_END;
+}
+
+static void push(json_stream_t *s, char type)
+{
+    if (s->depth >= JSON_STREAM_MAX_DEPTH) {
+        s->state = ST_ERROR;
+        return;
+    }
+    json_stream_frame_t *f = &s->stack[s->depth++];
+    f->type = type;
+    f->key_len = 0;
+    f->index = 0;
+    s->state = (type == '{') ? ST_KEY_OR_END : ST_VALUE_OR_END;
+}
+
+static void pop(json_stream_t *s, char close)
+{
+    if (s->stack[s->depth - 1].type != ((close == '}') ? '{' : '[')) {
+        s->state = ST_ERROR;
+        return;
+    }
+    s->depth--;
+    value_done(s);
+}
+
+static json_field_kind_t literal_kind(const json_stream_t *s)
+{
+    switch (s->token[0]) {
+        case 't': return (strcmp(s->token, "true") == 0) ? JSON_FIELD_BOOL : JSON_FIELD_MISSING;
+        case 'f': return (strcmp(s->token, "false") == 0) ? JSON_FIELD_BOOL : JSON_FIELD_MISSING;
+        case 'n': return (strcmp(s->token, "null") == 0) ? JSON_FIELD_NULL : JSON_FIELD_MISSING;
+        default:  return JSON_FIELD_NUMBER;
+    }
+}
+
+static void start_value(json_stream_t *s, char c)
+{
+    s->token_len = 0;
+    if (c == '{' || c == '[') {
+        push(s, c);
+    } else if (c == '"') {
+        s->in_key = false;
+        s->escape = false;
+        s->state = ST_STRING;
+    } else if (c == '-' || (c >= '0' && c <= '9') || c == 't' || c == 'f' || c == 'n') {
+        s->token[s->token_len++] = c;
+        s->state = ST_LITERAL;
+    } else {
+        s->state = ST_ERROR;
+    }
+}
+
+// 字符串中的一个字符，键写入当前容器，值写入 token（超长截断）
+static void string_char(json_stream_t *s, char c)
+{
+    if (s->in_key) {
+        json_stream_frame_t *f = &s->stack[s->depth - 1];
+        if (f->key_len != UINT8_MAX) {
+            if (f->key_len < JSON_STREAM_KEY_MAX) {
+                f->key[f->key_len++] = c;
+            } else {
+                f->key_len = UINT8_MAX;
+            }
+        }
+    } else if (s->token_len < JSON_STREAM_VALUE_MAX) {
+        s->token[s->token_len++] = c;
+    }
+}
+
+void json_stream_init(json_stream_t *s, const json_stream_sub_t *subs, size_t count)
+{
+    memset(s, 0, sizeof(*s));
+    s->subs = subs;
+    s->sub_count = count;
+    s->state = ST_VALUE;
+}
+
+int json_stream_feed(json_stream_t *s, const char *data, size_t len)
+{
+    size_t i = 0;
+    while (i < len && s->state != ST_ERROR) {
+        char c = data[i];
+
+        switch (s->state) {
+            case ST_STRING:
+                if (s->escape) {
+                    // 转义序列保持原样，由 json_field_string 解码
+                    s->escape = false;
+                    string_char(s, c);
+                } else if (c == '\\') {
+                    s->escape = true;
+                    string_char(s, c);
+                } else if (c == '"') {
+                    if (s->in_key) {
+                        s->state = ST_COLON;
+                    } else {
+                        emit(s, JSON_FIELD_STRING);
+                        value_done(s);
+                    }
+                } else {
+                    string_char(s, c);
+                }
+                break;
+
+            case ST_LITERAL:
+                if (c == ',' || c == '}' || c == ']' || is_ws(c)) {
+                    s->token[s->token_len] = '\0';
+                    json_field_kind_t kind = literal_kind(s);
+                    if (kind == JSON_FIELD_MISSING) {
+                        s->state = ST_ERROR;
+                        break;
+                    }
+                    emit(s, kind);
+                    value_done(s);
+                    // 结束字符由新状态处理
+                    continue;
+                }
+                if (s->token_len < JSON_STREAM_VALUE_MAX) {
+                    s->token[s->token_len++] = c;
+                } else {
+                    s->state = ST_ERROR;
+                }
+                break;
+
+            default:
+                if (is_ws(c)) {
+                    break;
+                }
+                switch (s->state) {
+                    case ST_VALUE_OR_END:
+                        if (c == ']') {
+                            pop(s, c);
+                            break;
+                        }
+                        start_value(s, c);
+                        break;
+                    case ST_VALUE:
+                        start_value(s, c);
+                        break;
+                    case ST_KEY_OR_END:
+                    case ST_KEY:
+                        if (c == '}' && s->state == ST_KEY_OR_END) {
+                            pop(s, c);
+                        } else if (c == '"') {
+                            s->stack[s->depth - 1].key_len = 0;
+                            s->in_key = true;
+                            s->escape = false;
+                            s->state = ST_STRING;
+                        } else {
+                            s->state = ST_ERROR;
+                        }
+                        break;
+                    case ST_COLON:
+                        s->state = (c == ':') ? ST_VALUE : ST_ERROR;
+                        break;
+                    case ST_COMMA_OR_END:
+                        if (c == '}' || c == ']') {
+                            pop(s, c);
+                        } else if (c == ',') {
+                            json_stream_frame_t *f = &s->stack[s->depth - 1];
+                            if (f->type == '[') {
+                                f->index++;
+                            }
+                            s->state = (f->type == '[') ? ST_VALUE : ST_KEY;
+                        } else {
+                            s->state = ST_ERROR;
+                        }
+                        break;
+                    default:
+                        // ST_DONE 之后只允许空白
+                        s->state = ST_ERROR;
+                        break;
+                }
+                break;
+        }
+        i++;
+    }
+    return (s->state == ST_ERROR) ? -1 : 0;
+}
+
+int json_stream_finish(json_stream_t *s)
+{
+    // 顶层的数字没有结束字符，在此结束
+    if (s->state == ST_LITERAL && s->depth == 0) {
+        json_stream_feed(s, " ", 1);
+    }
+    return (s->state == ST_DONE) ? 0 : -1;
+}
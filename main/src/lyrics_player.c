@@ -0,0 +1,316 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "lyrics_player.h"
+
+static const char *TAG = "lyrics_player";
+
+// 歌词行
+typedef struct {
+    uint32_t time_ms;       // 显示时刻
+    uint32_t text_offset;   // 文本在文本区中的偏移
+    uint32_t text_len;      // 文本长度
+} lyrics_line_t;
+
+// 歌词表，行数组和文本区与表头在同一块内存中
+typedef struct {
+    size_t count;
+    lyrics_line_t *lines;
+    char *text;
+} lyrics_table_t;
+
+static SemaphoreHandle_t s_mutex = NULL;
+static lyrics_table_t *s_table = NULL;
+static uint32_t s_generation = 0;          // 每次替换歌词表加一
+
+// 以下只由 LVGL 任务访问
+static uint32_t s_shown_generation = 0;    // 当前显示行所属的歌词表
+static int s_current = -1;                 // 当前显示行，-1 表示第一行之前
+
+// 解析一个时间标签 [mm:ss]、[mm:ss.x]、[mm:ss.xx] 或 [mm:ss.xxx]，p 指向 '[' 之后
+static bool parse_time_tag(const char *p, const char *end, uint32_t *time_ms, const char **tag_end)
+{
+    uint32_t minutes = 0;
+    uint32_t seconds = 0;
+    uint32_t fraction = 0;
+    int digits = 0;
+
+    while (p < end && *p >= '0' && *p <= '9') {
+        minutes = minutes * 10 + (*p++ - '0');
+        digits++;
+    }
+    if (digits == 0 || p >= end || *p++ != ':') {
+        return false;
+    }
+    digits = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        seconds = seconds * 10 + (*p++ - '0');
+        digits++;
+    }
+    if (digits == 0 || p >= end) {
+        return false;
+    }
+    if (*p == '.' || *p == ':') {
+        p++;
+        digits = 0;
+        while (p < end && *p >= '0' && *p <= '9') {
+            if (digits < 3) {
+                fraction = fraction * 10 + (*p - '0');
+                digits++;
+            }
+            p++;
+        }
+        // 统一换算为毫秒
+        for (; digits < 3; digits++) {
+            fraction *= 10;
+        }
+    }
+    if (p >= end || *p != ']') {
+        return false;
+    }
+    *time_ms = (minutes * 60 + seconds) * 1000 + fraction;
+    *tag_end = p + 1;
+    return true;
+}
+
+// 解析 [offset:+/-毫秒]，正值表示歌词提前显示
+static bool parse_offset_tag(const char *p, const char *end, int32_t *offset_ms)
+{
+    static const char prefix[] = "offset:";
+    size_t prefix_len = sizeof(prefix) - 1;
+    if ((size_t)(end - p) <= prefix_len || strncmp(p, prefix, prefix_len) != 0) {
+        return false;
+    }
+    *offset_ms = (int32_t)strtol(p + prefix_len, NULL, 10);
+    return true;
+}
+
+// 扫描一行：收集行首的时间标签，输出标签之后的歌词文本
+typedef struct {
+    const char *text;
+    size_t text_len;
+    int tag_count;
+    uint32_t tags[16];
+} lrc_line_t;
+
+static void scan_line(const char *line, const char *line_end, lrc_line_t *out, int32_t *offset_ms)
+{
+    const char *p = line;
+    out->tag_count = 0;
+    while (p < line_end && *p == '[') {
+        uint32_t time_ms;
+        const char *tag_end;
+        if (parse_time_tag(p + 1, line_end, &time_ms, &tag_end)) {
+            if (out->tag_count < (int)(sizeof(out->tags) / sizeof(out->tags[0]))) {
+                out->tags[out->tag_count++] = time_ms;
+            }
+            p = tag_end;
+            continue;
+        }
+        // 元数据标签整行只有一个，如 [ar:歌手]、[offset:500]
+        parse_offset_tag(p + 1, line_end, offset_ms);
+        break;
+    }
+
+    // 去掉行尾空白
+    const char *text_end = line_end;
+    while (text_end > p && (text_end[-1] == ' ' || text_end[-1] == '\t' || text_end[-1] == '\r')) {
+        text_end--;
+    }
+    out->text = p;
+    out->text_len = (out->tag_count > 0) ? (size_t)(text_end - p) : 0;
+}
+
+// 逐行扫描LRC，table 为 NULL 时只统计行数和文本字节数
+static void scan_lrc(const char *lrc, size_t len, lyrics_table_t *table, size_t *line_count, size_t *text_bytes)
+{
+    const char *p = lrc;
+    const char *end = lrc + len;
+    int32_t offset_ms = 0;
+    size_t count = 0;
+    size_t bytes = 0;
+
+    while (p < end) {
+        const char *eol = memchr(p, '\n', end - p);
+        if (eol == NULL) {
+            eol = end;
+        }
+        lrc_line_t line;
+        scan_line(p, eol, &line, &offset_ms);
+        p = eol + 1;
+        if (line.tag_count == 0) {
+            continue;
+        }
+
+        if (table != NULL) {
+            memcpy(table->text + bytes, line.text, line.text_len);
+            for (int i = 0; i < line.tag_count; i++) {
+                table->lines[count + i].time_ms = line.tags[i];
+                table->lines[count + i].text_offset = bytes;
+                table->lines[count + i].text_len = line.text_len;
+            }
+        }
+        count += line.tag_count;
+        bytes += line.text_len;
+    }
+
+    // offset 可能出现在任意位置，所有行读完后统一调整
+    if (table != NULL && offset_ms != 0) {
+        for (size_t i = 0; i < count; i++) {
+            int64_t t = (int64_t)table->lines[i].time_ms - offset_ms;
+            table->lines[i].time_ms = (t < 0) ? 0 : (uint32_t)t;
+        }
+    }
+    *line_count = count;
+    *text_bytes = bytes;
+}
+
+// 按时间稳定排序，LRC通常已按时间排列，插入排序接近线性
+static void sort_lines(lyrics_line_t *lines, size_t count)
+{
+    for (size_t i = 1; i < count; i++) {
+        lyrics_line_t line = lines[i];
+        size_t j = i;
+        while (j > 0 && lines[j - 1].time_ms > line.time_ms) {
+            lines[j] = lines[j - 1];
+            j--;
+        }
+        lines[j] = line;
+    }
+}
+
+esp_err_t lyrics_player_init(void)
+{
+    if (s_mutex == NULL) {
+        s_mutex = xSemaphoreCreateMutex();
+        if (s_mutex == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t lyrics_player_load(const char *lrc, size_t len)
+{
+    if (s_mutex == NULL || (lrc == NULL && len > 0)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    size_t count = 0;
+    size_t text_bytes = 0;
+    lyrics_table_t *table = NULL;
+    if (len > 0) {
+        scan_lrc(lrc, len, NULL, &count, &text_bytes);
+    }
+
+    if (count > 0) {
+        size_t size = sizeof(lyrics_table_t) + count * sizeof(lyrics_line_t) + text_bytes;
+        // 优先使用 PSRAM，失败时回退到内部RAM
+        table = heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+        if (table == NULL) {
+            table = heap_caps_malloc(size, MALLOC_CAP_8BIT);
+        }
+        if (table == NULL) {
+            ESP_LOGE(TAG, "分配歌词表失败: %u 字节", (unsigned int)size);
+            return ESP_ERR_NO_MEM;
+        }
+        table->count = count;
+        table->lines = (lyrics_line_t *)(table + 1);
+        table->text = (char *)(table->lines + count);
+        scan_lrc(lrc, len, table, &count, &text_bytes);
+        sort_lines(table->lines, count);
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    lyrics_table_t *old = s_table;
+    s_table = table;
+    s_generation++;
+    xSemaphoreGive(s_mutex);
+    heap_caps_free(old);
+
+    ESP_LOGI(TAG, "加载歌词: %u 行, 文本 %u 字节", (unsigned int)count, (unsigned int)text_bytes);
+    return ESP_OK;
+}
+
+bool lyrics_player_active(void)
+{
+    return s_table != NULL;
+}
+
+// 查找显示时刻不晚于 position_ms 的最后一行，没有则返回 -1
+static int find_line(const lyrics_table_t *table, uint32_t position_ms)
+{
+    int lo = 0;
+    int hi = (int)table->count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (table->lines[mid].time_ms <= position_ms) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo - 1;
+}
+
+// 判断 position_ms 是否落在第 index 行的显示区间内
+static bool line_contains(const lyrics_table_t *table, int index, uint32_t position_ms)
+{
+    if (index < -1 || index >= (int)table->count) {
+        return false;
+    }
+    if (index >= 0 && position_ms < table->lines[index].time_ms) {
+        return false;
+    }
+    return index + 1 >= (int)table->count || position_ms < table->lines[index + 1].time_ms;
+}
+
+bool lyrics_player_poll(uint32_t position_ms, char *buf, size_t size)
+{
+    // 歌词表正在替换时跳过本帧
+    if (s_mutex == NULL || buf == NULL || size == 0 || xSemaphoreTake(s_mutex, 0) != pdTRUE) {
+        return false;
+    }
+
+    const lyrics_table_t *table = s_table;
+    bool changed = false;
+    if (table != NULL) {
+        int index = s_current;
+        bool same_table = (s_shown_generation == s_generation);
+        if (!same_table || !line_contains(table, index, position_ms)) {
+            // 正常播放时只会前进一行，否则视为跳转
+            index = (same_table && line_contains(table, index + 1, position_ms)) ? index + 1
+                                                                                 : find_line(table, position_ms);
+        }
+        if (!same_table || index != s_current) {
+            size_t len = 0;
+            if (index >= 0) {
+                const lyrics_line_t *line = &table->lines[index];
+                len = line->text_len;
+                if (len > size - 1) {
+                    // 截断时不拆开UTF-8字符
+                    len = size - 1;
+                    while (len > 0 && ((uint8_t)table->text[line->text_offset + len] & 0xC0) == 0x80) {
+                        len--;
+                    }
+                }
+                memcpy(buf, table->text + line->text_offset, len);
+            }
+            buf[len] = '\0';
+            s_current = index;
+            s_shown_generation = s_generation;
+            changed = true;
+        }
+    }
+    xSemaphoreGive(s_mutex);
+    return changed;
+}
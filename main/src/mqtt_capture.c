@@ -0,0 +1,308 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "esp_partition.h"
+#include "mbedtls/base64.h"
+#include "mqtt_capture.h"
+
+static const char *TAG = "mqtt_capture";
+
+// 串口输出时每行的原始字节数（base64编码后为76个字符）
+#define MQTT_CAPTURE_DUMP_CHUNK 57
+
+// 串口输出行前缀，主机工具按该前缀从监视器日志中提取捕获数据
+#define MQTT_CAPTURE_DUMP_PREFIX "MQCAP:"
+
+static SemaphoreHandle_t s_mutex = NULL;
+static uint8_t *s_buffer = NULL;
+static uint32_t s_capacity = 0;
+static uint32_t s_used = 0;
+static uint32_t s_records = 0;
+static uint32_t s_dropped = 0;
+static bool s_active = false;
+static int64_t s_start_us = 0;
+static int64_t s_last_us = 0;
+static int64_t s_deadline_us = 0;
+
+static esp_partition_mmap_handle_t s_mmap_handle;
+static bool s_mapped = false;
+
+// 补全文件头中的记录数和数据长度
+static void finalize_header(void)
+{
+    mqtt_capture_header_t header = {
+        .magic = MQTT_CAPTURE_MAGIC,
+        .version = MQTT_CAPTURE_VERSION,
+        .header_size = sizeof(mqtt_capture_header_t),
+        .record_count = s_records,
+        .data_size = s_used - sizeof(mqtt_capture_header_t),
+    };
+    memcpy(s_buffer, &header, sizeof(header));
+}
+
+// 把捕获数据写入flash分区，分区不存在或空间不足时跳过
+static void save_to_partition(const uint8_t *data, uint32_t len)
+{
+    const esp_partition_t *part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                                           MQTT_CAPTURE_PARTITION);
+    if (part == NULL) {
+        ESP_LOGW(TAG, "未找到分区 %s，捕获数据只输出到串口", MQTT_CAPTURE_PARTITION);
+        return;
+    }
+    if (len > part->size) {
+        ESP_LOGW(TAG, "捕获数据 %u 字节超过分区大小 %u 字节", (unsigned int)len, (unsigned int)part->size);
+        return;
+    }
+
+    uint32_t erase_size = (len + part->erase_size - 1) / part->erase_size * part->erase_size;
+    esp_err_t err = esp_partition_erase_range(part, 0, erase_size);
+    if (err == ESP_OK) {
+        err = esp_partition_write(part, 0, data, len);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "写入分区失败: %s", esp_err_to_name(err));
+        return;
+    }
+    ESP_LOGI(TAG, "捕获数据已写入分区 %s (%u 字节)", MQTT_CAPTURE_PARTITION, (unsigned int)len);
+}
+
+// 以base64逐行输出捕获数据
+static void dump_to_console(const uint8_t *data, uint32_t len)
+{
+    unsigned char line[80];
+    printf(MQTT_CAPTURE_DUMP_PREFIX "BEGIN %u\n", (unsigned int)len);
+    for (uint32_t offset = 0; offset < len; offset += MQTT_CAPTURE_DUMP_CHUNK) {
+        size_t chunk = (len - offset < MQTT_CAPTURE_DUMP_CHUNK) ? len - offset : MQTT_CAPTURE_DUMP_CHUNK;
+        size_t olen = 0;
+        mbedtls_base64_encode(line, sizeof(line), &olen, data + offset, chunk);
+        printf(MQTT_CAPTURE_DUMP_PREFIX "%.*s\n", (int)olen, line);
+        // 给串口和看门狗留出时间
+        if ((offset / MQTT_CAPTURE_DUMP_CHUNK) % 64 == 63) {
+            vTaskDelay(1);
+        }
+    }
+    printf(MQTT_CAPTURE_DUMP_PREFIX "END\n");
+}
+
+// 保存任务：捕获停止后写入flash、输出到串口并释放缓冲区，避免阻塞 esp-mqtt 任务
+static void capture_save_task(void *arg)
+{
+    uint8_t *buffer = s_buffer;
+    uint32_t len = s_used;
+
+    ESP_LOGI(TAG, "捕获结束: %u 条消息, %u 字节, 未捕获 %u 条", (unsigned int)s_records,
+             (unsigned int)len, (unsigned int)s_dropped);
+    save_to_partition(buffer, len);
+    dump_to_console(buffer, len);
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    s_buffer = NULL;
+    s_capacity = 0;
+    xSemaphoreGive(s_mutex);
+    heap_caps_free(buffer);
+    vTaskDelete(NULL);
+}
+
+// 停止捕获（调用者持有互斥锁）
+static esp_err_t stop_locked(void)
+{
+    if (!s_active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_active = false;
+    finalize_header();
+    if (xTaskCreate(capture_save_task, "mqtt_capture_save", 4096, NULL, 2, NULL) != pdPASS) {
+        // 没有任务接手缓冲区：捕获数据丢弃，释放后允许重新开始捕获
+        ESP_LOGE(TAG, "创建捕获保存任务失败，丢弃 %u 字节捕获数据", (unsigned int)s_used);
+        heap_caps_free(s_buffer);
+        s_buffer = NULL;
+        s_capacity = 0;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t mqtt_capture_start(size_t capacity, uint32_t duration_ms)
+{
+    if (capacity <= sizeof(mqtt_capture_header_t) || capacity > UINT32_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_mutex == NULL) {
+        s_mutex = xSemaphoreCreateMutex();
+        if (s_mutex == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    if (s_active || s_buffer != NULL) {
+        xSemaphoreGive(s_mutex);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // 优先使用 PSRAM，失败时回退到内部RAM
+    s_buffer = heap_caps_malloc(capacity, MALLOC_CAP_SPIRAM);
+    if (s_buffer == NULL) {
+        s_buffer = heap_caps_malloc(capacity, MALLOC_CAP_8BIT);
+    }
+    if (s_buffer == NULL) {
+        xSemaphoreGive(s_mutex);
+        ESP_LOGE(TAG, "分配捕获缓冲区失败: %u 字节", (unsigned int)capacity);
+        return ESP_ERR_NO_MEM;
+    }
+
+    s_capacity = (uint32_t)capacity;
+    s_used = sizeof(mqtt_capture_header_t);
+    s_records = 0;
+    s_dropped = 0;
+    s_start_us = esp_timer_get_time();
+    s_last_us = s_start_us;
+    s_deadline_us = (duration_ms > 0) ? s_start_us + (int64_t)duration_ms * 1000 : 0;
+    s_active = true;
+    xSemaphoreGive(s_mutex);
+
+    ESP_LOGI(TAG, "开始捕获MQTT流量: 缓冲区 %u 字节, 时长 %u ms", (unsigned int)capacity,
+             (unsigned int)duration_ms);
+    return ESP_OK;
+}
+
+void mqtt_capture_record(const char *topic, int topic_len, const char *data, int data_len, int qos, int retain)
+{
+    if (!s_active || topic_len < 0 || topic_len > UINT16_MAX || data_len < 0) {
+        return;
+    }
+
+    int64_t now = esp_timer_get_time();
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    if (!s_active) {
+        xSemaphoreGive(s_mutex);
+        return;
+    }
+
+    if (s_deadline_us != 0 && now >= s_deadline_us) {
+        stop_locked();
+        xSemaphoreGive(s_mutex);
+        return;
+    }
+
+    uint32_t size = sizeof(mqtt_capture_record_t) + (uint32_t)topic_len + (uint32_t)data_len;
+    if (size > s_capacity - s_used) {
+        // 缓冲区已满，保留从开始捕获起连续的流量
+        s_dropped++;
+        stop_locked();
+        xSemaphoreGive(s_mutex);
+        return;
+    }
+
+    // 间隔超过 uint32_t 范围（约71分钟）时截断
+    int64_t delta = now - s_last_us;
+    mqtt_capture_record_t record = {
+        .delta_us = (delta > UINT32_MAX) ? UINT32_MAX : (uint32_t)delta,
+        .data_len = (uint32_t)data_len,
+        .topic_len = (uint16_t)topic_len,
+        .qos = (uint8_t)qos,
+        .retain = (uint8_t)retain,
+    };
+    uint8_t *p = s_buffer + s_used;
+    memcpy(p, &record, sizeof(record));
+    p += sizeof(record);
+    memcpy(p, topic, topic_len);
+    p += topic_len;
+    if (data_len > 0) {
+        memcpy(p, data, data_len);
+    }
+
+    s_used += size;
+    s_records++;
+    s_last_us = now;
+    xSemaphoreGive(s_mutex);
+}
+
+esp_err_t mqtt_capture_stop(void)
+{
+    if (s_mutex == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    esp_err_t err = stop_locked();
+    xSemaphoreGive(s_mutex);
+    return err;
+}
+
+void mqtt_capture_get_stats(mqtt_capture_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    stats->active = s_active;
+    stats->capacity = s_capacity;
+    stats->used = s_used;
+    stats->records = s_records;
+    stats->dropped = s_dropped;
+}
+
+bool mqtt_capture_validate(const uint8_t *data, size_t len)
+{
+    if (data == NULL || len < sizeof(mqtt_capture_header_t)) {
+        return false;
+    }
+    mqtt_capture_header_t header;
+    memcpy(&header, data, sizeof(header));
+    return header.magic == MQTT_CAPTURE_MAGIC && header.version == MQTT_CAPTURE_VERSION &&
+           header.header_size >= sizeof(mqtt_capture_header_t) &&
+           (uint64_t)header.header_size + header.data_size <= len;
+}
+
+esp_err_t mqtt_capture_map(const uint8_t **data, size_t *len)
+{
+    if (data == NULL || len == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_mapped) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    const esp_partition_t *part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                                           MQTT_CAPTURE_PARTITION);
+    if (part == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    const void *ptr = NULL;
+    esp_err_t err = esp_partition_mmap(part, 0, part->size, ESP_PARTITION_MMAP_DATA, &ptr, &s_mmap_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "映射分区失败: %s", esp_err_to_name(err));
+        return err;
+    }
+    if (!mqtt_capture_validate(ptr, part->size)) {
+        esp_partition_munmap(s_mmap_handle);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    mqtt_capture_header_t header;
+    memcpy(&header, ptr, sizeof(header));
+    *data = ptr;
+    *len = header.header_size + header.data_size;
+    s_mapped = true;
+    return ESP_OK;
+}
+
+void mqtt_capture_unmap(void)
+{
+    if (s_mapped) {
+        esp_partition_munmap(s_mmap_handle);
+        s_mapped = false;
+    }
+}
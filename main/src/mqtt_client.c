@@ -10,9 +10,14 @@
 #include "freertos/task.h"
 #include "esp_err.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "mqtt_client.h"
 #include "esp32_mqtt_client.h"
 #include "event_system.h"
+#include "mqtt_dispatch.h"
+#include "event_metrics.h"
+#include "mqtt_ring.h"
+#include "mqtt_capture.h"
 
 static const char *TAG = "mqtt_client";
 
@@ -22,25 +27,69 @@ extern bool is_wifi_connected(void);
 // MQTT客户端句柄
 static esp_mqtt_client_handle_t g_mqtt_client = NULL;
 
-// MQTT服务器配置
-#define MQTT_BROKER_URL "mqtt://192.168.1.115:1883" // 修正IP地址，192.158应为192.168
-#define MQTT_USERNAME "caiyy"
-#define MQTT_PASSWORD "yangyong1229"
+// 入站消息环形缓冲区，每个优先级通道一个
+static mqtt_ring_t *s_mqtt_rings[EVENT_LANE_MAX] = {NULL};
+
+// 环形缓冲区大小
+#define MQTT_RING_SIZE_INTERACTIVE (4 * 1024)
+#define MQTT_RING_SIZE_BULK (16 * 1024)
+
+// MQTT服务器配置，地址和账号在 menuconfig 中设置，保存在不提交的 sdkconfig 中
+#define MQTT_BROKER_URL CONFIG_SMART_PANEL_MQTT_BROKER_URI
+#define MQTT_USERNAME CONFIG_SMART_PANEL_MQTT_USERNAME
+#define MQTT_PASSWORD CONFIG_SMART_PANEL_MQTT_PASSWORD
 #define MQTT_CLIENT_ID "esp32_jt"
 #define MQTT_KEEPALIVE 30
 
-// 订阅主题
-#define MQTT_SUBSCRIBE_TOPIC_LYRICS "homeassistant/sensor/esp32_music_player/lyrics/state"
-#define MQTT_SUBSCRIBE_TOPIC_SONG "homeassistant/sensor/esp32_music_player/song/state"
-#define MQTT_SUBSCRIBE_TOPIC_ARTIST "homeassistant/sensor/esp32_music_player/artist/state"
-#define MQTT_SUBSCRIBE_TOPIC_POSITION "homeassistant/number/esp32_music_player/position/state"
-#define MQTT_SUBSCRIBE_TOPIC_VOLUME "homeassistant/number/esp32_music_player/volume/state"
-#define MQTT_SUBSCRIBE_TOPIC_PROGRESS "homeassistant/sensor/esp32_music_player/progress/state"
-// 能耗相关主题 - Tasmota设备
-#define MQTT_SUBSCRIBE_TOPIC_TASMOTA_ENERGY "tele/tasmota_A0DA50/SENSOR"
-#define MQTT_SUBSCRIBE_TOPIC_URL "homeassistant/sensor/esp32_music_player/url/state"
-#define MQTT_SUBSCRIBE_TOPIC_PLAY_STATE "homeassistant/switch/esp32_music_player/play/state"
-#define MQTT_SUBSCRIBE_QOS 0
+// esp-mqtt 接收缓冲区，需容纳整首歌的LRC，超出时消息会被分片
+#define MQTT_RX_BUFFER_SIZE (8 * 1024)
+
+// esp-mqtt 发送缓冲区
+#define MQTT_TX_BUFFER_SIZE 1024
+
+// 单个SUBSCRIBE包中主题过滤器的字节预算，需小于 esp-mqtt 的发送缓冲区
+#define MQTT_SUBSCRIBE_BATCH_BYTES 768
+
+// 订阅列表，由路由表和通配符生成
+static esp_mqtt_topic_t s_subscriptions[MQTT_DISPATCH_MAX_ROUTES + MQTT_DISPATCH_MAX_WILDCARDS];
+
+// 重连耗时统计：开始连接的时刻，以及是否在等待连接后的首条消息
+static int64_t s_connect_start_us = 0;
+static int64_t s_connected_us = 0;
+static bool s_awaiting_first_message = false;
+
+// 连接状态，在 esp-mqtt 任务中更新
+static volatile bool s_connected = false;
+
+// 按路由表订阅所有主题，多个主题合并进一个SUBSCRIBE包，超出缓冲区时分批发送
+static void subscribe_routes(esp_mqtt_client_handle_t client)
+{
+    size_t count = mqtt_dispatch_build_subscriptions(s_subscriptions,
+                                                     sizeof(s_subscriptions) / sizeof(s_subscriptions[0]));
+    size_t batch_start = 0;
+    size_t batch_bytes = 0;
+    int packets = 0;
+
+    for (size_t i = 0; i <= count; i++) {
+        // 每个过滤器占 2字节长度 + 内容 + 1字节QoS
+        size_t bytes = (i < count) ? strlen(s_subscriptions[i].filter) + 3 : 0;
+        if (i == count || (i > batch_start && batch_bytes + bytes > MQTT_SUBSCRIBE_BATCH_BYTES)) {
+            if (i > batch_start) {
+                int msg_id = esp_mqtt_client_subscribe_multiple(client, &s_subscriptions[batch_start],
+                                                                (int)(i - batch_start));
+                if (msg_id < 0) {
+                    ESP_LOGE(TAG, "批量订阅失败: %u 个主题", (unsigned int)(i - batch_start));
+                }
+                packets++;
+            }
+            batch_start = i;
+            batch_bytes = 0;
+        }
+        batch_bytes += bytes;
+    }
+
+    ESP_LOGI(TAG, "已订阅 %u 个主题过滤器 (%d 个SUBSCRIBE包)", (unsigned int)count, packets);
+}
 
 // MQTT事件处理回调函数
 static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_t event_id, void *event_data)
@@ -51,25 +100,20 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_
     switch (event_id) {
         case MQTT_EVENT_CONNECTED:
             // ESP_LOGI(TAG, "MQTT连接成功");
-            // 订阅所有主题
-            esp_mqtt_client_subscribe(g_mqtt_client, MQTT_SUBSCRIBE_TOPIC_LYRICS, MQTT_SUBSCRIBE_QOS);
-            esp_mqtt_client_subscribe(g_mqtt_client, MQTT_SUBSCRIBE_TOPIC_SONG, MQTT_SUBSCRIBE_QOS);
-            esp_mqtt_client_subscribe(g_mqtt_client, MQTT_SUBSCRIBE_TOPIC_ARTIST, MQTT_SUBSCRIBE_QOS);
-            esp_mqtt_client_subscribe(g_mqtt_client, MQTT_SUBSCRIBE_TOPIC_POSITION, MQTT_SUBSCRIBE_QOS);
-            esp_mqtt_client_subscribe(g_mqtt_client, MQTT_SUBSCRIBE_TOPIC_VOLUME, MQTT_SUBSCRIBE_QOS);
-            esp_mqtt_client_subscribe(g_mqtt_client, MQTT_SUBSCRIBE_TOPIC_PROGRESS, MQTT_SUBSCRIBE_QOS);
-            // 订阅Tasmota能耗主题
-            esp_mqtt_client_subscribe(g_mqtt_client, MQTT_SUBSCRIBE_TOPIC_TASMOTA_ENERGY, MQTT_SUBSCRIBE_QOS);
-            // 订阅封面 URL 主题
-            esp_mqtt_client_subscribe(g_mqtt_client, MQTT_SUBSCRIBE_TOPIC_URL, MQTT_SUBSCRIBE_QOS);
-            // 订阅播放状态主题
-            esp_mqtt_client_subscribe(g_mqtt_client, MQTT_SUBSCRIBE_TOPIC_PLAY_STATE, MQTT_SUBSCRIBE_QOS);
+            s_connected_us = esp_timer_get_time();
+            s_connected = true;
+            s_awaiting_first_message = true;
+            ESP_LOGI(TAG, "MQTT连接耗时 %lld ms", (long long)((s_connected_us - s_connect_start_us) / 1000));
+            
+            // 按路由表订阅所有主题
+            subscribe_routes(g_mqtt_client);
             
             // ESP_LOGI(TAG, "已订阅所有主题");
             // 发送MQTT连接成功事件
             event_system_post(EVENT_TYPE_MQTT_CONNECTED, NULL, 0);
             break;
         case MQTT_EVENT_DISCONNECTED:
+            s_connected = false;
             // 检查WiFi连接状态
             if (!is_wifi_connected()) {
                 ESP_LOGI(TAG, "MQTT断开连接(WiFi已断开)");
@@ -93,40 +137,32 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_
             // ESP_LOGI(TAG, "主题: %.*s", event->topic_len, event->topic);
             // ESP_LOGI(TAG, "数据: %.*s", event->data_len, event->data);
             
-            // 分配内存存储MQTT消息
-            mqtt_message_t *mqtt_msg = malloc(sizeof(mqtt_message_t));
-            if (mqtt_msg == NULL) {
-                // ESP_LOGE(TAG, "分配MQTT消息内存失败");
+            // 超出接收缓冲区的消息会分片到达，分片无法单独解析，整条丢弃
+            if (event->data_len != event->total_data_len) {
+                if (event->current_data_offset == 0) {
+                    ESP_LOGW(TAG, "消息超出接收缓冲区 (%d 字节)，丢弃: %.*s", event->total_data_len,
+                             event->topic_len, event->topic);
+                }
                 break;
             }
             
-            // 复制主题
-            mqtt_msg->topic = malloc(event->topic_len + 1);
-            if (mqtt_msg->topic == NULL) {
-                // ESP_LOGE(TAG, "分配主题内存失败");
-                free(mqtt_msg);
-                break;
+            if (s_awaiting_first_message) {
+                // 重连到首条更新的耗时，用于评估订阅方式对恢复速度的影响
+                s_awaiting_first_message = false;
+                int64_t now = esp_timer_get_time();
+                ESP_LOGI(TAG, "重连后首条消息: 距开始连接 %lld ms, 距连接成功 %lld ms (%.*s)",
+                         (long long)((now - s_connect_start_us) / 1000), (long long)((now - s_connected_us) / 1000),
+                         event->topic_len, event->topic);
             }
-            memcpy(mqtt_msg->topic, event->topic, event->topic_len);
-            mqtt_msg->topic[event->topic_len] = '\0';
             
-            // 复制数据
-            mqtt_msg->data = malloc(event->data_len + 1);
-            if (mqtt_msg->data == NULL) {
-                // ESP_LOGE(TAG, "分配数据内存失败");
-                free(mqtt_msg->topic);
-                free(mqtt_msg);
-                break;
-            }
-            memcpy(mqtt_msg->data, event->data, event->data_len);
-            mqtt_msg->data[event->data_len] = '\0';
+            // 捕获模式下记录原始入站流量，供离线回放
+            mqtt_capture_record(event->topic, event->topic_len, event->data, event->data_len,
+                                event->qos, event->retain);
             
-            mqtt_msg->data_len = event->data_len;
-            mqtt_msg->qos = event->qos;
-            mqtt_msg->retain = event->retain;
-            
-            // 发送MQTT消息接收事件
-            event_system_post(EVENT_TYPE_MQTT_MESSAGE_RECEIVED, mqtt_msg, sizeof(mqtt_message_t));
+            if (mqtt_client_inject(event->topic, event->topic_len, event->data, event->data_len,
+                                   event->qos, event->retain) == ESP_ERR_NO_MEM) {
+                ESP_LOGD(TAG, "MQTT环形缓冲区已满，丢弃消息: %.*s", event->topic_len, event->topic);
+            }
             break;
         case MQTT_EVENT_ERROR:
             // ESP_LOGE(TAG, "MQTT错误");
@@ -139,6 +175,7 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_
             break;
         case MQTT_EVENT_BEFORE_CONNECT:
             // ESP_LOGI(TAG, "MQTT准备连接");
+            s_connect_start_us = esp_timer_get_time();
             break;
         default:
             // ESP_LOGW(TAG, "未知MQTT事件: %d", event_id);
@@ -151,14 +188,35 @@ esp_err_t mqtt_client_init(void)
 {
     // ESP_LOGI(TAG, "初始化MQTT客户端");
     
+    // 创建入站消息环形缓冲区
+    if (s_mqtt_rings[EVENT_LANE_INTERACTIVE] == NULL) {
+        s_mqtt_rings[EVENT_LANE_INTERACTIVE] = mqtt_ring_create(MQTT_RING_SIZE_INTERACTIVE);
+        s_mqtt_rings[EVENT_LANE_BULK] = mqtt_ring_create(MQTT_RING_SIZE_BULK);
+        if (s_mqtt_rings[EVENT_LANE_INTERACTIVE] == NULL || s_mqtt_rings[EVENT_LANE_BULK] == NULL) {
+            ESP_LOGE(TAG, "创建MQTT环形缓冲区失败");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    
+#if CONFIG_SMART_PANEL_MQTT_CAPTURE
+    // 开始捕获入站流量，结束后写入 mqttcap 分区并输出到串口
+    if (mqtt_capture_start(CONFIG_SMART_PANEL_MQTT_CAPTURE_SIZE_KB * 1024,
+                           CONFIG_SMART_PANEL_MQTT_CAPTURE_DURATION_S * 1000) != ESP_OK) {
+        ESP_LOGW(TAG, "启动MQTT流量捕获失败");
+    }
+#endif
+    
     // 配置MQTT客户端
     esp_mqtt_client_config_t mqtt_cfg = {
         .broker.address.uri = MQTT_BROKER_URL,
-        .credentials.username = MQTT_USERNAME,
-        .credentials.authentication.password = MQTT_PASSWORD,
+        // 未设置账号时匿名连接
+        .credentials.username = (MQTT_USERNAME[0] != '\0') ? MQTT_USERNAME : NULL,
+        .credentials.authentication.password = (MQTT_PASSWORD[0] != '\0') ? MQTT_PASSWORD : NULL,
         .credentials.client_id = MQTT_CLIENT_ID,
         .session.keepalive = MQTT_KEEPALIVE,
         .network.disable_auto_reconnect = false,
+        .buffer.size = MQTT_RX_BUFFER_SIZE,
+        .buffer.out_size = MQTT_TX_BUFFER_SIZE,
     };
     
     // 创建MQTT客户端
@@ -261,8 +319,63 @@ esp_err_t mqtt_client_publish(const char *topic, const char *data, int qos, bool
     return ESP_OK;
 }
 
+// 将MQTT消息放入发送队列
+esp_err_t mqtt_client_enqueue(const char *topic, const char *data, int qos, bool retain)
+{
+    if (g_mqtt_client == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    if (topic == NULL || data == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    // QoS 0 的消息也必须存入发件箱才会被MQTT任务发送
+    int msg_id = esp_mqtt_client_enqueue(g_mqtt_client, topic, data, strlen(data), qos, retain, true);
+    if (msg_id < 0) {
+        return ESP_FAIL;
+    }
+    
+    return ESP_OK;
+}
+
+// MQTT是否已连接
+bool mqtt_client_is_connected(void)
+{
+    return s_connected;
+}
+
 // 获取MQTT客户端句柄
 esp_mqtt_client_handle_t mqtt_client_get_handle(void)
 {
     return g_mqtt_client;
 }
+
+// 写入入站消息并通知事件处理任务
+esp_err_t mqtt_client_inject(const char *topic, int topic_len, const char *data, int data_len, int qos, int retain)
+{
+    // 通配符订阅会收到路由表之外的主题，在写入缓冲区前丢弃
+    event_lane_t lane;
+    if (!mqtt_dispatch_lane(topic, topic_len, &lane)) {
+        ESP_LOGD(TAG, "没有匹配的路由，丢弃消息: %.*s", topic_len, topic);
+        return ESP_ERR_NOT_FOUND;
+    }
+    
+    // 整条消息连续写入对应通道的环形缓冲区，无需分配内存
+    if (!mqtt_ring_write(s_mqtt_rings[lane], topic, topic_len, data, data_len, qos, retain, event_metrics_now_us())) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    // 通知事件处理任务，缓冲区中已有未处理的消息时门铃事件会被合并
+    event_system_post_owned_lane(EVENT_TYPE_MQTT_MESSAGE_RECEIVED, NULL, 0, lane);
+    return ESP_OK;
+}
+
+// 获取入站消息环形缓冲区
+struct mqtt_ring *mqtt_client_get_ring(event_lane_t lane)
+{
+    if (lane >= EVENT_LANE_MAX) {
+        return NULL;
+    }
+    return s_mqtt_rings[lane];
+}
@@ -0,0 +1,272 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <string.h>
+#include "esp_log.h"
+#include "mqtt_dispatch.h"
+
+static const char *TAG = "mqtt_dispatch";
+
+// 哈希表大小为路由上限的两倍（2的幂），装载率不超过50%，线性探测平均不到两次
+#define MQTT_DISPATCH_TABLE_SIZE (MQTT_DISPATCH_MAX_ROUTES * 2)
+#define MQTT_DISPATCH_TABLE_MASK (MQTT_DISPATCH_TABLE_SIZE - 1)
+
+_Static_assert((MQTT_DISPATCH_TABLE_SIZE & MQTT_DISPATCH_TABLE_MASK) == 0, "哈希表大小必须是2的幂");
+_Static_assert(MQTT_DISPATCH_MAX_ROUTES < UINT16_MAX, "哈希槽位为 uint16_t");
+
+// 路由运行时状态
+typedef struct {
+    const mqtt_route_t *route;  // 路由定义
+    uint32_t topic_hash;        // 主题哈希，探测时先比哈希再比字符串
+    size_t topic_len;           // 主题长度
+    uint32_t last_hash;         // 上一次发布值的哈希
+    bool has_last;              // 是否已发布过
+} route_entry_t;
+
+static route_entry_t s_routes[MQTT_DISPATCH_MAX_ROUTES];
+static size_t s_route_count = 0;
+
+// 哈希槽位，保存路由序号+1，0表示空
+static uint16_t s_table[MQTT_DISPATCH_TABLE_SIZE];
+
+// 通配符订阅
+static const esp_mqtt_topic_t *s_wildcards[MQTT_DISPATCH_MAX_WILDCARDS];
+static size_t s_wildcard_count = 0;
+
+// FNV-1a 32位哈希
+static uint32_t fnv1a(const void *data, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= p[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// 查找主题对应的路由
+static route_entry_t *lookup(const char *topic, size_t topic_len)
+{
+    uint32_t hash = fnv1a(topic, topic_len);
+    for (uint32_t i = hash & MQTT_DISPATCH_TABLE_MASK;; i = (i + 1) & MQTT_DISPATCH_TABLE_MASK) {
+        uint16_t slot = s_table[i];
+        if (slot == 0) {
+            return NULL;
+        }
+        route_entry_t *entry = &s_routes[slot - 1];
+        if (entry->topic_hash == hash && entry->topic_len == topic_len &&
+            memcmp(entry->route->topic, topic, topic_len) == 0) {
+            return entry;
+        }
+    }
+}
+
+esp_err_t mqtt_dispatch_register(const mqtt_route_t *routes, size_t count)
+{
+    if (routes == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (s_route_count + count > MQTT_DISPATCH_MAX_ROUTES) {
+        ESP_LOGE(TAG, "路由数量超过上限: %u", (unsigned int)(s_route_count + count));
+        return ESP_ERR_NO_MEM;
+    }
+
+    for (size_t n = 0; n < count; n++) {
+        const mqtt_route_t *route = &routes[n];
+        if (route->topic == NULL || route->parser == NULL || route->ui_type >= UI_UPDATE_TYPE_MAX ||
+            route->lane >= EVENT_LANE_MAX) {
+            ESP_LOGE(TAG, "无效的路由: %u", (unsigned int)n);
+            return ESP_ERR_INVALID_ARG;
+        }
+
+        size_t topic_len = strlen(route->topic);
+        if (lookup(route->topic, topic_len) != NULL) {
+            ESP_LOGE(TAG, "重复注册主题: %s", route->topic);
+            return ESP_ERR_INVALID_STATE;
+        }
+
+        route_entry_t *entry = &s_routes[s_route_count];
+        entry->route = route;
+        entry->topic_hash = fnv1a(route->topic, topic_len);
+        entry->topic_len = topic_len;
+        entry->has_last = false;
+
+        uint32_t i = entry->topic_hash & MQTT_DISPATCH_TABLE_MASK;
+        while (s_table[i] != 0) {
+            i = (i + 1) & MQTT_DISPATCH_TABLE_MASK;
+        }
+        s_table[i] = (uint16_t)(s_route_count + 1);
+        s_route_count++;
+    }
+
+    ESP_LOGI(TAG, "已注册 %u 条MQTT路由", (unsigned int)s_route_count);
+    return ESP_OK;
+}
+
+esp_err_t mqtt_dispatch_message(const mqtt_message_t *msg)
+{
+    if (msg == NULL || msg->topic == NULL || msg->data == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    route_entry_t *entry = lookup(msg->topic, strlen(msg->topic));
+    if (entry == NULL) {
+        ESP_LOGD(TAG, "没有匹配的路由: %s", msg->topic);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    const mqtt_route_t *route = entry->route;
+    ui_update_t update = {0};
+    update.type = route->ui_type;
+    update.origin_time = msg->recv_time;
+    if (!route->parser(msg, &update)) {
+        return ESP_OK;
+    }
+
+    // 按策略比对解析结果，未变化则不发布
+    if (route->change_policy != MQTT_CHANGE_ALWAYS) {
+        uint32_t hash;
+        if (route->change_policy == MQTT_CHANGE_STR) {
+            if (update.tag != UI_VALUE_STR) {
+                return ESP_ERR_INVALID_STATE;
+            }
+            hash = fnv1a(update.value.str_value, update.len);
+        } else {
+            hash = fnv1a(&update.value.int_value, sizeof(update.value.int_value));
+        }
+        if (entry->has_last && entry->last_hash == hash) {
+            return ESP_OK;
+        }
+        entry->last_hash = hash;
+        entry->has_last = true;
+    }
+
+    return event_system_post_ui_update(&update);
+}
+
+bool mqtt_dispatch_lane(const char *topic, size_t topic_len, event_lane_t *lane)
+{
+    if (topic == NULL || lane == NULL) {
+        return false;
+    }
+    route_entry_t *entry = lookup(topic, topic_len);
+    if (entry == NULL) {
+        return false;
+    }
+    *lane = entry->route->lane;
+    return true;
+}
+
+esp_err_t mqtt_dispatch_register_wildcards(const esp_mqtt_topic_t *filters, size_t count)
+{
+    if (filters == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_wildcard_count + count > MQTT_DISPATCH_MAX_WILDCARDS) {
+        ESP_LOGE(TAG, "通配符订阅数量超过上限: %u", (unsigned int)(s_wildcard_count + count));
+        return ESP_ERR_NO_MEM;
+    }
+    for (size_t n = 0; n < count; n++) {
+        if (filters[n].filter == NULL) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        s_wildcards[s_wildcard_count++] = &filters[n];
+    }
+    return ESP_OK;
+}
+
+bool mqtt_dispatch_topic_matches(const char *filter, const char *topic, size_t topic_len)
+{
+    const char *t = topic;
+    const char *t_end = topic + topic_len;
+    const char *f = filter;
+
+    while (*f != '\0') {
+        if (*f == '#') {
+            // '#' 匹配其后所有层级（含父级本身）
+            return true;
+        }
+        if (*f == '+') {
+            // '+' 匹配一级，跳到本级末尾
+            while (t < t_end && *t != '/') {
+                t++;
+            }
+            f++;
+        } else {
+            while (*f != '\0' && *f != '/') {
+                if (t >= t_end || *t != *f) {
+                    return false;
+                }
+                t++;
+                f++;
+            }
+            if (t < t_end && *t != '/') {
+                return false;
+            }
+        }
+
+        if (*f == '/') {
+            if (t >= t_end) {
+                // "a/#" 也匹配 "a"
+                return (f[1] == '#' && f[2] == '\0');
+            }
+            f++;
+            t++;
+        }
+    }
+    return t == t_end;
+}
+
+// 路由是否已被某个通配符订阅覆盖
+static bool covered_by_wildcard(const route_entry_t *entry)
+{
+    for (size_t w = 0; w < s_wildcard_count; w++) {
+        if (mqtt_dispatch_topic_matches(s_wildcards[w]->filter, entry->route->topic, entry->topic_len)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t mqtt_dispatch_build_subscriptions(esp_mqtt_topic_t *topics, size_t max)
+{
+    if (topics == NULL) {
+        return 0;
+    }
+
+    size_t count = 0;
+    for (size_t w = 0; w < s_wildcard_count && count < max; w++) {
+        for (size_t i = 0; i < s_route_count; i++) {
+            if (mqtt_dispatch_topic_matches(s_wildcards[w]->filter, s_routes[i].route->topic, s_routes[i].topic_len)) {
+                topics[count++] = *s_wildcards[w];
+                break;
+            }
+        }
+    }
+    for (size_t i = 0; i < s_route_count && count < max; i++) {
+        if (!covered_by_wildcard(&s_routes[i])) {
+            topics[count].filter = s_routes[i].route->topic;
+            topics[count].qos = s_routes[i].route->qos;
+            count++;
+        }
+    }
+    return count;
+}
+
+size_t mqtt_dispatch_route_count(void)
+{
+    return s_route_count;
+}
+
+const mqtt_route_t *mqtt_dispatch_get_route(size_t index)
+{
+    if (index >= s_route_count) {
+        return NULL;
+    }
+    return s_routes[index].route;
+}
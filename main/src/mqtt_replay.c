@@ -0,0 +1,298 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "mqtt_replay.h"
+#include "mqtt_ring.h"
+#include "mqtt_capture.h"
+#include "event_pool.h"
+#include "event_metrics.h"
+#include "ui_update_channel.h"
+#include "esp32_mqtt_client.h"
+
+static const char *TAG = "mqtt_replay";
+
+// 内置流量样本（main/bench/mqtt_trace.txt），EMBED_TXTFILES 会在末尾追加 '\0'
+extern const char mqtt_trace_start[] asm("_binary_mqtt_trace_txt_start");
+extern const char mqtt_trace_end[] asm("_binary_mqtt_trace_txt_end");
+
+// 等待流水线处理完剩余消息的最长时间
+#define MQTT_REPLAY_DRAIN_TIMEOUT_US (5 * 1000 * 1000)
+
+// 最高速回放时样本的重复次数
+#define MQTT_REPLAY_MAX_SPEED_LOOPS 20
+
+// 回放前后的流水线统计快照，差值即本次回放的增量
+typedef struct {
+    event_queue_stats_t queues[EVENT_QUEUE_MAX];
+    mqtt_ring_stats_t rings[EVENT_LANE_MAX];
+    event_pool_stats_t pool;
+    ui_update_channel_stats_t channel;
+} pipeline_snapshot_t;
+
+static const char *const s_queue_names[EVENT_QUEUE_MAX] = {"system", "ui"};
+static const char *const s_lane_names[EVENT_LANE_MAX] = {"interactive", "bulk"};
+
+static void take_snapshot(pipeline_snapshot_t *snapshot)
+{
+    for (int i = 0; i < EVENT_QUEUE_MAX; i++) {
+        event_system_get_queue_stats((event_queue_id_t)i, &snapshot->queues[i]);
+    }
+    for (int i = 0; i < EVENT_LANE_MAX; i++) {
+        mqtt_ring_get_stats(mqtt_client_get_ring((event_lane_t)i), &snapshot->rings[i]);
+    }
+    event_pool_get_stats(&snapshot->pool);
+    ui_update_channel_get_stats(&snapshot->channel);
+}
+
+// 等待环形缓冲区被事件处理任务取空，再留出一帧给 LVGL 任务应用UI更新
+static void wait_pipeline_idle(void)
+{
+    int64_t deadline = esp_timer_get_time() + MQTT_REPLAY_DRAIN_TIMEOUT_US;
+    while (esp_timer_get_time() < deadline) {
+        bool idle = true;
+        for (int i = 0; i < EVENT_LANE_MAX; i++) {
+            mqtt_ring_stats_t stats = {0};
+            mqtt_ring_get_stats(mqtt_client_get_ring((event_lane_t)i), &stats);
+            if (stats.used != 0) {
+                idle = false;
+            }
+        }
+        if (idle) {
+            break;
+        }
+        vTaskDelay(pdMS_TO_TICKS(5));
+    }
+    vTaskDelay(pdMS_TO_TICKS(50));
+}
+
+// 按目标时刻等待，不足一个 tick 时不等待
+static void wait_until(int64_t target_us)
+{
+    int64_t remaining_us = target_us - esp_timer_get_time();
+    TickType_t ticks = (TickType_t)(remaining_us / 1000 / portTICK_PERIOD_MS);
+    if (remaining_us > 0 && ticks > 0) {
+        vTaskDelay(ticks);
+    }
+}
+
+// 按回放倍速等待到消息的目标时刻后注入
+static void replay_message(const char *topic, int topic_len, const char *data, int data_len, int qos, int retain,
+                           int64_t delta_us, uint32_t speed, int64_t *target_us, mqtt_replay_result_t *res)
+{
+    if (speed != MQTT_REPLAY_SPEED_MAX) {
+        *target_us += delta_us / speed;
+        wait_until(*target_us);
+    }
+
+    // 没有匹配路由的消息（如捕获中的其他主题）直接跳过
+    esp_err_t err = mqtt_client_inject(topic, topic_len, data, data_len, qos, retain);
+    if (err == ESP_OK) {
+        res->messages++;
+    } else if (err == ESP_ERR_NO_MEM) {
+        res->ring_full++;
+    }
+}
+
+// 等待流水线处理完毕并计算耗时和吞吐量
+static void finish_run(int64_t start_us, mqtt_replay_result_t *res, mqtt_replay_result_t *result)
+{
+    wait_pipeline_idle();
+
+    int64_t elapsed_us = esp_timer_get_time() - start_us;
+    res->elapsed_us = (uint32_t)elapsed_us;
+    res->throughput = (elapsed_us > 0) ? (uint32_t)((int64_t)res->messages * 1000000 / elapsed_us) : 0;
+    if (result != NULL) {
+        *result = *res;
+    }
+}
+
+esp_err_t mqtt_replay_run(const char *trace, size_t len, uint32_t speed, uint32_t loops,
+                          mqtt_replay_result_t *result)
+{
+    if (trace == NULL || loops == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    mqtt_replay_result_t res = {0};
+    int64_t start_us = esp_timer_get_time();
+    int64_t target_us = start_us;
+
+    for (uint32_t loop = 0; loop < loops; loop++) {
+        const char *p = trace;
+        const char *end = trace + len;
+        while (p < end) {
+            const char *eol = memchr(p, '\n', end - p);
+            if (eol == NULL) {
+                eol = end;
+            }
+            const char *line = p;
+            const char *line_end = (eol > line && eol[-1] == '\r') ? eol - 1 : eol;
+            p = eol + 1;
+
+            if (line == line_end || *line == '#') {
+                continue;
+            }
+
+            // <毫秒数> <主题> <数据>
+            char *num_end = NULL;
+            unsigned long delta_ms = strtoul(line, &num_end, 10);
+            if (num_end == line || num_end >= line_end || *num_end != ' ') {
+                ESP_LOGW(TAG, "无效的样本行: %.*s", (int)(line_end - line), line);
+                continue;
+            }
+            const char *topic = num_end + 1;
+            const char *topic_end = memchr(topic, ' ', line_end - topic);
+            if (topic_end == NULL) {
+                topic_end = line_end;
+            }
+            const char *data = (topic_end < line_end) ? topic_end + 1 : line_end;
+
+            replay_message(topic, (int)(topic_end - topic), data, (int)(line_end - data), 0, 0,
+                           (int64_t)delta_ms * 1000, speed, &target_us, &res);
+        }
+    }
+
+    finish_run(start_us, &res, result);
+    return ESP_OK;
+}
+
+esp_err_t mqtt_replay_run_capture(const uint8_t *capture, size_t len, uint32_t speed, uint32_t loops,
+                                  mqtt_replay_result_t *result)
+{
+    if (!mqtt_capture_validate(capture, len) || loops == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    mqtt_capture_header_t header;
+    memcpy(&header, capture, sizeof(header));
+    const uint8_t *records = capture + header.header_size;
+    const uint8_t *end = records + header.data_size;
+
+    mqtt_replay_result_t res = {0};
+    int64_t start_us = esp_timer_get_time();
+    int64_t target_us = start_us;
+
+    for (uint32_t loop = 0; loop < loops; loop++) {
+        const uint8_t *p = records;
+        for (uint32_t i = 0; i < header.record_count; i++) {
+            mqtt_capture_record_t record;
+            if ((size_t)(end - p) < sizeof(record)) {
+                break;
+            }
+            memcpy(&record, p, sizeof(record));
+            p += sizeof(record);
+            if ((size_t)(end - p) < (size_t)record.topic_len + record.data_len) {
+                ESP_LOGW(TAG, "捕获数据在第 %u 条记录处截断", (unsigned int)i);
+                break;
+            }
+            const char *topic = (const char *)p;
+            const char *data = topic + record.topic_len;
+            p += record.topic_len + record.data_len;
+
+            replay_message(topic, record.topic_len, data, (int)record.data_len, record.qos, record.retain,
+                           record.delta_us, speed, &target_us, &res);
+        }
+    }
+
+    finish_run(start_us, &res, result);
+    return ESP_OK;
+}
+
+// 打印一次回放的吞吐量、占用和分配统计，随后打印延迟分位数
+static void report(const char *label, const mqtt_replay_result_t *result,
+                   const pipeline_snapshot_t *before, const pipeline_snapshot_t *after)
+{
+    ESP_LOGI(TAG, "[%s] 注入 %u 条, 丢弃 %u 条, 耗时 %u ms, 吞吐 %u 条/秒", label,
+             (unsigned int)result->messages, (unsigned int)result->ring_full,
+             (unsigned int)(result->elapsed_us / 1000), (unsigned int)result->throughput);
+
+    // 队列和环形缓冲区峰值为启动以来的累计值
+    for (int i = 0; i < EVENT_QUEUE_MAX; i++) {
+        const event_queue_stats_t *b = &before->queues[i];
+        const event_queue_stats_t *a = &after->queues[i];
+        ESP_LOGI(TAG, "[%s] 队列 %-6s 投递 %u 丢弃 %u 合并 %u 峰值 %u/%u", label, s_queue_names[i],
+                 (unsigned int)(a->posted - b->posted), (unsigned int)(a->dropped - b->dropped),
+                 (unsigned int)(a->coalesced - b->coalesced), (unsigned int)a->high_water,
+                 (unsigned int)a->capacity);
+    }
+    for (int i = 0; i < EVENT_LANE_MAX; i++) {
+        const mqtt_ring_stats_t *b = &before->rings[i];
+        const mqtt_ring_stats_t *a = &after->rings[i];
+        ESP_LOGI(TAG, "[%s] 环形缓冲区 %-11s 写入 %u 丢弃 %u 峰值 %u/%u 字节", label, s_lane_names[i],
+                 (unsigned int)(a->written - b->written), (unsigned int)(a->dropped - b->dropped),
+                 (unsigned int)a->high_water, (unsigned int)a->capacity);
+    }
+    ESP_LOGI(TAG, "[%s] 负载池 分配 %u 堆回退 %u 峰值 %u/%u", label,
+             (unsigned int)(after->pool.acquired - before->pool.acquired),
+             (unsigned int)(after->pool.heap_fallbacks - before->pool.heap_fallbacks),
+             (unsigned int)after->pool.high_water, (unsigned int)after->pool.capacity);
+    ESP_LOGI(TAG, "[%s] UI通道 发布 %u 合并 %u 应用 %u 推迟 %u 截断 %u 拷贝 %u 字节", label,
+             (unsigned int)(after->channel.published - before->channel.published),
+             (unsigned int)(after->channel.coalesced - before->channel.coalesced),
+             (unsigned int)(after->channel.applied - before->channel.applied),
+             (unsigned int)(after->channel.deferred - before->channel.deferred),
+             (unsigned int)(after->channel.truncated - before->channel.truncated),
+             (unsigned int)(after->channel.copied_bytes - before->channel.copied_bytes));
+
+    event_metrics_dump();
+}
+
+void mqtt_replay_task(void *arg)
+{
+    static const struct {
+        const char *label;
+        uint32_t speed;
+        uint32_t loops;
+    } runs[] = {
+        {"1x",  1,                     1},
+        {"10x", 10,                    1},
+        {"max", MQTT_REPLAY_SPEED_MAX, MQTT_REPLAY_MAX_SPEED_LOOPS},
+    };
+
+    size_t trace_len = mqtt_trace_end - mqtt_trace_start - 1;
+
+    // mqttcap 分区中有捕获数据时优先回放真实流量
+    const uint8_t *capture = NULL;
+    size_t capture_len = 0;
+    bool use_capture = (mqtt_capture_map(&capture, &capture_len) == ESP_OK);
+
+    // 等待UI和事件处理任务就绪
+    vTaskDelay(pdMS_TO_TICKS(3000));
+    if (use_capture) {
+        ESP_LOGI(TAG, "开始回放分区中的MQTT捕获数据 (%u 字节)", (unsigned int)capture_len);
+    } else {
+        ESP_LOGI(TAG, "开始回放MQTT流量样本 (%u 字节)", (unsigned int)trace_len);
+    }
+
+    for (size_t i = 0; i < sizeof(runs) / sizeof(runs[0]); i++) {
+        pipeline_snapshot_t before;
+        pipeline_snapshot_t after;
+        mqtt_replay_result_t result;
+
+        event_metrics_reset();
+        take_snapshot(&before);
+        if (use_capture) {
+            mqtt_replay_run_capture(capture, capture_len, runs[i].speed, runs[i].loops, &result);
+        } else {
+            mqtt_replay_run(mqtt_trace_start, trace_len, runs[i].speed, runs[i].loops, &result);
+        }
+        take_snapshot(&after);
+        report(runs[i].label, &result, &before, &after);
+    }
+
+    if (use_capture) {
+        mqtt_capture_unmap();
+    }
+
+    ESP_LOGI(TAG, "MQTT流量回放完成");
+    vTaskDelete(NULL);
+}
@@ -0,0 +1,188 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "mqtt_ring.h"
+
+static const char *TAG = "mqtt_ring";
+
+// 记录大小取该值表示缓冲区末尾剩余空间不足，读端应跳到缓冲区开头
+#define MQTT_RING_WRAP 0xFFFFFFFFu
+
+// 记录按4字节对齐
+#define MQTT_RING_ALIGN(n) (((n) + 3u) & ~3u)
+
+// 记录头部，后面紧跟 主题 '\0' 数据 '\0'
+typedef struct {
+    uint32_t size;          // 整条记录的字节数（含头部和对齐填充）
+    uint32_t recv_time;     // 接收时间戳（微秒）
+    uint32_t data_len;      // 数据长度
+    uint16_t topic_len;     // 主题长度
+    uint8_t qos;            // QoS等级
+    uint8_t retain;         // 保留标志
+} mqtt_ring_record_t;
+
+struct mqtt_ring {
+    uint8_t *buffer;        // 数据区
+    uint32_t capacity;      // 数据区字节数（2的幂）
+    uint32_t mask;          // capacity - 1
+    uint32_t head;          // 写索引，只由生产者修改，单调递增
+    uint32_t tail;          // 读索引，只由消费者修改，单调递增
+    uint32_t peek_size;     // 最近一次 peek 的记录大小
+    uint32_t written;       // 写入的消息数
+    uint32_t dropped;       // 丢弃的消息数
+    uint32_t high_water;    // 最大占用字节数
+};
+
+mqtt_ring_t *mqtt_ring_create(size_t capacity)
+{
+    if (capacity < 256 || capacity > 0x40000000u) {
+        return NULL;
+    }
+
+    uint32_t size = 1;
+    while (size < capacity) {
+        size <<= 1;
+    }
+
+    mqtt_ring_t *ring = calloc(1, sizeof(mqtt_ring_t));
+    if (ring == NULL) {
+        return NULL;
+    }
+
+    // 优先使用 PSRAM，失败时回退到内部RAM
+    ring->buffer = heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+    if (ring->buffer == NULL) {
+        ring->buffer = heap_caps_malloc(size, MALLOC_CAP_8BIT);
+    }
+    if (ring->buffer == NULL) {
+        ESP_LOGE(TAG, "分配环形缓冲区失败: %u 字节", (unsigned int)size);
+        free(ring);
+        return NULL;
+    }
+
+    ring->capacity = size;
+    ring->mask = size - 1;
+    return ring;
+}
+
+bool mqtt_ring_write(mqtt_ring_t *ring, const char *topic, int topic_len, const char *data, int data_len,
+                     int qos, int retain, uint32_t recv_time)
+{
+    if (ring == NULL || topic_len < 0 || topic_len > UINT16_MAX || data_len < 0) {
+        return false;
+    }
+
+    uint32_t record_size = MQTT_RING_ALIGN(sizeof(mqtt_ring_record_t) + topic_len + 1 + data_len + 1);
+    uint32_t head = ring->head;
+    uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    uint32_t free_space = ring->capacity - (head - tail);
+    uint32_t pos = head & ring->mask;
+    uint32_t to_end = ring->capacity - pos;
+
+    // 记录必须连续存放，末尾放不下时连同末尾剩余空间一起占用
+    uint32_t needed = (record_size <= to_end) ? record_size : to_end + record_size;
+    if (needed > free_space) {
+        ring->dropped++;
+        return false;
+    }
+
+    if (record_size > to_end) {
+        *(uint32_t *)(ring->buffer + pos) = MQTT_RING_WRAP;
+        head += to_end;
+        pos = 0;
+    }
+
+    mqtt_ring_record_t *record = (mqtt_ring_record_t *)(ring->buffer + pos);
+    record->size = record_size;
+    record->recv_time = recv_time;
+    record->data_len = (uint32_t)data_len;
+    record->topic_len = (uint16_t)topic_len;
+    record->qos = (uint8_t)qos;
+    record->retain = (uint8_t)retain;
+
+    char *payload = (char *)(record + 1);
+    if (topic_len > 0) {
+        memcpy(payload, topic, topic_len);
+    }
+    payload[topic_len] = '\0';
+    payload += topic_len + 1;
+    if (data_len > 0) {
+        memcpy(payload, data, data_len);
+    }
+    payload[data_len] = '\0';
+
+    head += record_size;
+    // 记录内容写完后再发布写索引
+    __atomic_store_n(&ring->head, head, __ATOMIC_RELEASE);
+
+    ring->written++;
+    uint32_t used = head - tail;
+    if (used > ring->high_water) {
+        ring->high_water = used;
+    }
+    return true;
+}
+
+bool mqtt_ring_peek(mqtt_ring_t *ring, mqtt_message_t *msg)
+{
+    if (ring == NULL || msg == NULL) {
+        return false;
+    }
+
+    uint32_t tail = ring->tail;
+    uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    if (tail == head) {
+        return false;
+    }
+
+    uint32_t pos = tail & ring->mask;
+    mqtt_ring_record_t *record = (mqtt_ring_record_t *)(ring->buffer + pos);
+    if (record->size == MQTT_RING_WRAP) {
+        tail += ring->capacity - pos;
+        __atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+        if (tail == head) {
+            return false;
+        }
+        record = (mqtt_ring_record_t *)ring->buffer;
+    }
+
+    char *payload = (char *)(record + 1);
+    msg->topic = payload;
+    msg->data = payload + record->topic_len + 1;
+    msg->data_len = (int)record->data_len;
+    msg->qos = record->qos;
+    msg->retain = record->retain;
+    msg->recv_time = record->recv_time;
+    ring->peek_size = record->size;
+    return true;
+}
+
+void mqtt_ring_pop(mqtt_ring_t *ring)
+{
+    if (ring == NULL || ring->peek_size == 0) {
+        return;
+    }
+    uint32_t tail = ring->tail + ring->peek_size;
+    ring->peek_size = 0;
+    // 记录处理完后再归还空间
+    __atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+}
+
+void mqtt_ring_get_stats(mqtt_ring_t *ring, mqtt_ring_stats_t *stats)
+{
+    if (ring == NULL || stats == NULL) {
+        return;
+    }
+    stats->capacity = ring->capacity;
+    stats->used = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    stats->written = ring->written;
+    stats->dropped = ring->dropped;
+    stats->high_water = ring->high_water;
+}
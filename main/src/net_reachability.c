@@ -0,0 +1,161 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_event.h"
+#include "esp_wifi.h"
+#include "net_reachability.h"
+
+static const char *TAG = "net_reach";
+
+// 请求成功后连通状态的有效期，过期后视为未知（仍放行请求，由其结果刷新）
+#define NET_REACH_TTL_MS 60000
+
+// 连续失败多少次后判定为离线
+#define NET_REACH_FAIL_THRESHOLD 3
+
+// 离线退避时间：从最小值开始，每次探测失败翻倍，不超过最大值
+#define NET_REACH_BACKOFF_MIN_MS 5000
+#define NET_REACH_BACKOFF_MAX_MS 120000
+
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static bool s_link_up = false;
+static bool s_offline = false;
+static uint32_t s_failures = 0;             // 连续失败次数
+static uint32_t s_backoff_ms = 0;           // 当前退避时间
+static int64_t s_last_ok_us = 0;            // 最近一次请求成功的时刻，0 表示尚未确认
+static int64_t s_retry_at_us = 0;           // 离线时允许下一次探测的时刻
+
+// 链路变化时清空请求结果，重新从未知状态开始
+static void reset_locked(bool link_up)
+{
+    s_link_up = link_up;
+    s_offline = false;
+    s_failures = 0;
+    s_backoff_ms = 0;
+    s_last_ok_us = 0;
+    s_retry_at_us = 0;
+}
+
+static void event_handler(void *arg, esp_event_base_t event_base, int32_t event_id, void *event_data)
+{
+    bool link_up;
+    if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
+        link_up = true;
+    } else if ((event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED) ||
+               (event_base == IP_EVENT && event_id == IP_EVENT_STA_LOST_IP)) {
+        link_up = false;
+    } else {
+        return;
+    }
+
+    portENTER_CRITICAL(&s_lock);
+    bool changed = (s_link_up != link_up);
+    reset_locked(link_up);
+    portEXIT_CRITICAL(&s_lock);
+
+    if (changed) {
+        ESP_LOGI(TAG, "链路%s", link_up ? "已连接" : "已断开");
+    }
+}
+
+esp_err_t net_reachability_init(void)
+{
+    esp_err_t err = esp_event_handler_register(WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED, &event_handler, NULL);
+    if (err == ESP_OK) {
+        err = esp_event_handler_register(IP_EVENT, IP_EVENT_STA_GOT_IP, &event_handler, NULL);
+    }
+    if (err == ESP_OK) {
+        err = esp_event_handler_register(IP_EVENT, IP_EVENT_STA_LOST_IP, &event_handler, NULL);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "注册网络事件失败: %s", esp_err_to_name(err));
+    }
+    return err;
+}
+
+bool net_reachability_allow_request(void)
+{
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&s_lock);
+    bool allow = s_link_up && (!s_offline || now >= s_retry_at_us);
+    portEXIT_CRITICAL(&s_lock);
+    return allow;
+}
+
+void net_reachability_report(bool reachable)
+{
+    int64_t now = esp_timer_get_time();
+    bool went_online = false;
+    bool went_offline = false;
+    uint32_t backoff_ms = 0;
+
+    portENTER_CRITICAL(&s_lock);
+    if (!s_link_up) {
+        // 链路已断开，迟到的结果不再有意义
+        portEXIT_CRITICAL(&s_lock);
+        return;
+    }
+    if (reachable) {
+        went_online = s_offline;
+        s_offline = false;
+        s_failures = 0;
+        s_backoff_ms = 0;
+        s_last_ok_us = now;
+    } else if (++s_failures >= NET_REACH_FAIL_THRESHOLD) {
+        // 首次进入离线用最小退避，之后每次探测失败翻倍
+        went_offline = !s_offline;
+        s_backoff_ms = went_offline ? NET_REACH_BACKOFF_MIN_MS : s_backoff_ms * 2;
+        if (s_backoff_ms > NET_REACH_BACKOFF_MAX_MS) {
+            s_backoff_ms = NET_REACH_BACKOFF_MAX_MS;
+        }
+        s_offline = true;
+        s_retry_at_us = now + (int64_t)s_backoff_ms * 1000;
+        backoff_ms = s_backoff_ms;
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    if (went_online) {
+        ESP_LOGI(TAG, "网络已恢复");
+    } else if (went_offline) {
+        ESP_LOGW(TAG, "连续 %d 次请求失败，判定离线，%u ms 后重试", NET_REACH_FAIL_THRESHOLD,
+                 (unsigned int)backoff_ms);
+    } else if (backoff_ms > 0) {
+        ESP_LOGD(TAG, "探测失败，%u ms 后重试", (unsigned int)backoff_ms);
+    }
+}
+
+net_state_t net_reachability_get_state(void)
+{
+    int64_t now = esp_timer_get_time();
+    net_state_t state;
+    portENTER_CRITICAL(&s_lock);
+    if (!s_link_up) {
+        state = NET_STATE_LINK_DOWN;
+    } else if (s_offline) {
+        state = NET_STATE_OFFLINE;
+    } else if (s_last_ok_us != 0 && (now - s_last_ok_us) < (int64_t)NET_REACH_TTL_MS * 1000) {
+        state = NET_STATE_ONLINE;
+    } else {
+        state = NET_STATE_UNKNOWN;
+    }
+    portEXIT_CRITICAL(&s_lock);
+    return state;
+}
+
+const char *net_reachability_state_name(net_state_t state)
+{
+    switch (state) {
+        case NET_STATE_LINK_DOWN: return "未连接";
+        case NET_STATE_UNKNOWN:   return "未知";
+        case NET_STATE_ONLINE:    return "在线";
+        case NET_STATE_OFFLINE:   return "离线";
+        default:                  return "?";
+    }
+}
@@ -0,0 +1,111 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include "freertos/FreeRTOS.h"
+#include "playback_clock.h"
+#include "event_metrics.h"
+
+static portMUX_TYPE s_clock_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static uint32_t s_anchor_ms = 0;        // 最近一次同步的播放位置
+static uint32_t s_anchor_us = 0;        // 同步位置对应的时间戳
+static uint32_t s_duration_ms = 0;
+static bool s_playing = false;
+static bool s_synced = false;
+static bool s_precise = false;          // 是否收到过精确位置
+
+// 按锚点推算位置（调用者持有锁）
+static uint32_t position_locked(uint32_t now_us)
+{
+    uint32_t position = s_anchor_ms;
+    // 读取时间戳后才同步的锚点可能晚于 now_us，按0处理
+    int32_t elapsed_us = (int32_t)(now_us - s_anchor_us);
+    if (s_playing && elapsed_us > 0) {
+        position += (uint32_t)elapsed_us / 1000;
+    }
+    if (s_duration_ms != 0 && position > s_duration_ms) {
+        position = s_duration_ms;
+    }
+    return position;
+}
+
+// 把锚点移到 at_us 时刻的 position_ms（调用者持有锁）
+static void anchor_locked(uint32_t position_ms, uint32_t at_us)
+{
+    s_anchor_ms = position_ms;
+    s_anchor_us = at_us;
+    s_synced = true;
+}
+
+void playback_clock_sync(uint32_t position_ms, uint32_t at_us)
+{
+    portENTER_CRITICAL(&s_clock_lock);
+    int32_t error_ms = (int32_t)(position_ms - position_locked(at_us));
+    if (!s_precise || !s_playing || error_ms > PLAYBACK_CLOCK_SNAP_MS || error_ms < -PLAYBACK_CLOCK_SNAP_MS) {
+        // 首次精确同步、暂停中或跳转：直接对齐
+        anchor_locked(position_ms, at_us);
+    } else {
+        // 小误差多为消息延迟抖动，只修正一半，避免显示来回跳动
+        anchor_locked(position_ms - error_ms / 2, at_us);
+    }
+    s_precise = true;
+    portEXIT_CRITICAL(&s_clock_lock);
+}
+
+void playback_clock_sync_coarse(uint32_t position_ms, uint32_t window_ms, uint32_t at_us)
+{
+    portENTER_CRITICAL(&s_clock_lock);
+    // 推算位置与截断区间 [position_ms, position_ms + window_ms) 的偏差在 PLAYBACK_CLOCK_SNAP_MS 以内时不调整，
+    // 精确位置消息负责细调
+    int32_t offset_ms = (int32_t)(position_locked(at_us) - position_ms);
+    if (!s_synced || offset_ms < -PLAYBACK_CLOCK_SNAP_MS || offset_ms >= (int32_t)window_ms + PLAYBACK_CLOCK_SNAP_MS) {
+        anchor_locked(position_ms + window_ms / 2, at_us);
+    }
+    portEXIT_CRITICAL(&s_clock_lock);
+}
+
+bool playback_clock_active(void)
+{
+    return s_synced && s_duration_ms != 0;
+}
+
+void playback_clock_set_duration(uint32_t duration_ms)
+{
+    portENTER_CRITICAL(&s_clock_lock);
+    s_duration_ms = duration_ms;
+    portEXIT_CRITICAL(&s_clock_lock);
+}
+
+void playback_clock_set_playing(bool playing)
+{
+    uint32_t now_us = event_metrics_now_us();
+    portENTER_CRITICAL(&s_clock_lock);
+    if (playing != s_playing) {
+        // 以切换时刻的位置作为新锚点
+        s_anchor_ms = position_locked(now_us);
+        s_anchor_us = now_us;
+        s_playing = playing;
+    }
+    portEXIT_CRITICAL(&s_clock_lock);
+}
+
+uint32_t playback_clock_duration(void)
+{
+    return s_duration_ms;
+}
+
+bool playback_clock_now(uint32_t *position_ms, uint32_t *duration_ms)
+{
+    uint32_t now_us = event_metrics_now_us();
+    portENTER_CRITICAL(&s_clock_lock);
+    bool synced = s_synced;
+    *position_ms = position_locked(now_us);
+    if (duration_ms != NULL) {
+        *duration_ms = s_duration_ms;
+    }
+    portEXIT_CRITICAL(&s_clock_lock);
+    return synced;
+}
@@ -40,6 +40,7 @@ extern const char *TAG;
 uint8_t read_brightness_from_nvs(void);
 void save_brightness_to_nvs(uint8_t brightness);
 void set_backlight_brightness(uint8_t brightness);
+void apply_backlight_brightness(uint8_t brightness);
 
 // 触摸屏初始化
 void touch_init(void)
@@ -143,10 +144,10 @@ void save_brightness_to_nvs(uint8_t brightness)
     }
 }
 
-// 设置背光亮度
-void set_backlight_brightness(uint8_t brightness)
+// 只设置PWM占空比，不写NVS，拖动亮度滑块时逐帧调用
+void apply_backlight_brightness(uint8_t brightness)
 {
-    // 确保亮度值在60-255范围内
+    // 确保亮度值在65-255范围内
     if (brightness < 65) {
         brightness = 65;
     }
@@ -154,6 +155,15 @@ void set_backlight_brightness(uint8_t brightness)
     // 设置PWM占空比
     ledc_set_duty(PWM_SPEED_MODE, PWM_CHANNEL_LED, brightness);
     ledc_update_duty(PWM_SPEED_MODE, PWM_CHANNEL_LED);
+}
+
+// 设置背光亮度
+void set_backlight_brightness(uint8_t brightness)
+{
+    if (brightness < 65) {
+        brightness = 65;
+    }
+    apply_backlight_brightness(brightness);
     
     // 保存亮度值到NVS
     save_brightness_to_nvs(brightness);
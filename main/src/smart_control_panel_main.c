@@ -22,12 +22,19 @@
 #include "esp_wifi.h"
 #include "esp_event.h"
 #include "event_system.h"
+#include "ui_update_channel.h"
+#include "event_metrics.h"
 #include "ntp_time.h"
 #include "esp_task_wdt.h"
 #include "esp32_mqtt_client.h"
+#include "mqtt_replay.h"
 #include "screens/main/main_screen.h"
 #include "album_art_manager.h"
 #include "ui_common.h"
+#include "lyrics_player.h"
+#include "playback_clock.h"
+#include "net_reachability.h"
+#include "http_async.h"
 
 esp_lcd_panel_handle_t panel_handle = NULL;
 Vernon_GT911 gt911;
@@ -61,9 +68,9 @@ const char *TAG = "smart_control_panel";
 
 
 
-// WiFi配置
-#define WIFI_SSID "root_2.4G"  // 替换为你的WiFi名称
-#define WIFI_PASS "yangyong1229"  // 替换为你的WiFi密码
+// WiFi配置，在 menuconfig 中设置，保存在不提交的 sdkconfig 中
+#define WIFI_SSID CONFIG_SMART_PANEL_WIFI_SSID
+#define WIFI_PASS CONFIG_SMART_PANEL_WIFI_PASSWORD
 
 // WiFi重连配置
 #define WIFI_MAX_RETRY 15           // 最大重连次数
@@ -150,11 +157,13 @@ static void wifi_event_handler(void* arg, esp_event_base_t event_base, int32_t e
             }
         }
         
-        // 启动MQTT客户端连接
+#if !CONFIG_SMART_PANEL_MQTT_REPLAY
+        // 启动MQTT客户端连接（回放基准测试期间由回放任务独占入站环形缓冲区）
         err = mqtt_client_start();
         if (err != ESP_OK) {
             ESP_LOGE(TAG, "启动MQTT客户端失败: %s", esp_err_to_name(err));
         }
+#endif
 
     }
 }
@@ -179,6 +188,7 @@ static void wifi_init(void)
     
     // 注册WiFi事件处理
     ESP_ERROR_CHECK(esp_event_handler_register(WIFI_EVENT, ESP_EVENT_ANY_ID, &wifi_event_handler, NULL));
+    ESP_ERROR_CHECK(net_reachability_init());
     ESP_ERROR_CHECK(esp_event_handler_register(IP_EVENT, IP_EVENT_STA_GOT_IP, &wifi_event_handler, NULL));
     
     // 配置WiFi为STA模式
@@ -188,8 +198,8 @@ static void wifi_init(void)
             .password = "",
         },
     };
-    strcpy((char*)wifi_config.sta.ssid, WIFI_SSID);
-    strcpy((char*)wifi_config.sta.password, WIFI_PASS);
+    strlcpy((char*)wifi_config.sta.ssid, WIFI_SSID, sizeof(wifi_config.sta.ssid));
+    strlcpy((char*)wifi_config.sta.password, WIFI_PASS, sizeof(wifi_config.sta.password));
     
     // 设置WiFi模式为STA
     ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
@@ -350,6 +360,183 @@ void update_time_display(void)
     lv_subject_snprintf(&weekday_subject, "%s", weekday_str);
 }
 
+// 将一条UI更新应用到对应的Subject，在LVGL任务中调用
+static void apply_ui_update(const ui_update_t *ui_update, void *ctx)
+{
+    uint32_t sub_start = event_metrics_now_us();
+    switch (ui_update->type) {
+        case UI_UPDATE_TYPE_LYRICS:
+            lv_subject_snprintf(&song_lyrics_subject, "%s", ui_update->value.str_value);
+            break;
+        case UI_UPDATE_TYPE_SONG_NAME:
+            lv_subject_snprintf(&song_name_subject, "%s", ui_update->value.str_value);
+            break;
+        case UI_UPDATE_TYPE_ARTIST:
+            lv_subject_snprintf(&song_artist_subject, "%s", ui_update->value.str_value);
+            break;
+        case UI_UPDATE_TYPE_PLAY_PROGRESS:
+            lv_subject_set_int(&play_progress_subject, ui_update->value.int_value);
+            break;
+        case UI_UPDATE_TYPE_VOLUME:
+            // 拖动中回传的是之前发出的值，应用会让滑块回跳
+            if (!main_screen_volume_busy()) {
+                lv_subject_set_int(&volume_subject_value, ui_update->value.int_value);
+            }
+            break;
+        case UI_UPDATE_TYPE_SONG_TIME:
+            lv_subject_snprintf(&song_time_subject, "%s", ui_update->value.str_value);
+            break;
+        case UI_UPDATE_TYPE_POWER:
+            update_power_display(ui_update->value.int_value / 10.0);
+            break;
+        case UI_UPDATE_TYPE_DAILY_ENERGY:
+            lv_subject_snprintf(&daily_energy_subject, "%s", ui_update->value.str_value);
+            break;
+        case UI_UPDATE_TYPE_MONTHLY_ENERGY:
+            lv_subject_snprintf(&monthly_energy_subject, "%s", ui_update->value.str_value);
+            break;
+        case UI_UPDATE_TYPE_ENERGY:
+            // 处理原始能耗（如果需要）
+            break;
+        case UI_UPDATE_TYPE_WEATHER_DESC:
+            lv_subject_snprintf(&weather_desc_subject, "%s", ui_update->value.str_value);
+            break;
+        case UI_UPDATE_TYPE_WEATHER_TEMP:
+            lv_subject_snprintf(&weather_temp_subject, "%s", ui_update->value.str_value);
+            break;
+        case UI_UPDATE_TYPE_WEATHER_HUM:
+            lv_subject_snprintf(&weather_hum_subject, "%s", ui_update->value.str_value);
+            break;
+        case UI_UPDATE_TYPE_INDOOR_TEMP:
+            lv_subject_snprintf(&indoor_temp_subject, "%s", ui_update->value.str_value);
+            break;
+        case UI_UPDATE_TYPE_INDOOR_HUM:
+            lv_subject_snprintf(&indoor_hum_subject, "%s", ui_update->value.str_value);
+            break;
+        case UI_UPDATE_TYPE_PLAY_STATE:
+            {
+                lv_obj_t *play_btn = lv_obj_find_by_name(lv_screen_active(), "play_btn");
+                if (play_btn) {
+                    ui_set_icon(play_btn, ui_update->value.int_value ? ICON_PAUSE : ICON_PLAY);
+                }
+            }
+            break;
+        case UI_UPDATE_TYPE_ALBUM_ART:
+            ESP_LOGI(TAG, "处理 UI 封面更新事件，数据指针: %p", ui_update->value.ptr_value);
+            if (ui_update->value.ptr_value != NULL) {
+                cover_img_dsc.header.cf = LV_COLOR_FORMAT_RGB565;
+                cover_img_dsc.header.w = 100;
+                cover_img_dsc.header.h = 100;
+                cover_img_dsc.header.stride = 100 * 2;
+                cover_img_dsc.data_size = 100 * 100 * 2;
+                cover_img_dsc.data = (const uint8_t *)ui_update->value.ptr_value;
+                // 设为 NULL 再设回 &cover_img_dsc，强制触发 LVGL 通知
+                lv_subject_set_pointer(&cover_img_subject, NULL);
+                lv_subject_set_pointer(&cover_img_subject, &cover_img_dsc);
+            } else {
+                lv_subject_set_pointer(&cover_img_subject, NULL);
+            }
+            break;
+        case UI_UPDATE_TYPE_SWITCH_STATE:
+            {
+                int index = (ui_update->value.int_value >> 8) & 0xFF;
+                int state = ui_update->value.int_value & 0xFF;
+                switch (index) {
+                    case 1: lv_subject_set_int(&switch_1_state, state); break;
+                    case 2: lv_subject_set_int(&switch_2_state, state); break;
+                    case 3: lv_subject_set_int(&switch_3_state, state); break;
+                    case 4: lv_subject_set_int(&switch_4_state, state); break;
+                    default: break;
+                }
+            }
+            break;
+        default:
+            break;
+    }
+    uint32_t sub_end = event_metrics_now_us();
+    event_metrics_record_ui(ui_update->type, EVENT_METRIC_HANDLER, sub_end - sub_start);
+    event_metrics_record_ui(ui_update->type, EVENT_METRIC_END_TO_END, sub_end - ui_update->origin_time);
+    if (sub_end - sub_start > 50000) {
+        ESP_LOGW(TAG, "UI更新类型 %d 耗时过长: %u ms", ui_update->type, (unsigned int)((sub_end - sub_start) / 1000));
+    }
+}
+
+// 每帧处理批量通道的时间预算（微秒），交互通道不受此限制
+#define LVGL_BULK_BUDGET_US 8000
+
+// 进度弧的最小刷新步长，约为弧线周长上的一个像素（直径110像素）
+#define LOCAL_PROGRESS_MIN_STEP (PLAYBACK_PROGRESS_MAX / 345)
+
+// 按本地播放时钟刷新进度弧和 "mm:ss / mm:ss"，在 LVGL 任务中每帧调用
+// 时长与位置来自同一次 playback_clock_now，事件处理任务随时可能把时长清零
+static void update_local_progress(uint32_t position_ms, uint32_t duration_ms)
+{
+    static int32_t last_progress = -1;
+    static uint32_t last_second = UINT32_MAX;
+    static uint32_t last_duration = 0;
+
+    if (duration_ms == 0) {
+        return;
+    }
+
+    int32_t progress = (int32_t)((uint64_t)position_ms * PLAYBACK_PROGRESS_MAX / duration_ms);
+    int32_t step = progress - last_progress;
+    if (last_progress < 0 || step >= LOCAL_PROGRESS_MIN_STEP || step <= -LOCAL_PROGRESS_MIN_STEP ||
+        (progress == PLAYBACK_PROGRESS_MAX && last_progress != PLAYBACK_PROGRESS_MAX)) {
+        lv_subject_set_int(&play_progress_subject, progress);
+        last_progress = progress;
+    }
+
+    uint32_t second = position_ms / 1000;
+    if (second != last_second || duration_ms != last_duration) {
+        uint32_t total = duration_ms / 1000;
+        lv_subject_snprintf(&song_time_subject, "%02u:%02u / %02u:%02u",
+                            (unsigned int)(second / 60), (unsigned int)(second % 60),
+                            (unsigned int)(total / 60), (unsigned int)(total % 60));
+        last_second = second;
+        last_duration = duration_ms;
+    }
+}
+
+// XML加载完成事件
+static void on_xml_loaded_event(const event_t *event, void *ctx)
+{
+    ESP_LOGI(TAG, "LVGL任务收到XML加载完成事件，耗时: %u ms",
+             (unsigned int)((event_metrics_now_us() - event->send_time) / 1000));
+    // 调用XML加载完成回调函数
+    on_xml_loaded((xml_load_result_t *)event->data);
+}
+
+// NTP时间更新事件
+static void on_ntp_time_updated_event(const event_t *event, void *ctx)
+{
+    ESP_LOGI(TAG, "LVGL任务收到NTP时间更新事件，耗时: %u ms",
+             (unsigned int)((event_metrics_now_us() - event->send_time) / 1000));
+    // 更新时间显示
+    update_time_display();
+}
+
+// 处理UI事件队列中的事件
+static void handle_ui_event(event_t *event)
+{
+    // 在处理大事件（如 XML 加载）前后重置看门狗
+    esp_task_wdt_reset();
+
+    // 计算事件从发送到接收的耗时
+    uint32_t receive_time = event_metrics_now_us();
+    event_metrics_record_event(event->type, EVENT_METRIC_QUEUE_WAIT, receive_time - event->send_time);
+    
+    // 投递给所有订阅者，回调在 LVGL 任务中执行
+    event_system_dispatch(event);
+    event_metrics_record_event(event->type, EVENT_METRIC_HANDLER, event_metrics_now_us() - receive_time);
+    
+    // 归还事件负载
+    event_system_release(event);
+    
+    // 处理完一个事件后喂狗
+    esp_task_wdt_reset();
+}
+
 // LVGL任务函数，用于处理LVGL的主循环
 static void lvgl_task(void *arg)
 {
@@ -364,137 +551,48 @@ static void lvgl_task(void *arg)
     // 创建主屏幕
     ui_create_screen(SCREEN_MAIN);
     
+    // 订阅UI事件，回调在本任务中执行
+    event_subscriber_t subscriber = {.delivery = EVENT_DELIVERY_CALLBACK};
+    subscriber.callback = on_xml_loaded_event;
+    event_system_subscribe(EVENT_TYPE_XML_LOADED, &subscriber, NULL);
+    subscriber.callback = on_ntp_time_updated_event;
+    event_system_subscribe(EVENT_TYPE_NTP_TIME_UPDATED, &subscriber, NULL);
+    
     // 将当前任务订阅到看门狗
     esp_task_wdt_add(NULL);
     
     // LVGL主循环
     uint32_t time_update_count = 0;
+    static char lyrics_buf[UI_CHANNEL_STR_MAX];
     while (1) {
-        // 检查UI事件队列中是否有事件
+        uint32_t frame_start = event_metrics_now_us();
         event_t event;
-        while (xQueueReceive(g_ui_event_queue, &event, 0) == pdPASS) {
-            // 在处理大事件（如 XML 加载）前后重置看门狗
-            esp_task_wdt_reset();
-
-            // 计算事件从发送到接收的耗时
-            TickType_t receive_time = xTaskGetTickCount();
-            TickType_t delay_ticks = receive_time - event.send_time;
-            uint32_t delay_ms = pdTICKS_TO_MS(delay_ticks);
-            
-            if (event.type == EVENT_TYPE_XML_LOADED) {
-                ESP_LOGI(TAG, "LVGL任务收到XML加载完成事件，耗时: %u ms", delay_ms);
-                // 调用XML加载完成回调函数
-                on_xml_loaded((xml_load_result_t *)event.data);
-                // 释放事件数据内存
-                free(event.data);
-            } else if (event.type == EVENT_TYPE_NTP_TIME_UPDATED) {
-                ESP_LOGI(TAG, "LVGL任务收到NTP时间更新事件，耗时: %u ms", delay_ms);
-                // 更新时间显示
-                update_time_display();
-                // 释放事件数据内存
-                if (event.data != NULL) {
-                    free(event.data);
-                }
-            } else if (event.type == EVENT_TYPE_UI_UPDATE) {
-                ESP_LOGI(TAG, "LVGL任务收到UI更新事件，耗时: %u ms", delay_ms);
-                // 处理UI更新事件
-                ui_update_t *ui_update = (ui_update_t *)event.data;
-                uint32_t sub_start = esp_log_timestamp();
-                switch (ui_update->type) {
-                    case UI_UPDATE_TYPE_LYRICS:
-                        lv_subject_snprintf(&song_lyrics_subject, "%s", ui_update->value.str_value);
-                        break;
-                    case UI_UPDATE_TYPE_SONG_NAME:
-                        lv_subject_snprintf(&song_name_subject, "%s", ui_update->value.str_value);
-                        break;
-                    case UI_UPDATE_TYPE_ARTIST:
-                        lv_subject_snprintf(&song_artist_subject, "%s", ui_update->value.str_value);
-                        break;
-                    case UI_UPDATE_TYPE_PLAY_PROGRESS:
-                        lv_subject_set_int(&play_progress_subject, ui_update->value.int_value);
-                        break;
-                    case UI_UPDATE_TYPE_VOLUME:
-                        lv_subject_set_int(&volume_subject_value, ui_update->value.int_value);
-                        break;
-                    case UI_UPDATE_TYPE_SONG_TIME:
-                        lv_subject_snprintf(&song_time_subject, "%s", ui_update->value.str_value);
-                        break;
-                    case UI_UPDATE_TYPE_POWER:
-                        update_power_display(ui_update->value.int_value / 10.0);
-                        break;
-                    case UI_UPDATE_TYPE_DAILY_ENERGY:
-                        lv_subject_snprintf(&daily_energy_subject, "%s", ui_update->value.str_value);
-                        break;
-                    case UI_UPDATE_TYPE_MONTHLY_ENERGY:
-                        lv_subject_snprintf(&monthly_energy_subject, "%s", ui_update->value.str_value);
-                        break;
-                    case UI_UPDATE_TYPE_ENERGY:
-                        // 处理原始能耗（如果需要）
-                        break;
-                    case UI_UPDATE_TYPE_WEATHER_DESC:
-                        lv_subject_snprintf(&weather_desc_subject, "%s", ui_update->value.str_value);
-                        break;
-                    case UI_UPDATE_TYPE_WEATHER_TEMP:
-                        lv_subject_snprintf(&weather_temp_subject, "%s", ui_update->value.str_value);
-                        break;
-                    case UI_UPDATE_TYPE_WEATHER_HUM:
-                        lv_subject_snprintf(&weather_hum_subject, "%s", ui_update->value.str_value);
-                        break;
-                    case UI_UPDATE_TYPE_INDOOR_TEMP:
-                        lv_subject_snprintf(&indoor_temp_subject, "%s", ui_update->value.str_value);
-                        break;
-                    case UI_UPDATE_TYPE_INDOOR_HUM:
-                        lv_subject_snprintf(&indoor_hum_subject, "%s", ui_update->value.str_value);
-                        break;
-                    case UI_UPDATE_TYPE_PLAY_STATE:
-                        {
-                            lv_obj_t *play_btn = lv_obj_find_by_name(lv_screen_active(), "play_btn");
-                            if (play_btn) {
-                                ui_set_icon(play_btn, ui_update->value.int_value ? ICON_PAUSE : ICON_PLAY);
-                            }
-                        }
-                        break;
-                    case UI_UPDATE_TYPE_ALBUM_ART:
-                        ESP_LOGI(TAG, "处理 UI 封面更新事件，数据指针: %p", ui_update->value.ptr_value);
-                        if (ui_update->value.ptr_value != NULL) {
-                            cover_img_dsc.header.cf = LV_COLOR_FORMAT_RGB565;
-                            cover_img_dsc.header.w = 100;
-                            cover_img_dsc.header.h = 100;
-                            cover_img_dsc.header.stride = 100 * 2;
-                            cover_img_dsc.data_size = 100 * 100 * 2;
-                            cover_img_dsc.data = (const uint8_t *)ui_update->value.ptr_value;
-                            // 设为 NULL 再设回 &cover_img_dsc，强制触发 LVGL 通知
-                            lv_subject_set_pointer(&cover_img_subject, NULL);
-                            lv_subject_set_pointer(&cover_img_subject, &cover_img_dsc);
-                        } else {
-                            lv_subject_set_pointer(&cover_img_subject, NULL);
-                        }
-                        break;
-                    case UI_UPDATE_TYPE_SWITCH_STATE:
-                        {
-                            int index = (ui_update->value.int_value >> 8) & 0xFF;
-                            int state = ui_update->value.int_value & 0xFF;
-                            switch (index) {
-                                case 1: lv_subject_set_int(&switch_1_state, state); break;
-                                case 2: lv_subject_set_int(&switch_2_state, state); break;
-                                case 3: lv_subject_set_int(&switch_3_state, state); break;
-                                case 4: lv_subject_set_int(&switch_4_state, state); break;
-                                default: break;
-                            }
-                        }
-                        break;
-                    default:
-                        break;
-                }
-                uint32_t sub_end = esp_log_timestamp();
-                if (sub_end - sub_start > 50) {
-                    ESP_LOGW(TAG, "UI更新类型 %d 耗时过长: %u ms", ui_update->type, (unsigned int)(sub_end - sub_start));
-                }
-                // 释放事件数据内存
-                free(event.data);
+        
+        // 1. 交互通道的UI事件全部处理
+        while (event_system_receive_lane(EVENT_QUEUE_UI, EVENT_LANE_INTERACTIVE, &event, 0) == ESP_OK) {
+            handle_ui_event(&event);
+        }
+        
+        // 2. UI更新通道：交互槽位全部应用，批量槽位在预算内应用
+        ui_update_channel_drain(apply_ui_update, NULL, LVGL_BULK_BUDGET_US);
+        esp_task_wdt_reset();
+        
+        // 本地播放时钟：逐帧推算进度和歌词，只在显示内容变化时刷新
+        uint32_t position_ms;
+        uint32_t duration_ms;
+        if (playback_clock_now(&position_ms, &duration_ms)) {
+            update_local_progress(position_ms, duration_ms);
+            if (lyrics_player_poll(position_ms, lyrics_buf, sizeof(lyrics_buf))) {
+                lv_subject_snprintf(&song_lyrics_subject, "%s", lyrics_buf);
+            }
+        }
+        
+        // 3. 批量通道的UI事件在本帧剩余预算内处理，每帧至少处理一个
+        while (event_system_receive_lane(EVENT_QUEUE_UI, EVENT_LANE_BULK, &event, 0) == ESP_OK) {
+            handle_ui_event(&event);
+            if (event_metrics_now_us() - frame_start >= LVGL_BULK_BUDGET_US) {
+                break;
             }
-            // 处理完一个事件后喂狗
-            esp_task_wdt_reset();
         }
         
         // 定期更新时间显示，每秒更新一次
@@ -543,6 +641,9 @@ void app_main(void)
     // 初始化事件系统
     event_system_init();
     
+    // 启动异步HTTP工作任务，完成回调经UI事件队列在LVGL任务中执行
+    ESP_ERROR_CHECK(http_async_init());
+    
     // 初始化MQTT客户端
     mqtt_client_init();
     
@@ -556,6 +657,10 @@ void app_main(void)
     
     xTaskCreate(event_system_task, "event_system_task", 8192, NULL, 5, NULL);
     xTaskCreate(ha_monitor_task, "ha_monitor_task", 8192, NULL, 4, NULL);
+
+#if CONFIG_SMART_PANEL_MQTT_REPLAY
+    xTaskCreate(mqtt_replay_task, "mqtt_replay_task", 4096, NULL, 4, NULL);
+#endif
     
     ESP_LOGI(TAG, "应用主函数完成，任务正在运行");
     
@@ -0,0 +1,312 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "ui_update_channel.h"
+#include "event_metrics.h"
+
+static const char *TAG = "ui_channel";
+
+_Static_assert(UI_CHANNEL_SLOT_COUNT <= 32, "脏位图为 uint32_t，槽位数不能超过32");
+
+// 每个槽位保存最近一次发布的值，字符串值指向字符串池
+static ui_update_t s_slots[UI_CHANNEL_SLOT_COUNT];
+
+// 字符串池总字节数
+#define UI_CHANNEL_STR_POOL_SIZE 3072
+
+// 每种类型的字符串缓冲区数：槽位引用的一个、LVGL任务正在应用的一个、发布者正在写入的一个，
+// 拷贝都在锁外进行，锁内只切换缓冲区序号和脏位
+#define UI_CHANNEL_STR_BUFFERS 3
+
+// 各类型字符串容量（含 '\0'），按界面实际显示的内容估算，0 表示该类型不携带字符串
+// 中文按UTF-8每字3字节计
+static const uint16_t s_str_capacity[UI_UPDATE_TYPE_MAX] = {
+    [UI_UPDATE_TYPE_LYRICS]         = 256,
+    [UI_UPDATE_TYPE_SONG_NAME]      = 128,
+    [UI_UPDATE_TYPE_ARTIST]         = 128,
+    [UI_UPDATE_TYPE_SONG_TIME]      = 32,
+    [UI_UPDATE_TYPE_ENERGY]         = 64,
+    [UI_UPDATE_TYPE_DAILY_ENERGY]   = 64,
+    [UI_UPDATE_TYPE_MONTHLY_ENERGY] = 64,
+    [UI_UPDATE_TYPE_WEATHER_DESC]   = 32,
+    [UI_UPDATE_TYPE_WEATHER_TEMP]   = 16,
+    [UI_UPDATE_TYPE_WEATHER_HUM]    = 16,
+    [UI_UPDATE_TYPE_INDOOR_TEMP]    = 24,
+    [UI_UPDATE_TYPE_INDOOR_HUM]     = 16,
+};
+
+// 字符串池，每种类型占用一段固定区域，区域内按容量分为 UI_CHANNEL_STR_BUFFERS 个缓冲区
+static char s_str_pool[UI_CHANNEL_STR_POOL_SIZE];
+static char *s_str_slots[UI_UPDATE_TYPE_MAX];
+
+// 槽位当前引用的缓冲区序号
+static uint8_t s_str_front[UI_UPDATE_TYPE_MAX];
+
+// 正在锁外写入或应用的缓冲区位图，置位的缓冲区不能再分给发布者
+static uint8_t s_str_busy[UI_UPDATE_TYPE_MAX];
+
+// 脏位图，置1表示槽位有尚未应用的新值
+static uint32_t s_dirty_mask = 0;
+
+// 交互通道的槽位：播放状态、音量和所有开关
+#define UI_CHANNEL_INTERACTIVE_MASK ((1u << UI_UPDATE_TYPE_PLAY_STATE) | \
+                                     (1u << UI_UPDATE_TYPE_VOLUME) | \
+                                     (((1u << UI_CHANNEL_SWITCH_COUNT) - 1) << UI_UPDATE_TYPE_MAX))
+
+// 批量槽位轮转起点，避免预算不足时总是推迟同一批槽位
+static int s_bulk_cursor = 0;
+
+// 统计信息
+static uint32_t s_published = 0;
+static uint32_t s_coalesced = 0;
+static uint32_t s_applied = 0;
+static uint32_t s_deferred = 0;
+static uint32_t s_truncated = 0;
+static uint32_t s_copied_bytes = 0;
+
+// 保护槽位和脏位图的自旋锁
+static portMUX_TYPE s_channel_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// 计算UI更新对应的槽位
+static int slot_index(const ui_update_t *update)
+{
+    if (update->type == UI_UPDATE_TYPE_SWITCH_STATE) {
+        int index = (update->value.int_value >> 8) & 0xFF;
+        if (index < 1 || index > UI_CHANNEL_SWITCH_COUNT) {
+            return -1;
+        }
+        return UI_UPDATE_TYPE_MAX + index - 1;
+    }
+    return (int)update->type;
+}
+
+esp_err_t ui_update_channel_init(void)
+{
+    size_t offset = 0;
+    for (int type = 0; type < UI_UPDATE_TYPE_MAX; type++) {
+        size_t size = (size_t)s_str_capacity[type] * UI_CHANNEL_STR_BUFFERS;
+        if (s_str_capacity[type] > UI_CHANNEL_STR_MAX || offset + size > sizeof(s_str_pool)) {
+            ESP_LOGE(TAG, "字符串池容量不足: 类型 %d", type);
+            return ESP_ERR_NO_MEM;
+        }
+        s_str_slots[type] = (s_str_capacity[type] > 0) ? &s_str_pool[offset] : NULL;
+        s_str_front[type] = 0;
+        s_str_busy[type] = 0;
+        offset += size;
+    }
+    ESP_LOGI(TAG, "字符串池已划分 %u/%u 字节", (unsigned int)offset, (unsigned int)sizeof(s_str_pool));
+    return ESP_OK;
+}
+
+// 类型的第 index 个字符串缓冲区
+static char *str_buffer(ui_update_type_t type, int index)
+{
+    return s_str_slots[type] + (size_t)s_str_capacity[type] * index;
+}
+
+// 分配一个既不被槽位引用、也不在锁外使用的缓冲区，须在锁内调用；没有时返回 -1
+static int claim_str_buffer(ui_update_type_t type)
+{
+    for (int i = 0; i < UI_CHANNEL_STR_BUFFERS; i++) {
+        if (i != s_str_front[type] && !(s_str_busy[type] & (1u << i))) {
+            s_str_busy[type] |= (1u << i);
+            return i;
+        }
+    }
+    return -1;
+}
+
+// 计算字符串拷入池中的长度，超出容量时退到UTF-8字符边界
+static size_t fit_str_len(const char *str, size_t len, size_t capacity)
+{
+    if (len < capacity) {
+        return len;
+    }
+    len = capacity - 1;
+    while (len > 0 && ((uint8_t)str[len] & 0xC0) == 0x80) {
+        len--;
+    }
+    return len;
+}
+
+esp_err_t ui_update_channel_publish(const ui_update_t *update)
+{
+    if (update == NULL || update->type >= UI_UPDATE_TYPE_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    size_t str_len = 0;
+    bool truncated = false;
+    if (update->tag == UI_VALUE_STR) {
+        if (s_str_slots[update->type] == NULL || update->value.str_value == NULL) {
+            ESP_LOGE(TAG, "UI更新类型 %d 不接受字符串", update->type);
+            return ESP_ERR_INVALID_ARG;
+        }
+        str_len = fit_str_len(update->value.str_value, update->len, s_str_capacity[update->type]);
+        truncated = (str_len != update->len);
+    }
+
+    int slot = slot_index(update);
+    if (slot < 0) {
+        ESP_LOGE(TAG, "无效的开关索引: %d", (update->value.int_value >> 8) & 0xFF);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint32_t now = event_metrics_now_us();
+
+    int buffer = -1;
+    if (update->tag == UI_VALUE_STR) {
+        // 先在锁外把字符串拷入一个空闲缓冲区，发布时只切换槽位引用的缓冲区
+        portENTER_CRITICAL(&s_channel_lock);
+        buffer = claim_str_buffer(update->type);
+        if (buffer < 0) {
+            // 同一类型的另外两次发布正在进行：本次视为在它们之前发布、已被覆盖
+            s_coalesced++;
+            s_published++;
+            portEXIT_CRITICAL(&s_channel_lock);
+            return ESP_OK;
+        }
+        portEXIT_CRITICAL(&s_channel_lock);
+
+        char *dst = str_buffer(update->type, buffer);
+        memcpy(dst, update->value.str_value, str_len);
+        dst[str_len] = '\0';
+    }
+
+    portENTER_CRITICAL(&s_channel_lock);
+    if (s_dirty_mask & (1u << slot)) {
+        s_coalesced++;
+    }
+    s_slots[slot] = *update;
+    if (s_slots[slot].origin_time == 0) {
+        s_slots[slot].origin_time = now;
+    }
+    if (buffer >= 0) {
+        // 槽位改为引用新缓冲区，原来引用的缓冲区可以分给下一次发布
+        s_str_busy[update->type] &= ~(1u << buffer);
+        s_str_front[update->type] = (uint8_t)buffer;
+        s_slots[slot].value.str_value = str_buffer(update->type, buffer);
+        s_slots[slot].len = (uint16_t)str_len;
+        s_copied_bytes += str_len + 1;
+        if (truncated) {
+            s_truncated++;
+        }
+    }
+    s_copied_bytes += sizeof(ui_update_t);
+    s_dirty_mask |= (1u << slot);
+    s_published++;
+    portEXIT_CRITICAL(&s_channel_lock);
+
+    return ESP_OK;
+}
+
+event_lane_t ui_update_channel_lane(ui_update_type_t type)
+{
+    if (type == UI_UPDATE_TYPE_SWITCH_STATE) {
+        return EVENT_LANE_INTERACTIVE;
+    }
+    if (type < UI_UPDATE_TYPE_MAX && (UI_CHANNEL_INTERACTIVE_MASK & (1u << type))) {
+        return EVENT_LANE_INTERACTIVE;
+    }
+    return EVENT_LANE_BULK;
+}
+
+// 取出槽位中的值并清除脏位，在锁外应用
+static void apply_slot(int slot, ui_update_apply_cb_t apply, void *ctx)
+{
+    ui_update_t update;
+    int buffer = -1;
+
+    portENTER_CRITICAL(&s_channel_lock);
+    update = s_slots[slot];
+    if (update.tag == UI_VALUE_STR) {
+        // 应用期间占用槽位引用的缓冲区，新的发布写入其他缓冲区，字符串不必拷贝
+        buffer = s_str_front[update.type];
+        s_str_busy[update.type] |= (1u << buffer);
+    }
+    s_copied_bytes += sizeof(ui_update_t);
+    s_dirty_mask &= ~(1u << slot);
+    portEXIT_CRITICAL(&s_channel_lock);
+
+    apply(&update, ctx);
+
+    if (buffer >= 0) {
+        portENTER_CRITICAL(&s_channel_lock);
+        s_str_busy[update.type] &= ~(1u << buffer);
+        portEXIT_CRITICAL(&s_channel_lock);
+    }
+}
+
+uint32_t ui_update_channel_drain(ui_update_apply_cb_t apply, void *ctx, uint32_t bulk_budget_us)
+{
+    if (apply == NULL) {
+        return 0;
+    }
+
+    // 只处理进入本帧时已经置位的槽位，处理期间新到的值留到下一帧
+    portENTER_CRITICAL(&s_channel_lock);
+    uint32_t pending = s_dirty_mask;
+    portEXIT_CRITICAL(&s_channel_lock);
+
+    uint32_t count = 0;
+
+    // 交互通道：全部应用
+    uint32_t interactive = pending & UI_CHANNEL_INTERACTIVE_MASK;
+    while (interactive != 0) {
+        int slot = __builtin_ctz(interactive);
+        interactive &= ~(1u << slot);
+        apply_slot(slot, apply, ctx);
+        count++;
+    }
+
+    // 批量通道：从上次中断处轮流应用，超出预算后留到下一帧
+    uint32_t bulk = pending & ~UI_CHANNEL_INTERACTIVE_MASK;
+    uint32_t deferred = 0;
+    uint32_t start = event_metrics_now_us();
+    bool first = true;
+    for (int i = 0; i < UI_CHANNEL_SLOT_COUNT && bulk != 0; i++) {
+        int slot = (s_bulk_cursor + i) % UI_CHANNEL_SLOT_COUNT;
+        if (!(bulk & (1u << slot))) {
+            continue;
+        }
+        if (!first && event_metrics_now_us() - start >= bulk_budget_us) {
+            s_bulk_cursor = slot;
+            deferred = __builtin_popcount(bulk);
+            break;
+        }
+        bulk &= ~(1u << slot);
+        apply_slot(slot, apply, ctx);
+        count++;
+        first = false;
+    }
+
+    if (count > 0 || deferred > 0) {
+        portENTER_CRITICAL(&s_channel_lock);
+        s_applied += count;
+        s_deferred += deferred;
+        portEXIT_CRITICAL(&s_channel_lock);
+    }
+    return count;
+}
+
+void ui_update_channel_get_stats(ui_update_channel_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+
+    portENTER_CRITICAL(&s_channel_lock);
+    stats->published = s_published;
+    stats->coalesced = s_coalesced;
+    stats->applied = s_applied;
+    stats->deferred = s_deferred;
+    stats->truncated = s_truncated;
+    stats->copied_bytes = s_copied_bytes;
+    portEXIT_CRITICAL(&s_channel_lock);
+}
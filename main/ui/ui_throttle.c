@@ -0,0 +1,105 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include "ui_throttle.h"
+
+static void send_now(ui_throttle_t *throttle)
+{
+    throttle->has_pending = false;
+    if (throttle->timer != NULL) {
+        lv_timer_pause(throttle->timer);
+    }
+    if (throttle->has_sent && throttle->pending == throttle->last_sent) {
+        return;
+    }
+    throttle->last_sent = throttle->pending;
+    throttle->has_sent = true;
+    throttle->last_send_tick = lv_tick_get();
+    throttle->send(throttle->pending, throttle->ctx);
+}
+
+// 间隔到期：发送期间累积的最新值
+static void throttle_timer_cb(lv_timer_t *timer)
+{
+    ui_throttle_t *throttle = lv_timer_get_user_data(timer);
+    if (throttle->has_pending) {
+        send_now(throttle);
+    } else {
+        lv_timer_pause(timer);
+    }
+}
+
+void ui_throttle_init(ui_throttle_t *throttle, uint32_t max_per_second, ui_throttle_send_cb_t send, void *ctx)
+{
+    // 重新加载界面时会再次初始化，先删除上次的定时器
+    if (throttle->timer != NULL) {
+        lv_timer_delete(throttle->timer);
+    }
+    *throttle = (ui_throttle_t){
+        .interval_ms = (max_per_second > 0) ? 1000 / max_per_second : 0,
+        .send = send,
+        .ctx = ctx,
+    };
+}
+
+void ui_throttle_update(ui_throttle_t *throttle, int32_t value)
+{
+    throttle->pending = value;
+    throttle->has_pending = true;
+    throttle->dragging = true;
+
+    uint32_t elapsed = lv_tick_elaps(throttle->last_send_tick);
+    if (!throttle->has_sent || elapsed >= throttle->interval_ms) {
+        send_now(throttle);
+        return;
+    }
+
+    // 定时器已在等待时只替换待发送的值
+    if (throttle->timer == NULL) {
+        throttle->timer = lv_timer_create(throttle_timer_cb, throttle->interval_ms, throttle);
+        if (throttle->timer == NULL) {
+            return;
+        }
+    } else if (!lv_timer_get_paused(throttle->timer)) {
+        return;
+    }
+    lv_timer_set_period(throttle->timer, throttle->interval_ms - elapsed);
+    lv_timer_reset(throttle->timer);
+    lv_timer_resume(throttle->timer);
+}
+
+void ui_throttle_finish(ui_throttle_t *throttle, int32_t value)
+{
+    throttle->pending = value;
+    throttle->dragging = false;
+    throttle->release_tick = lv_tick_get();
+    send_now(throttle);
+}
+
+bool ui_throttle_busy(const ui_throttle_t *throttle)
+{
+    return throttle->dragging || (throttle->has_sent && lv_tick_elaps(throttle->release_tick) < UI_THROTTLE_ECHO_GUARD_MS);
+}
+
+static void slider_value_changed_cb(lv_event_t *e)
+{
+    ui_throttle_t *throttle = lv_event_get_user_data(e);
+    lv_obj_t *slider = lv_event_get_target(e);
+    ui_throttle_update(throttle, lv_slider_get_value(slider));
+}
+
+static void slider_released_cb(lv_event_t *e)
+{
+    ui_throttle_t *throttle = lv_event_get_user_data(e);
+    lv_obj_t *slider = lv_event_get_target(e);
+    ui_throttle_finish(throttle, lv_slider_get_value(slider));
+}
+
+void ui_throttle_attach_slider(ui_throttle_t *throttle, lv_obj_t *slider)
+{
+    lv_obj_add_event_cb(slider, slider_value_changed_cb, LV_EVENT_VALUE_CHANGED, throttle);
+    lv_obj_add_event_cb(slider, slider_released_cb, LV_EVENT_RELEASED, throttle);
+}
@@ -0,0 +1,73 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#ifndef UI_THROTTLE_H
+#define UI_THROTTLE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "lvgl.h"
+
+// 限速发送回调，在 LVGL 任务中调用，不应阻塞（MQTT 用 mqtt_client_enqueue）
+typedef void (*ui_throttle_send_cb_t)(int32_t value, void *ctx);
+
+// 限速、最新值优先的滑块输出：拖动中每秒最多发送 N 次，未发出就被新值覆盖的中间值直接丢弃，
+// 松开时总是发送最终值。只在 LVGL 任务中使用，无需加锁。
+typedef struct {
+    uint32_t interval_ms;           // 两次发送的最小间隔
+    ui_throttle_send_cb_t send;     // 发送回调
+    void *ctx;                      // 回调上下文
+    lv_timer_t *timer;              // 间隔未到时延后发送的定时器
+    uint32_t last_send_tick;        // 上次发送时刻（lv_tick）
+    uint32_t release_tick;          // 松开时刻（lv_tick）
+    int32_t pending;                // 待发送的最新值
+    int32_t last_sent;              // 上次发送的值
+    bool has_pending;
+    bool has_sent;
+    bool dragging;                  // 是否正在拖动
+} ui_throttle_t;
+
+// 松开后仍视为忙碌的时间，期间应忽略设备回传的旧状态，避免滑块回跳
+#define UI_THROTTLE_ECHO_GUARD_MS 1000
+
+/**
+ * @brief 初始化限速输出
+ * @param throttle 限速输出，须为静态存储（首次初始化前为全零）
+ * @param max_per_second 每秒最多发送次数
+ * @param send 发送回调
+ * @param ctx 回调上下文
+ */
+void ui_throttle_init(ui_throttle_t *throttle, uint32_t max_per_second, ui_throttle_send_cb_t send, void *ctx);
+
+/**
+ * @brief 提交拖动中的值，间隔已到时立即发送，否则只保留最新值等定时器发送
+ * @param throttle 限速输出
+ * @param value 当前值
+ */
+void ui_throttle_update(ui_throttle_t *throttle, int32_t value);
+
+/**
+ * @brief 提交最终值并立即发送（与上次发送的值相同时跳过）
+ * @param throttle 限速输出
+ * @param value 最终值
+ */
+void ui_throttle_finish(ui_throttle_t *throttle, int32_t value);
+
+/**
+ * @brief 是否正在拖动或刚松开，期间外部状态更新不应覆盖滑块
+ * @param throttle 限速输出
+ * @return true 忙碌
+ */
+bool ui_throttle_busy(const ui_throttle_t *throttle);
+
+/**
+ * @brief 将滑块的值变化和松开事件接到限速输出
+ * @param throttle 限速输出
+ * @param slider 滑块对象
+ */
+void ui_throttle_attach_slider(ui_throttle_t *throttle, lv_obj_t *slider);
+
+#endif /* UI_THROTTLE_H */
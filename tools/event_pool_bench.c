@@ -0,0 +1,220 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+/*
+ * 主机端基准：模拟面板运行24小时的事件负载分配，比较逐个 malloc 与
+ * event_pool 槽位两种方式下堆的碎片率，以及单次分配/释放的耗时。
+ *
+ * 堆用 tools/host/model_heap.h 的首次适配模拟堆代替（设备上是 TLSF，绝对数值不同，趋势可比）。
+ * 两种方式的背景负载相同：每秒播放进度、歌词、插座功率、HA 轮询，
+ * 每分钟一次 HTTP 响应缓冲区，每首歌（4分钟）换一张封面缓冲区。
+ * 基线不计旧代码中从未释放的生产者副本，它单独就会在24小时内耗尽堆。
+ *
+ * 编译（在项目根目录）：
+ *   gcc -O2 -Itools/host -Imain/include tools/event_pool_bench.c main/src/event_pool.c -o event_pool_bench
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "event_pool.h"
+#include "model_heap.h"
+
+// 模拟堆大小，接近设备连上 WiFi 和 MQTT 后剩余的内部 RAM
+#define MODEL_HEAP_SIZE (192 * 1024)
+
+// 模拟时长（秒）
+#define SIM_SECONDS (24 * 3600)
+
+// ESP32 上事件负载的大小：8字节引用计数头 + sizeof(ui_update_t)
+#define EVENT_PAYLOAD_SIZE (8 + 16)
+
+// 同时在途的分配数上限（事件在队列中等待消费期间占用负载）
+#define LIVE_MAX 256
+
+// 计时时每种方式的分配/释放次数
+#define TIMING_ITERATIONS 2000000
+
+static uint8_t s_heap_mem[MODEL_HEAP_SIZE] __attribute__((aligned(8)));
+static model_heap_t s_heap;
+
+// 在途分配：到 free_at 毫秒时释放
+typedef struct {
+    void *ptr;
+    uint64_t free_at;
+    bool pooled;
+} live_t;
+
+static live_t s_live[LIVE_MAX];
+
+static uint32_t s_rand = 1;
+
+static uint32_t next_rand(void)
+{
+    s_rand = s_rand * 1103515245u + 12345u;
+    return s_rand >> 16;
+}
+
+static void release_due(uint64_t now_ms)
+{
+    for (int i = 0; i < LIVE_MAX; i++) {
+        if (s_live[i].ptr != NULL && s_live[i].free_at <= now_ms) {
+            if (s_live[i].pooled) {
+                event_pool_free(s_live[i].ptr);
+            } else {
+                model_heap_free(&s_heap, s_live[i].ptr);
+            }
+            s_live[i].ptr = NULL;
+        }
+    }
+}
+
+static void hold(void *ptr, bool pooled, uint64_t free_at)
+{
+    if (ptr == NULL) {
+        return;
+    }
+    for (int i = 0; i < LIVE_MAX; i++) {
+        if (s_live[i].ptr == NULL) {
+            s_live[i] = (live_t){ptr, free_at, pooled};
+            return;
+        }
+    }
+    // 在途数组满时立即释放，不影响结果
+    pooled ? event_pool_free(ptr) : model_heap_free(&s_heap, ptr);
+}
+
+/*
+ * 一个事件：MQTT 主题和数据各一块堆内存（两种方式相同），负载按方式分配。
+ * 基线：生产者 malloc 一份，event_system_post 再复制一份，原件发送后立即释放。
+ * 负载池：event_system_alloc 从池中取一个槽位，所有权转给消费者。
+ */
+static void post_event(bool use_pool, uint64_t now_ms, size_t topic_len, size_t data_len)
+{
+    uint64_t consumed_at = now_ms + 5 + next_rand() % 40;   // LVGL 每 33 ms 处理一轮
+    hold(model_heap_alloc(&s_heap, topic_len + 1), false, consumed_at);
+    hold(model_heap_alloc(&s_heap, data_len + 1), false, consumed_at);
+    if (use_pool) {
+        void *payload = event_pool_alloc(EVENT_PAYLOAD_SIZE);
+        if (event_pool_owns(payload)) {
+            hold(payload, true, consumed_at);
+        } else {
+            free(payload);                                  // 池耗尽时的堆回退，计入 heap_fallbacks
+            hold(model_heap_alloc(&s_heap, EVENT_PAYLOAD_SIZE), false, consumed_at);
+        }
+    } else {
+        void *original = model_heap_alloc(&s_heap, EVENT_PAYLOAD_SIZE - 8);
+        hold(model_heap_alloc(&s_heap, EVENT_PAYLOAD_SIZE - 8), false, consumed_at);
+        model_heap_free(&s_heap, original);
+    }
+}
+
+typedef struct {
+    uint32_t heap_calls;
+    uint32_t heap_failures;
+    uint32_t worst_permille;
+    uint32_t final_permille;
+    size_t final_largest;
+} sim_result_t;
+
+static void simulate(bool use_pool, sim_result_t *res)
+{
+    model_heap_init(&s_heap, s_heap_mem, sizeof(s_heap_mem));
+    memset(s_live, 0, sizeof(s_live));
+    s_rand = 1;
+    void *album_art = NULL;
+    uint32_t worst = 0;
+
+    for (uint64_t sec = 0; sec < SIM_SECONDS; sec++) {
+        uint64_t now_ms = sec * 1000;
+        release_due(now_ms);
+
+        // 每首歌换封面：先释放旧缓冲区，新缓冲区大小随图片变化
+        if (sec % 240 == 0) {
+            model_heap_free(&s_heap, album_art);
+            album_art = model_heap_alloc(&s_heap, 48 * 1024 + (next_rand() % 48) * 1024);
+        }
+        // 每分钟一次 HTTP 响应缓冲区（天气、XML 等），接收期间仍有事件在途
+        if (sec % 60 == 30) {
+            hold(model_heap_alloc(&s_heap, 2048 + next_rand() % 6144), false, now_ms + 200 + next_rand() % 600);
+        }
+
+        post_event(use_pool, now_ms, 52, 6);                 // position
+        post_event(use_pool, now_ms + 4, 52, 13);            // progress
+        if (sec % 4 == 0) {
+            post_event(use_pool, now_ms + 120, 50, 18 + next_rand() % 30);   // lyrics
+        }
+        if (sec % 10 == 0) {
+            post_event(use_pool, now_ms + 300, 40, 120);     // 插座 SENSOR
+        }
+        if (sec % 5 == 0) {
+            post_event(use_pool, now_ms + 500, 24, 8);       // HA 室内温湿度
+            post_event(use_pool, now_ms + 501, 24, 8);
+        }
+
+        // 事件仍在队列中时统计，与 ha_monitor_task 每轮采样一次类似
+        size_t largest;
+        uint32_t permille = model_heap_fragmentation(&s_heap, &largest);
+        if (permille > worst) {
+            worst = permille;
+        }
+    }
+
+    release_due(UINT64_MAX);
+    res->heap_calls = s_heap.calls;
+    res->heap_failures = s_heap.failures;
+    res->worst_permille = worst;
+    res->final_permille = model_heap_fragmentation(&s_heap, &res->final_largest);
+    model_heap_free(&s_heap, album_art);
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+int main(void)
+{
+    sim_result_t heap_res;
+    sim_result_t pool_res;
+    simulate(false, &heap_res);
+    simulate(true, &pool_res);
+
+    event_pool_stats_t stats;
+    event_pool_get_stats(&stats);
+
+    // 单次分配/释放耗时：主机 malloc 与 event_pool（含自旋锁）
+    volatile uintptr_t sink = 0;
+    double start = now_ns();
+    for (int i = 0; i < TIMING_ITERATIONS; i++) {
+        void *p = malloc(EVENT_PAYLOAD_SIZE);
+        sink += (uintptr_t)p;
+        free(p);
+    }
+    double malloc_ns = (now_ns() - start) / TIMING_ITERATIONS;
+    start = now_ns();
+    for (int i = 0; i < TIMING_ITERATIONS; i++) {
+        void *p = event_pool_alloc(EVENT_PAYLOAD_SIZE);
+        sink += (uintptr_t)p;
+        event_pool_free(p);
+    }
+    double pool_ns = (now_ns() - start) / TIMING_ITERATIONS;
+    (void)sink;
+
+    printf("模拟 %d 小时，堆 %d KB\n", SIM_SECONDS / 3600, MODEL_HEAP_SIZE / 1024);
+    printf("%-12s %12s %10s %14s %14s %14s %10s\n", "", "heap calls", "failures", "worst frag ‰",
+           "final frag ‰", "largest free", "ns/op");
+    printf("%-12s %12u %10u %14u %14u %14zu %10.1f\n", "malloc", heap_res.heap_calls, heap_res.heap_failures,
+           heap_res.worst_permille, heap_res.final_permille, heap_res.final_largest, malloc_ns);
+    printf("%-12s %12u %10u %14u %14u %14zu %10.1f\n", "event_pool", pool_res.heap_calls, pool_res.heap_failures,
+           pool_res.worst_permille, pool_res.final_permille, pool_res.final_largest, pool_ns);
+    printf("event_pool: 分配 %u 次，峰值占用 %u/%u 槽位，回退到堆 %u 次\n", (unsigned int)stats.acquired,
+           (unsigned int)stats.high_water, (unsigned int)stats.capacity, (unsigned int)stats.heap_fallbacks);
+    return 0;
+}
@@ -0,0 +1,116 @@
+#!/usr/bin/env python3
+# SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: CC0-1.0
+"""模拟 Home Assistant mqtt_statestream，向本地MQTT服务器发布面板关注的实体状态
+
+配合 CONFIG_SMART_PANEL_HA_STATESTREAM 使用，无需真实的 Home Assistant：
+
+  mosquitto -v
+  python tools/ha_statestream_sim.py --host localhost script   # 按脚本切换开关和更新传感器
+  python tools/ha_statestream_sim.py set switch.tasmota on     # 发布单个实体状态
+
+与 HA 相同，状态以保留消息发布，面板重新连接后立即收到当前状态。
+"""
+
+import argparse
+import random
+import sys
+import time
+
+# 面板订阅的实体（与 main/src/event_system.c 中的 statestream 路由一致）
+SWITCHES = ['switch.tasmota', 'switch.new_dc1_3', 'switch.new_dc1_4', 'switch.tasmota_2']
+SENSORS = {
+    'sensor.daily_energy_consumption': lambda: f'{random.uniform(0, 12):.2f}',
+    'sensor.monthly_energy_consumption': lambda: f'{random.uniform(50, 400):.2f}',
+    'sensor.zhimi_cn_94444656_ma2_temperature_p_3_3': lambda: f'{random.uniform(18, 32):.1f}',
+    'sensor.zhimi_cn_94444656_ma2_relative_humidity_p_3_1': lambda: f'{random.randint(30, 90)}',
+}
+
+
+def topic(base: str, entity_id: str) -> str:
+    domain, object_id = entity_id.split('.', 1)
+    return f'{base}/{domain}/{object_id}/state'
+
+
+def connect(args: argparse.Namespace):
+    try:
+        import paho.mqtt.client as mqtt
+    except ImportError:
+        sys.exit('需要 paho-mqtt: pip install paho-mqtt')
+    client = mqtt.Client(client_id=args.client_id)
+    if args.username:
+        client.username_pw_set(args.username, args.password)
+    client.connect(args.host, args.port)
+    client.loop_start()
+    return client
+
+
+def publish(client, args: argparse.Namespace, entity_id: str, state: str) -> None:
+    t = topic(args.base_topic, entity_id)
+    client.publish(t, state, qos=1, retain=True).wait_for_publish()
+    print(f'{time.strftime("%H:%M:%S")} {t} = {state}')
+
+
+def cmd_set(args: argparse.Namespace) -> None:
+    client = connect(args)
+    publish(client, args, args.entity_id, args.state)
+    client.loop_stop()
+    client.disconnect()
+
+
+def cmd_script(args: argparse.Namespace) -> None:
+    client = connect(args)
+    switch_states = {entity_id: 'off' for entity_id in SWITCHES}
+
+    # 先发布全部实体的初始状态
+    for entity_id in SWITCHES:
+        publish(client, args, entity_id, switch_states[entity_id])
+    for entity_id, value in SENSORS.items():
+        publish(client, args, entity_id, value())
+
+    # 轮流切换开关，每隔几步更新传感器，偶尔让实体短暂不可用
+    for step in range(args.steps):
+        time.sleep(args.interval)
+        entity_id = SWITCHES[step % len(SWITCHES)]
+        switch_states[entity_id] = 'on' if switch_states[entity_id] == 'off' else 'off'
+        publish(client, args, entity_id, switch_states[entity_id])
+        if step % 3 == 2:
+            sensor = random.choice(list(SENSORS))
+            publish(client, args, sensor, SENSORS[sensor]())
+        if args.unavailable and step % 10 == 9:
+            publish(client, args, SWITCHES[0], 'unavailable')
+            time.sleep(args.interval)
+            publish(client, args, SWITCHES[0], switch_states[SWITCHES[0]])
+
+    client.loop_stop()
+    client.disconnect()
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--host', default='localhost')
+    parser.add_argument('--port', type=int, default=1883)
+    parser.add_argument('--username')
+    parser.add_argument('--password')
+    parser.add_argument('--client-id', default='ha_statestream_sim')
+    parser.add_argument('--base-topic', default='homeassistant/statestream',
+                        help='与 CONFIG_SMART_PANEL_HA_STATESTREAM_BASE_TOPIC 相同')
+    sub = parser.add_subparsers(dest='command', required=True)
+
+    p = sub.add_parser('script', help='按脚本发布状态变化')
+    p.add_argument('--steps', type=int, default=20)
+    p.add_argument('--interval', type=float, default=2.0, help='每步间隔（秒）')
+    p.add_argument('--unavailable', action='store_true', help='每10步让一个开关短暂不可用')
+    p.set_defaults(func=cmd_script)
+
+    p = sub.add_parser('set', help='发布单个实体状态')
+    p.add_argument('entity_id')
+    p.add_argument('state')
+    p.set_defaults(func=cmd_set)
+
+    args = parser.parse_args()
+    args.func(args)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,229 @@
+#!/usr/bin/env python3
+# SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: CC0-1.0
+"""Home Assistant WebSocket API 的本地替身，用于测试 CONFIG_SMART_PANEL_HA_WEBSOCKET
+
+只依赖标准库，实现面板用到的部分协议：
+  auth_required / auth / auth_ok / auth_invalid
+  subscribe_entities  首条事件 {"a": {...}} 含全部实体，之后推送 {"c": {id: {"+": {"s": ...}}}}
+  call_service        回复 result，并推送对应开关的状态变化
+
+  python tools/ha_ws_stub.py --port 8123 --token TOKEN --toggle-interval 5
+
+把 menuconfig 中的 CONFIG_SMART_PANEL_HA_HOST 指向运行本脚本的主机即可。
+"""
+
+import argparse
+import asyncio
+import base64
+import hashlib
+import json
+import random
+import struct
+import time
+
+WS_GUID = '258EAFA5-E914-47DA-95CA-C5AB0DC85B11'
+
+OP_TEXT = 0x1
+OP_CLOSE = 0x8
+OP_PING = 0x9
+OP_PONG = 0xA
+
+INITIAL_STATES = {
+    'sensor.daily_energy_consumption': '3.42',
+    'sensor.monthly_energy_consumption': '126.70',
+    'sensor.zhimi_cn_94444656_ma2_temperature_p_3_3': '24.6',
+    'sensor.zhimi_cn_94444656_ma2_relative_humidity_p_3_1': '58',
+    'switch.tasmota': 'off',
+    'switch.new_dc1_3': 'on',
+    'switch.new_dc1_4': 'off',
+    'switch.tasmota_2': 'off',
+}
+
+
+def log(msg: str) -> None:
+    print(f'{time.strftime("%H:%M:%S")} {msg}', flush=True)
+
+
+class Connection:
+    def __init__(self, reader: asyncio.StreamReader, writer: asyncio.StreamWriter):
+        self.reader = reader
+        self.writer = writer
+        self.send_lock = asyncio.Lock()
+
+    async def handshake(self) -> bool:
+        request = await self.reader.readuntil(b'\r\n\r\n')
+        lines = request.decode('latin-1').split('\r\n')
+        headers = {}
+        for line in lines[1:]:
+            if ':' in line:
+                key, value = line.split(':', 1)
+                headers[key.strip().lower()] = value.strip()
+        key = headers.get('sec-websocket-key')
+        if not lines[0].startswith('GET /api/websocket') or key is None:
+            self.writer.write(b'HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n')
+            await self.writer.drain()
+            return False
+        accept = base64.b64encode(hashlib.sha1((key + WS_GUID).encode()).digest()).decode()
+        self.writer.write(('HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n'
+                           f'Sec-WebSocket-Accept: {accept}\r\n\r\n').encode())
+        await self.writer.drain()
+        return True
+
+    async def recv_frame(self):
+        head = await self.reader.readexactly(2)
+        opcode = head[0] & 0x0F
+        masked = head[1] & 0x80
+        length = head[1] & 0x7F
+        if length == 126:
+            length = struct.unpack('>H', await self.reader.readexactly(2))[0]
+        elif length == 127:
+            length = struct.unpack('>Q', await self.reader.readexactly(8))[0]
+        mask = await self.reader.readexactly(4) if masked else b'\0\0\0\0'
+        payload = bytearray(await self.reader.readexactly(length))
+        for i in range(length):
+            payload[i] ^= mask[i % 4]
+        return opcode, bytes(payload)
+
+    async def send_frame(self, opcode: int, payload: bytes) -> None:
+        length = len(payload)
+        if length < 126:
+            head = struct.pack('>BB', 0x80 | opcode, length)
+        elif length < 65536:
+            head = struct.pack('>BBH', 0x80 | opcode, 126, length)
+        else:
+            head = struct.pack('>BBQ', 0x80 | opcode, 127, length)
+        async with self.send_lock:
+            self.writer.write(head + payload)
+            await self.writer.drain()
+
+    async def send_json(self, msg: dict) -> None:
+        text = json.dumps(msg, separators=(',', ':'))
+        log(f'-> {text[:160]}')
+        await self.send_frame(OP_TEXT, text.encode())
+
+
+class HomeAssistantStub:
+    def __init__(self, args: argparse.Namespace):
+        self.args = args
+        self.states = dict(INITIAL_STATES)
+        self.subscribers = []       # (connection, subscription id, entity ids)
+
+    def compressed(self, entity_id: str) -> dict:
+        # 与 HA 相同附带属性，使首条消息足够大，能触发客户端的分段接收
+        return {'s': self.states[entity_id], 'a': {'friendly_name': entity_id, 'padding': 'x' * self.args.padding},
+                'c': '01HXXXXXXXXXXXXXXXXXXXXXXX', 'lc': time.time()}
+
+    async def set_state(self, entity_id: str, state: str) -> None:
+        if self.states.get(entity_id) == state:
+            return
+        self.states[entity_id] = state
+        for conn, sub_id, entity_ids in list(self.subscribers):
+            if entity_id in entity_ids:
+                event = {'c': {entity_id: {'+': {'s': state, 'lc': time.time()}}}}
+                await conn.send_json({'id': sub_id, 'type': 'event', 'event': event})
+
+    async def handle(self, reader: asyncio.StreamReader, writer: asyncio.StreamWriter) -> None:
+        peer = writer.get_extra_info('peername')
+        conn = Connection(reader, writer)
+        try:
+            if not await conn.handshake():
+                return
+            log(f'{peer} 已连接')
+            await conn.send_json({'type': 'auth_required', 'ha_version': '2025.6.0'})
+            authenticated = False
+            last_id = 0
+            while True:
+                opcode, payload = await conn.recv_frame()
+                if opcode == OP_CLOSE:
+                    break
+                if opcode == OP_PING:
+                    await conn.send_frame(OP_PONG, payload)
+                    continue
+                if opcode != OP_TEXT:
+                    continue
+                msg = json.loads(payload)
+                log(f'<- {payload.decode()[:160]}')
+
+                if not authenticated:
+                    if msg.get('type') == 'auth' and msg.get('access_token') == self.args.token:
+                        authenticated = True
+                        await conn.send_json({'type': 'auth_ok', 'ha_version': '2025.6.0'})
+                    else:
+                        await conn.send_json({'type': 'auth_invalid', 'message': 'Invalid access token'})
+                        break
+                    continue
+
+                msg_id = msg.get('id', 0)
+                if msg_id <= last_id:
+                    await conn.send_json({'id': msg_id, 'type': 'result', 'success': False,
+                                          'error': {'code': 'id_reuse', 'message': 'Identifier values have to increase.'}})
+                    continue
+                last_id = msg_id
+
+                if msg.get('type') == 'subscribe_entities':
+                    entity_ids = [e for e in msg.get('entity_ids', []) if e in self.states]
+                    self.subscribers.append((conn, msg_id, entity_ids))
+                    await conn.send_json({'id': msg_id, 'type': 'result', 'success': True, 'result': None})
+                    added = {e: self.compressed(e) for e in entity_ids}
+                    await conn.send_json({'id': msg_id, 'type': 'event', 'event': {'a': added}})
+                elif msg.get('type') == 'call_service':
+                    entity_id = msg.get('target', {}).get('entity_id')
+                    service = msg.get('service')
+                    if entity_id in self.states and service in ('turn_on', 'turn_off', 'toggle'):
+                        await conn.send_json({'id': msg_id, 'type': 'result', 'success': True,
+                                              'result': {'context': {'id': 'stub'}}})
+                        if service == 'toggle':
+                            state = 'off' if self.states[entity_id] == 'on' else 'on'
+                        else:
+                            state = 'on' if service == 'turn_on' else 'off'
+                        await self.set_state(entity_id, state)
+                    else:
+                        await conn.send_json({'id': msg_id, 'type': 'result', 'success': False,
+                                              'error': {'code': 'not_found', 'message': 'Service not found.'}})
+                else:
+                    await conn.send_json({'id': msg_id, 'type': 'result', 'success': False,
+                                          'error': {'code': 'unknown_command', 'message': 'Unknown command.'}})
+        except (asyncio.IncompleteReadError, ConnectionError):
+            pass
+        finally:
+            self.subscribers = [s for s in self.subscribers if s[0] is not conn]
+            writer.close()
+            log(f'{peer} 已断开')
+
+    async def churn(self) -> None:
+        # 模拟在别处操作开关和传感器数据变化
+        switches = [e for e in self.states if e.startswith('switch.')]
+        while True:
+            await asyncio.sleep(self.args.toggle_interval)
+            entity_id = random.choice(switches)
+            await self.set_state(entity_id, 'off' if self.states[entity_id] == 'on' else 'on')
+            await self.set_state('sensor.daily_energy_consumption',
+                                 f'{float(self.states["sensor.daily_energy_consumption"]) + 0.05:.2f}')
+
+
+async def serve(args: argparse.Namespace) -> None:
+    stub = HomeAssistantStub(args)
+    server = await asyncio.start_server(stub.handle, args.host, args.port)
+    log(f'监听 ws://{args.host}:{args.port}/api/websocket')
+    if args.toggle_interval > 0:
+        asyncio.create_task(stub.churn())
+    async with server:
+        await server.serve_forever()
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--host', default='0.0.0.0')
+    parser.add_argument('--port', type=int, default=8123)
+    parser.add_argument('--token', required=True, help='与 CONFIG_SMART_PANEL_HA_TOKEN 相同')
+    parser.add_argument('--toggle-interval', type=float, default=0, help='每隔多少秒随机切换一个开关，0 表示不切换')
+    parser.add_argument('--padding', type=int, default=256, help='每个实体附带的属性字节数')
+    try:
+        asyncio.run(serve(parser.parse_args()))
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == '__main__':
+    main()
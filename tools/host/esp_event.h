@@ -0,0 +1,14 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+/* 主机端基准使用的 esp_event 替身：event_system.h 只需要包含它 */
+
+#ifndef HOST_ESP_EVENT_H
+#define HOST_ESP_EVENT_H
+
+#include "esp_err.h"
+
+#endif /* HOST_ESP_EVENT_H */
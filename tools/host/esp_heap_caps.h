@@ -0,0 +1,55 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+/*
+ * 主机端基准使用的 heap_caps 替身：所有能力位都分配自普通堆。
+ * 定义 HOST_HEAP_CAPS_HOOK 时只有声明，由基准程序按能力位分配到各自的模拟堆。
+ */
+
+#ifndef HOST_ESP_HEAP_CAPS_H
+#define HOST_ESP_HEAP_CAPS_H
+
+#include <stdlib.h>
+
+#define MALLOC_CAP_8BIT     (1 << 2)
+#define MALLOC_CAP_SPIRAM   (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+
+#ifdef HOST_HEAP_CAPS_HOOK
+
+void *heap_caps_malloc(size_t size, unsigned int caps);
+void *heap_caps_calloc(size_t n, size_t size, unsigned int caps);
+void *heap_caps_realloc(void *ptr, size_t size, unsigned int caps);
+void heap_caps_free(void *ptr);
+
+#else
+
+static inline void *heap_caps_malloc(size_t size, unsigned int caps)
+{
+    (void)caps;
+    return malloc(size);
+}
+
+static inline void *heap_caps_calloc(size_t n, size_t size, unsigned int caps)
+{
+    (void)caps;
+    return calloc(n, size);
+}
+
+static inline void *heap_caps_realloc(void *ptr, size_t size, unsigned int caps)
+{
+    (void)caps;
+    return realloc(ptr, size);
+}
+
+static inline void heap_caps_free(void *ptr)
+{
+    free(ptr);
+}
+
+#endif /* HOST_HEAP_CAPS_HOOK */
+
+#endif /* HOST_ESP_HEAP_CAPS_H */
@@ -0,0 +1,16 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+/* 主机端基准使用的 esp_idf_version 替身 */
+
+#ifndef HOST_ESP_IDF_VERSION_H
+#define HOST_ESP_IDF_VERSION_H
+
+#define ESP_IDF_VERSION_VAL(major, minor, patch) (((major) << 16) | ((minor) << 8) | (patch))
+
+#define ESP_IDF_VERSION ESP_IDF_VERSION_VAL(5, 5, 0)
+
+#endif /* HOST_ESP_IDF_VERSION_H */
@@ -0,0 +1,43 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+/*
+ * 主机端基准使用的 FreeRTOS 替身：只提供 main/src 中可移植模块用到的类型和自旋锁。
+ * 临界区用 __atomic 忙等实现，可在多个 pthread 之间使用。
+ */
+
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef void *TaskHandle_t;
+
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+typedef struct {
+    volatile int locked;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED {0}
+
+static inline void portENTER_CRITICAL(portMUX_TYPE *mux)
+{
+    while (__atomic_exchange_n(&mux->locked, 1, __ATOMIC_ACQUIRE)) {
+        while (__atomic_load_n(&mux->locked, __ATOMIC_RELAXED)) {
+        }
+    }
+}
+
+static inline void portEXIT_CRITICAL(portMUX_TYPE *mux)
+{
+    __atomic_store_n(&mux->locked, 0, __ATOMIC_RELEASE);
+}
+
+#endif /* HOST_FREERTOS_H */
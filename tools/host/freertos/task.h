@@ -0,0 +1,21 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+/* 主机端基准使用的 FreeRTOS task 替身：一个节拍按 1 毫秒计 */
+
+#ifndef HOST_FREERTOS_TASK_H
+#define HOST_FREERTOS_TASK_H
+
+#include <time.h>
+#include "freertos/FreeRTOS.h"
+
+static inline void vTaskDelay(TickType_t ticks)
+{
+    struct timespec ts = {ticks / 1000, (long)(ticks % 1000) * 1000000L};
+    nanosleep(&ts, NULL);
+}
+
+#endif /* HOST_FREERTOS_TASK_H */
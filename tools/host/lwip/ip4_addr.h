@@ -0,0 +1,12 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+/* 主机端基准使用的 lwip 替身：http_service.c 包含此头文件但不使用其中的定义 */
+
+#ifndef HOST_LWIP_IP4_ADDR_H
+#define HOST_LWIP_IP4_ADDR_H
+
+#endif /* HOST_LWIP_IP4_ADDR_H */
@@ -0,0 +1,153 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+/*
+ * 主机端基准使用的模拟堆：首次适配，块头记录大小和是否空闲，分配时合并相邻空闲块。
+ * 设备上是 TLSF，绝对数值不同，用来比较不同分配方式下碎片率的趋势。
+ * 碎片率与 ha_monitor_task 的统计相同：1000 - 最大空闲块 * 1000 / 空闲总量。
+ */
+
+#ifndef HOST_MODEL_HEAP_H
+#define HOST_MODEL_HEAP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+typedef struct {
+    uint8_t *mem;               // 堆内存，8字节对齐
+    size_t size;
+    uint32_t calls;             // 分配和扩容次数
+    uint32_t failures;          // 失败次数
+} model_heap_t;
+
+// 块头，size 含块头
+typedef struct {
+    uint32_t size;
+    uint32_t used;
+} model_block_t;
+
+static inline model_block_t *model_block_at(const model_heap_t *heap, size_t offset)
+{
+    return (model_block_t *)(heap->mem + offset);
+}
+
+static inline void model_heap_init(model_heap_t *heap, void *mem, size_t size)
+{
+    heap->mem = mem;
+    heap->size = size;
+    heap->calls = 0;
+    heap->failures = 0;
+    model_block_t *b = model_block_at(heap, 0);
+    b->size = (uint32_t)size;
+    b->used = 0;
+}
+
+// 合并 b 之后连续的空闲块
+static inline void model_heap_merge(const model_heap_t *heap, model_block_t *b)
+{
+    size_t offset = (uint8_t *)b - heap->mem;
+    while (offset + b->size < heap->size) {
+        model_block_t *next = model_block_at(heap, offset + b->size);
+        if (next->used) {
+            break;
+        }
+        b->size += next->size;
+    }
+}
+
+static inline void *model_heap_alloc(model_heap_t *heap, size_t size)
+{
+    uint32_t need = (uint32_t)((size + 7) & ~(size_t)7) + sizeof(model_block_t);
+    heap->calls++;
+    for (size_t offset = 0; offset < heap->size; offset += model_block_at(heap, offset)->size) {
+        model_block_t *b = model_block_at(heap, offset);
+        if (b->used) {
+            continue;
+        }
+        model_heap_merge(heap, b);
+        if (b->size < need) {
+            continue;
+        }
+        if (b->size - need >= 2 * sizeof(model_block_t)) {
+            model_block_t *rest = model_block_at(heap, offset + need);
+            rest->size = b->size - need;
+            rest->used = 0;
+            b->size = need;
+        }
+        b->used = 1;
+        return b + 1;
+    }
+    heap->failures++;
+    return NULL;
+}
+
+static inline void model_heap_free(model_heap_t *heap, void *ptr)
+{
+    (void)heap;
+    if (ptr != NULL) {
+        ((model_block_t *)ptr - 1)->used = 0;
+    }
+}
+
+// 后面的空闲块够用时原地扩容，否则分配新块并拷贝
+static inline void *model_heap_realloc(model_heap_t *heap, void *ptr, size_t size)
+{
+    if (ptr == NULL) {
+        return model_heap_alloc(heap, size);
+    }
+    model_block_t *b = (model_block_t *)ptr - 1;
+    uint32_t need = (uint32_t)((size + 7) & ~(size_t)7) + sizeof(model_block_t);
+    size_t old_size = b->size - sizeof(model_block_t);
+    b->used = 0;
+    model_heap_merge(heap, b);
+    b->used = 1;
+    if (b->size >= need) {
+        heap->calls++;
+        if (b->size - need >= 2 * sizeof(model_block_t)) {
+            model_block_t *rest = (model_block_t *)((uint8_t *)b + need);
+            rest->size = b->size - need;
+            rest->used = 0;
+            b->size = need;
+        }
+        return ptr;
+    }
+    void *bigger = model_heap_alloc(heap, size);
+    if (bigger != NULL) {
+        memcpy(bigger, ptr, old_size);
+        b->used = 0;
+    }
+    return bigger;
+}
+
+static inline bool model_heap_owns(const model_heap_t *heap, const void *ptr)
+{
+    return (const uint8_t *)ptr >= heap->mem && (const uint8_t *)ptr < heap->mem + heap->size;
+}
+
+static inline uint32_t model_heap_fragmentation(const model_heap_t *heap, size_t *largest_out)
+{
+    size_t free_size = 0;
+    size_t largest = 0;
+    for (size_t offset = 0; offset < heap->size; offset += model_block_at(heap, offset)->size) {
+        model_block_t *b = model_block_at(heap, offset);
+        if (!b->used) {
+            model_heap_merge(heap, b);
+            size_t usable = b->size - sizeof(model_block_t);
+            free_size += usable;
+            if (usable > largest) {
+                largest = usable;
+            }
+        }
+    }
+    if (largest_out != NULL) {
+        *largest_out = largest;
+    }
+    return (free_size > 0) ? (uint32_t)(1000 - (uint64_t)largest * 1000 / free_size) : 0;
+}
+
+#endif /* HOST_MODEL_HEAP_H */
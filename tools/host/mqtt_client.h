@@ -0,0 +1,19 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+/* 主机端基准使用的 esp-mqtt 替身：只提供客户端句柄和订阅列表类型 */
+
+#ifndef HOST_MQTT_CLIENT_H
+#define HOST_MQTT_CLIENT_H
+
+typedef struct esp_mqtt_client *esp_mqtt_client_handle_t;
+
+typedef struct {
+    const char *filter;
+    int qos;
+} esp_mqtt_topic_t;
+
+#endif /* HOST_MQTT_CLIENT_H */
@@ -0,0 +1,533 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+/*
+ * 主机端基准：比较 HTTP 响应缓冲区的两种方式在一天的轮询中对堆的影响。
+ *   old：  旧实现，malloc(content_length + 1) 或 4 KB，memset 清零，不够时 realloc 增加 4 KB，
+ *          解析后 free；malloc 按 ESP-IDF 默认配置，16 KB 以下分配自内部RAM，更大的分配自PSRAM
+ *   arena：设备上的 http_service.c 原样编译，响应读入工作任务复用的 arena（优先PSRAM）
+ * esp_http_client 由本文件模拟，内部RAM和PSRAM各用一个 tools/host/model_heap.h 模拟堆。
+ *
+ * 每个轮询周期请求三个端点，响应长度每次略有变化：
+ *   main.xml     约 24 KB，带 Content-Length
+ *   HA 服务调用   约 420 B，chunked
+ *   封面          约 9 KB，chunked
+ * 持有响应期间解析器在内部RAM分配小块（XML 节点、JSON 节点、JPEG 解码工作区），
+ * 其中少数长期保留；周期之间还有 MQTT 事件等背景分配。两种方式的背景负载相同。
+ * 碎片率在每个响应解析完、以及每个周期结束时采样，取最大值。
+ *
+ * 编译（在项目根目录）：
+ *   gcc -O2 -DHOST_HEAP_CAPS_HOOK -Itools/host -Imain/include tools/http_arena_bench.c \
+ *       main/src/http_service.c -o http_arena_bench
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_heap_caps.h"
+#include "esp_http_client.h"
+#include "http_service.h"
+#include "model_heap.h"
+#include "net_reachability.h"
+
+// 模拟堆大小：连上 WiFi 和 MQTT 后剩余的内部RAM，以及 PSRAM
+#define INTERNAL_HEAP_SIZE (160 * 1024)
+#define PSRAM_HEAP_SIZE (2 * 1024 * 1024)
+
+// CONFIG_SPIRAM_MALLOC_ALWAYSINTERNAL 的默认值：不超过此大小的 malloc 优先分配自内部RAM
+#define ALWAYSINTERNAL_SIZE 16384
+
+// 轮询周期数：每 30 秒一个周期，共24小时
+#define CYCLES 2880
+
+// 旧实现：长度未知时的初始大小和每次扩容的大小
+#define OLD_INITIAL_SIZE 4096
+#define OLD_GROW_SIZE 4096
+
+// 模拟连接每次 read 最多返回的字节数（一个 TCP 段）
+#define MOCK_READ_MAX 1460
+
+// 同时保留的背景分配数上限
+#define LIVE_MAX 2048
+
+typedef enum {
+    MODE_OLD,
+    MODE_ARENA,
+} bench_mode_t;
+
+typedef enum {
+    PARSE_XML,
+    PARSE_JSON,
+    PARSE_JPEG,
+} parse_kind_t;
+
+// 轮询的端点
+typedef struct {
+    const char *url;
+    bool chunked;
+    size_t base_len;
+    size_t jitter;              // 长度在 base_len ± jitter 内变化
+    parse_kind_t parse;
+} endpoint_t;
+
+static const endpoint_t s_endpoints[] = {
+    {"http://192.168.1.218/main.xml", false, 24000, 200, PARSE_XML},
+    {"http://192.168.1.10:8123/api/services/media_player/media_play_pause", true, 420, 40, PARSE_JSON},
+    {"http://192.168.1.218/convert_music_image.php?music_path=%2Fmusic%2F01.mp3", true, 9300, 600, PARSE_JPEG},
+};
+
+#define ENDPOINT_COUNT (sizeof(s_endpoints) / sizeof(s_endpoints[0]))
+
+static uint8_t s_internal_mem[INTERNAL_HEAP_SIZE] __attribute__((aligned(8)));
+static uint8_t s_psram_mem[PSRAM_HEAP_SIZE] __attribute__((aligned(8)));
+static model_heap_t s_internal;
+static model_heap_t s_psram;
+
+// 响应缓冲区的分配统计（背景分配不计）
+typedef struct {
+    uint32_t allocs;            // 分配和扩容次数
+    uint64_t zeroed;            // 清零的字节数
+    uint64_t copied;            // 扩容时搬移的字节数
+} buffer_stats_t;
+
+static buffer_stats_t s_buf;
+
+/* ---------- 模拟堆上的 heap_caps 和默认 malloc ---------- */
+
+static model_heap_t *heap_of(const void *ptr)
+{
+    return model_heap_owns(&s_internal, ptr) ? &s_internal : &s_psram;
+}
+
+static size_t usable_size(const void *ptr)
+{
+    return ((const model_block_t *)ptr - 1)->size - sizeof(model_block_t);
+}
+
+// 在 heap 中扩容：同一个堆时可能原地扩容，否则分配新块、拷贝并释放旧块
+static void *realloc_in(model_heap_t *heap, void *ptr, size_t size)
+{
+    s_buf.allocs++;
+    if (ptr == NULL) {
+        return model_heap_alloc(heap, size);
+    }
+    size_t old_size = usable_size(ptr);
+    void *buf;
+    if (heap_of(ptr) == heap) {
+        buf = model_heap_realloc(heap, ptr, size);
+    } else {
+        buf = model_heap_alloc(heap, size);
+        if (buf != NULL) {
+            memcpy(buf, ptr, (old_size < size) ? old_size : size);
+            model_heap_free(heap_of(ptr), ptr);
+        }
+    }
+    if (buf != NULL && buf != ptr) {
+        s_buf.copied += old_size;
+    }
+    return buf;
+}
+
+void *heap_caps_malloc(size_t size, unsigned int caps)
+{
+    return heap_caps_realloc(NULL, size, caps);
+}
+
+void *heap_caps_calloc(size_t n, size_t size, unsigned int caps)
+{
+    void *ptr = heap_caps_malloc(n * size, caps);
+    if (ptr != NULL) {
+        memset(ptr, 0, n * size);
+    }
+    return ptr;
+}
+
+void *heap_caps_realloc(void *ptr, size_t size, unsigned int caps)
+{
+    return realloc_in((caps & MALLOC_CAP_SPIRAM) ? &s_psram : &s_internal, ptr, size);
+}
+
+void heap_caps_free(void *ptr)
+{
+    if (ptr != NULL) {
+        model_heap_free(heap_of(ptr), ptr);
+    }
+}
+
+// 旧实现的 realloc：按新大小选择堆，首选的堆分配失败时换另一个
+static void *default_realloc(void *ptr, size_t size)
+{
+    bool internal_first = size <= ALWAYSINTERNAL_SIZE;
+    void *buf = realloc_in(internal_first ? &s_internal : &s_psram, ptr, size);
+    if (buf == NULL) {
+        buf = realloc_in(internal_first ? &s_psram : &s_internal, ptr, size);
+    }
+    return buf;
+}
+
+/* ---------- 模拟的 esp_http_client ---------- */
+
+struct esp_http_client {
+    bool chunked;
+    size_t body_len;            // 本次响应的长度
+    size_t pos;                 // 已读取的字节数
+};
+
+// 下一次 open 时服务器返回的响应
+static struct esp_http_client s_next_response;
+
+esp_http_client_handle_t esp_http_client_init(const esp_http_client_config_t *config)
+{
+    (void)config;
+    // 客户端本身两种方式相同，分配自主机堆，不计入模拟堆
+    return calloc(1, sizeof(struct esp_http_client));
+}
+
+esp_err_t esp_http_client_set_url(esp_http_client_handle_t client, const char *url)
+{
+    (void)client;
+    (void)url;
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_set_post_field(esp_http_client_handle_t client, const char *data, int len)
+{
+    (void)client;
+    (void)data;
+    (void)len;
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_set_header(esp_http_client_handle_t client, const char *key, const char *value)
+{
+    (void)client;
+    (void)key;
+    (void)value;
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_delete_header(esp_http_client_handle_t client, const char *key)
+{
+    (void)client;
+    (void)key;
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_set_method(esp_http_client_handle_t client, esp_http_client_method_t method)
+{
+    (void)client;
+    (void)method;
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_set_timeout_ms(esp_http_client_handle_t client, int timeout_ms)
+{
+    (void)client;
+    (void)timeout_ms;
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_open(esp_http_client_handle_t client, int write_len)
+{
+    (void)write_len;
+    *client = s_next_response;
+    client->pos = 0;
+    return ESP_OK;
+}
+
+int esp_http_client_write(esp_http_client_handle_t client, const char *buffer, int len)
+{
+    (void)client;
+    (void)buffer;
+    return len;
+}
+
+int64_t esp_http_client_fetch_headers(esp_http_client_handle_t client)
+{
+    return client->chunked ? -1 : (int64_t)client->body_len;
+}
+
+int esp_http_client_read(esp_http_client_handle_t client, char *buffer, int len)
+{
+    size_t n = client->body_len - client->pos;
+    if (n > (size_t)len) {
+        n = len;
+    }
+    if (n > MOCK_READ_MAX) {
+        n = MOCK_READ_MAX;
+    }
+    memset(buffer, 'x', n);
+    client->pos += n;
+    return (int)n;
+}
+
+esp_err_t esp_http_client_flush_response(esp_http_client_handle_t client, int *len)
+{
+    if (len != NULL) {
+        *len = (int)(client->body_len - client->pos);
+    }
+    client->pos = client->body_len;
+    return ESP_OK;
+}
+
+int esp_http_client_get_status_code(esp_http_client_handle_t client)
+{
+    (void)client;
+    return 200;
+}
+
+esp_err_t esp_http_client_close(esp_http_client_handle_t client)
+{
+    (void)client;
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_cleanup(esp_http_client_handle_t client)
+{
+    free(client);
+    return ESP_OK;
+}
+
+bool esp_http_client_is_complete_data_received(esp_http_client_handle_t client)
+{
+    return client->pos == client->body_len;
+}
+
+bool net_reachability_allow_request(void)
+{
+    return true;
+}
+
+void net_reachability_report(bool reachable)
+{
+    (void)reachable;
+}
+
+net_state_t net_reachability_get_state(void)
+{
+    return NET_STATE_ONLINE;
+}
+
+const char *net_reachability_state_name(net_state_t state)
+{
+    (void)state;
+    return "online";
+}
+
+/* ---------- 旧实现的响应读取 ---------- */
+
+// 与旧 http_send_request_internal 相同：按长度或 4 KB 分配并清零，不够时增加 4 KB
+static char *old_read_response(esp_http_client_handle_t client, size_t *out_len)
+{
+    esp_http_client_open(client, 0);
+    int content_length = (int)esp_http_client_fetch_headers(client);
+    int alloc_size = (content_length > 0) ? (content_length + 1) : OLD_INITIAL_SIZE;
+    char *response_buf = default_realloc(NULL, alloc_size);
+    if (response_buf == NULL) {
+        return NULL;
+    }
+    memset(response_buf, 0, alloc_size);
+    s_buf.zeroed += alloc_size;
+
+    int total_read_len = 0;
+    while (1) {
+        if (total_read_len >= alloc_size - 1) {
+            alloc_size += OLD_GROW_SIZE;
+            char *new_buf = default_realloc(response_buf, alloc_size);
+            if (new_buf == NULL) {
+                heap_caps_free(response_buf);
+                return NULL;
+            }
+            response_buf = new_buf;
+        }
+        int read_len = esp_http_client_read(client, response_buf + total_read_len, alloc_size - 1 - total_read_len);
+        if (read_len <= 0) {
+            break;
+        }
+        total_read_len += read_len;
+    }
+    response_buf[total_read_len] = '\0';
+    *out_len = total_read_len;
+    return response_buf;
+}
+
+/* ---------- 背景负载 ---------- */
+
+// 背景分配：到 free_at 周期结束时释放
+typedef struct {
+    void *ptr;
+    uint32_t free_at;
+} live_t;
+
+static live_t s_live[LIVE_MAX];
+
+static uint32_t s_rand = 1;
+
+static uint32_t next_rand(void)
+{
+    s_rand = s_rand * 1103515245u + 12345u;
+    return s_rand >> 16;
+}
+
+static void hold(size_t size, uint32_t free_at)
+{
+    void *ptr = model_heap_alloc(&s_internal, size);
+    if (ptr == NULL) {
+        return;
+    }
+    for (int i = 0; i < LIVE_MAX; i++) {
+        if (s_live[i].ptr == NULL) {
+            s_live[i] = (live_t){ptr, free_at};
+            return;
+        }
+    }
+    fprintf(stderr, "LIVE_MAX 太小\n");
+    exit(1);
+}
+
+static void release_due(uint32_t cycle)
+{
+    for (int i = 0; i < LIVE_MAX; i++) {
+        if (s_live[i].ptr != NULL && s_live[i].free_at <= cycle) {
+            model_heap_free(&s_internal, s_live[i].ptr);
+            s_live[i].ptr = NULL;
+        }
+    }
+}
+
+// 解析期间的分配：大多在本周期结束时释放，少数长期保留（界面对象、缓存的状态）
+static void parse_response(parse_kind_t kind, uint32_t cycle)
+{
+    switch (kind) {
+    case PARSE_XML:
+        for (int i = 0; i < 40; i++) {
+            uint32_t keep = (i % 10 == 0) ? 1 + next_rand() % 120 : 0;
+            hold(24 + next_rand() % 96, cycle + keep);
+        }
+        break;
+    case PARSE_JSON:
+        for (int i = 0; i < 12; i++) {
+            hold(48, cycle);
+        }
+        break;
+    case PARSE_JPEG:
+        hold(3100, cycle);                                  // TJpgDec 工作区
+        hold(64 + next_rand() % 192, cycle + 1 + next_rand() % 120);
+        break;
+    }
+}
+
+/* ---------- 模拟 ---------- */
+
+typedef struct {
+    buffer_stats_t first;       // 第一个周期
+    buffer_stats_t total;       // 全部周期
+    uint32_t worst_permille;    // 内部RAM最大碎片率
+    uint32_t final_permille;
+    size_t final_largest;
+    uint32_t psram_worst_permille;
+    uint32_t failures;          // 未能完整读入的响应数
+} sim_result_t;
+
+static void sample(sim_result_t *res)
+{
+    uint32_t permille = model_heap_fragmentation(&s_internal, NULL);
+    if (permille > res->worst_permille) {
+        res->worst_permille = permille;
+    }
+    permille = model_heap_fragmentation(&s_psram, NULL);
+    if (permille > res->psram_worst_permille) {
+        res->psram_worst_permille = permille;
+    }
+}
+
+static void simulate(bench_mode_t mode, sim_result_t *res)
+{
+    model_heap_init(&s_internal, s_internal_mem, sizeof(s_internal_mem));
+    model_heap_init(&s_psram, s_psram_mem, sizeof(s_psram_mem));
+    memset(res, 0, sizeof(*res));
+    memset(&s_buf, 0, sizeof(s_buf));
+    memset(s_live, 0, sizeof(s_live));
+    s_rand = 1;
+
+    esp_http_client_handle_t old_client = esp_http_client_init(NULL);
+    http_arena_t arena = {0};       // 一个 http_async 工作任务的 arena
+
+    for (uint32_t cycle = 0; cycle < CYCLES; cycle++) {
+        release_due(cycle);
+        for (size_t e = 0; e < ENDPOINT_COUNT; e++) {
+            const endpoint_t *ep = &s_endpoints[e];
+            s_next_response.chunked = ep->chunked;
+            s_next_response.body_len = ep->base_len - ep->jitter + next_rand() % (2 * ep->jitter + 1);
+
+            // 背景：响应接收期间到达的 MQTT 事件
+            for (int i = 0; i < 6; i++) {
+                hold(24 + next_rand() % 56, cycle);
+            }
+
+            size_t len = 0;
+            char *owned = NULL;
+            if (mode == MODE_OLD) {
+                owned = old_read_response(old_client, &len);
+            } else {
+                http_config_t config = {.url = ep->url, .method = HTTP_METHOD_GET};
+                http_view_t view;
+                if (http_send_request_arena(&config, 1, &arena, &view) == ESP_OK) {
+                    len = view.len;
+                }
+            }
+            if (len != s_next_response.body_len) {
+                res->failures++;
+            }
+
+            parse_response(ep->parse, cycle);
+            sample(res);
+            heap_caps_free(owned);
+        }
+        // 长期保留的背景分配（订阅状态、日志缓冲等）
+        hold(16 + next_rand() % 496, cycle + 1 + next_rand() % 300);
+        release_due(cycle);
+        sample(res);
+
+        if (cycle == 0) {
+            res->first = s_buf;
+        }
+    }
+
+    res->total = s_buf;
+    res->final_permille = model_heap_fragmentation(&s_internal, &res->final_largest);
+    http_arena_free(&arena);
+    esp_http_client_cleanup(old_client);
+}
+
+int main(void)
+{
+    static const char *names[] = {"old", "arena"};
+    sim_result_t res[2];
+    for (int mode = MODE_OLD; mode <= MODE_ARENA; mode++) {
+        simulate(mode, &res[mode]);
+    }
+
+    http_buffer_stats_t stats;
+    http_service_get_buffer_stats(&stats);
+
+    printf("%d 个周期（每周期 %u 个响应），内部RAM %d KB，PSRAM %d KB\n", CYCLES, (unsigned int)ENDPOINT_COUNT,
+           INTERNAL_HEAP_SIZE / 1024, PSRAM_HEAP_SIZE / 1024);
+    printf("%-6s %12s %12s %12s %12s %10s %10s %12s %10s %9s\n", "", "allocs 1st", "allocs/cyc", "zeroed/cyc",
+           "copied/cyc", "worst ‰", "final ‰", "largest", "psram ‰", "failures");
+    for (int mode = MODE_OLD; mode <= MODE_ARENA; mode++) {
+        const sim_result_t *r = &res[mode];
+        // 稳定后的每周期平均值：不计第一个周期
+        double steady = CYCLES - 1;
+        printf("%-6s %12u %12.2f %12.0f %12.0f %10u %10u %12zu %10u %9u\n", names[mode], r->first.allocs,
+               (r->total.allocs - r->first.allocs) / steady, (r->total.zeroed - r->first.zeroed) / steady,
+               (r->total.copied - r->first.copied) / steady, r->worst_permille, r->final_permille,
+               r->final_largest, r->psram_worst_permille, r->failures);
+    }
+    printf("http_service: 读入 arena 的响应 %u 个，分配或扩容 %u 次，最大容量 %u 字节\n",
+           (unsigned int)stats.responses, (unsigned int)stats.allocs, (unsigned int)stats.peak_cap);
+    return 0;
+}
@@ -0,0 +1,158 @@
+#!/usr/bin/env python3
+# SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: CC0-1.0
+"""XML、天气和封面服务器的本地替身，用于测试条件请求（ETag/Last-Modified 与 304）
+
+只依赖标准库，提供面板请求的三个地址：
+  /main.xml                  界面XML（--xml 指定文件，否则生成占位内容）
+  /v1/forecast               与 Open-Meteo 相同格式的24小时天气
+  /convert_music_image.php   封面（--cover 指定JPEG文件，否则生成占位内容）
+
+每个响应带 ETag 和 Last-Modified，请求中的 If-None-Match / If-Modified-Since
+与当前版本一致时返回 304；--change-interval 秒后内容换成新版本。
+
+  python tools/http_cache_stub.py --port 80 --xml main.xml --change-interval 600
+
+把 main_screen.c 和 album_art_manager.c 中的 192.168.1.218 指向运行本脚本的主机，
+天气地址 api.open-meteo.com 可在路由器的 DNS 中指向同一主机。
+"""
+
+import argparse
+import email.utils
+import hashlib
+import json
+import threading
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from urllib.parse import parse_qs, urlsplit
+
+
+class Resources:
+    """按版本生成响应内容，版本变化时校验值随之变化"""
+
+    def __init__(self, args: argparse.Namespace):
+        self.args = args
+        self.start = time.time()
+        self.xml = open(args.xml, 'rb').read() if args.xml else None
+        self.cover = open(args.cover, 'rb').read() if args.cover else None
+        self.lock = threading.Lock()
+        self.stats = {'200': 0, '304': 0, 'bytes': 0, 'saved': 0}
+
+    def version(self) -> int:
+        if self.args.change_interval <= 0:
+            return 0
+        return int((time.time() - self.start) // self.args.change_interval)
+
+    def modified_time(self, version: int) -> int:
+        # 整秒：Last-Modified 的精度是秒
+        return int(self.start) + version * max(int(self.args.change_interval), 0)
+
+    def body(self, path: str, query: dict, version: int):
+        if path == '/main.xml':
+            if self.xml is not None:
+                return 'application/xml', self.xml + b'\n<!-- v%d -->\n' % version
+            text = '<component><view><lv_label text="http_cache_stub v%d"/></view></component>\n' % version
+            return 'application/xml', text.encode()
+        if path == '/v1/forecast':
+            date = query.get('start_date', ['2025-06-01'])[0]
+            hourly = {
+                'time': ['%sT%02d:00' % (date, h) for h in range(24)],
+                'temperature_2m': [round(25.0 + (h % 12) * 0.7 + version, 1) for h in range(24)],
+                'weather_code': [61 if h % 3 == 0 else 3 for h in range(24)],
+                'relative_humidity_2m': [60 + h for h in range(24)],
+                'apparent_temperature': [round(27.3 + (h % 12) * 0.9 + version, 1) for h in range(24)],
+            }
+            return 'application/json', json.dumps({'timezone': 'Asia/Shanghai', 'hourly': hourly}).encode()
+        if path == '/convert_music_image.php':
+            if self.cover is not None:
+                return 'image/jpeg', self.cover
+            # 占位内容只用于验证传输，面板解码会失败
+            seed = ('%s|%d' % (query.get('music_path', [''])[0], version)).encode()
+            return 'image/jpeg', hashlib.sha256(seed).digest() * 512
+        return None
+
+    def record(self, status: int, size: int) -> None:
+        with self.lock:
+            if status == 304:
+                self.stats['304'] += 1
+                self.stats['saved'] += size
+            else:
+                self.stats['200'] += 1
+                self.stats['bytes'] += size
+
+
+class Handler(BaseHTTPRequestHandler):
+    protocol_version = 'HTTP/1.1'   # 面板复用长连接
+    resources: Resources = None
+
+    def do_GET(self) -> None:
+        url = urlsplit(self.path)
+        version = self.resources.version()
+        found = self.resources.body(url.path, parse_qs(url.query), version)
+        if found is None:
+            self.send_response(404)
+            self.send_header('Content-Length', '0')
+            self.end_headers()
+            return
+        content_type, body = found
+        args = self.resources.args
+        etag = '"%s"' % hashlib.sha1(body).hexdigest()[:16]
+        modified = self.resources.modified_time(version)
+
+        # If-None-Match 优先，没有时才比较 If-Modified-Since（RFC 9110 13.2.2）
+        not_modified = False
+        if_none_match = self.headers.get('If-None-Match')
+        if_modified_since = self.headers.get('If-Modified-Since')
+        if if_none_match is not None and not args.no_etag:
+            not_modified = etag in [tag.strip() for tag in if_none_match.split(',')] or if_none_match.strip() == '*'
+        elif if_modified_since is not None and not args.no_last_modified:
+            try:
+                since = email.utils.parsedate_to_datetime(if_modified_since).timestamp()
+                not_modified = modified <= since
+            except (TypeError, ValueError):
+                pass
+
+        status = 304 if not_modified else 200
+        self.resources.record(status, len(body))
+        self.send_response(status)
+        if not args.no_etag:
+            self.send_header('ETag', etag)
+        if not args.no_last_modified:
+            self.send_header('Last-Modified', email.utils.formatdate(modified, usegmt=True))
+        if not_modified:
+            self.send_header('Content-Length', '0')
+            self.end_headers()
+        else:
+            self.send_header('Content-Type', content_type)
+            self.send_header('Content-Length', str(len(body)))
+            self.end_headers()
+            self.wfile.write(body)
+
+    def log_message(self, fmt: str, *fmt_args) -> None:
+        stats = self.resources.stats
+        print('%s %s  [200: %d, %d 字节; 304: %d, 省去 %d 字节]' % (
+            self.address_string(), fmt % fmt_args, stats['200'], stats['bytes'], stats['304'], stats['saved']))
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--host', default='0.0.0.0')
+    parser.add_argument('--port', type=int, default=80)
+    parser.add_argument('--xml', help='/main.xml 返回的文件')
+    parser.add_argument('--cover', help='/convert_music_image.php 返回的JPEG文件')
+    parser.add_argument('--change-interval', type=float, default=0, help='每隔多少秒换一个内容版本，0 表示不变')
+    parser.add_argument('--no-etag', action='store_true', help='不发送 ETag，只用 Last-Modified')
+    parser.add_argument('--no-last-modified', action='store_true', help='不发送 Last-Modified，只用 ETag')
+    args = parser.parse_args()
+
+    Handler.resources = Resources(args)
+    server = ThreadingHTTPServer((args.host, args.port), Handler)
+    print('http_cache_stub 监听 %s:%d' % (args.host, args.port))
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,145 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+/*
+ * 主机端微基准：比较 json_extract 与 cJSON 从 Tasmota SENSOR 数据中读取
+ * ENERGY.Power/Voltage/Current/Total 的耗时和堆分配次数。
+ *
+ * 编译（在项目根目录，需先运行 ESP-IDF 的 export 脚本）：
+ *   gcc -O2 -Imain/include -I$IDF_PATH/components/json/cJSON \
+ *       tools/json_extract_bench.c main/src/json_extract.c $IDF_PATH/components/json/cJSON/cJSON.c \
+ *       -lm -o json_extract_bench
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "cJSON.h"
+#include "json_extract.h"
+
+// 每种数据的解析次数
+#define BENCH_ITERATIONS 200000
+
+// Tasmota 实际上报的数据：单路插座（与 main/bench/mqtt_trace.txt 相同）、带传感器的插座、多路插座
+static const char *const s_payloads[] = {
+    "{\"Time\":\"2025-06-01T20:15:10\",\"ENERGY\":{\"TotalStartTime\":\"2024-11-02T10:21:44\",\"Total\":312.457,"
+    "\"Yesterday\":3.912,\"Today\":1.208,\"Period\":2,\"Power\":136,\"ApparentPower\":149,\"ReactivePower\":31,"
+    "\"Factor\":0.93,\"Voltage\":228,\"Current\":0.612}}",
+
+    "{\"Time\":\"2025-06-01T20:15:20\",\"ANALOG\":{\"Temperature\":31.2},\"DS18B20\":{\"Id\":\"0316A27956FF\","
+    "\"Temperature\":24.6},\"ENERGY\":{\"TotalStartTime\":\"2024-11-02T10:21:44\",\"Total\":1024.018,"
+    "\"Yesterday\":5.301,\"Today\":2.774,\"Period\":[3,0],\"Power\":[412,0],\"ApparentPower\":[430,0],"
+    "\"ReactivePower\":[122,0],\"Factor\":[0.96,0.00],\"Voltage\":231,\"Current\":[1.861,0.000]},"
+    "\"TempUnit\":\"C\"}",
+
+    "{\"Time\":\"2025-06-01T20:15:30\",\"ENERGY\":{\"TotalStartTime\":\"2024-11-02T10:21:44\",\"Total\":87.003,"
+    "\"Yesterday\":0.410,\"Today\":0.092,\"Period\":0,\"Power\":0,\"ApparentPower\":0,\"ReactivePower\":0,"
+    "\"Factor\":0.00,\"Voltage\":0,\"Current\":0.000}}",
+};
+
+static const char *const s_paths[] = {"ENERGY.Power", "ENERGY.Voltage", "ENERGY.Current", "ENERGY.Total"};
+
+#define FIELD_COUNT (sizeof(s_paths) / sizeof(s_paths[0]))
+
+static unsigned long s_allocs = 0;
+
+static void *counting_malloc(size_t size)
+{
+    s_allocs++;
+    return malloc(size);
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// 与旧实现相同：构建完整的 DOM 后按路径查找，数组值视为缺失
+static int extract_cjson(const char *payload, double *values)
+{
+    int found = 0;
+    cJSON *root = cJSON_Parse(payload);
+    if (root != NULL) {
+        cJSON *energy = cJSON_GetObjectItem(root, "ENERGY");
+        for (size_t i = 0; i < FIELD_COUNT; i++) {
+            cJSON *item = cJSON_GetObjectItem(energy, s_paths[i] + strlen("ENERGY."));
+            values[i] = NAN;
+            if (item != NULL && cJSON_IsNumber(item)) {
+                values[i] = item->valuedouble;
+                found++;
+            }
+        }
+        cJSON_Delete(root);
+    }
+    return found;
+}
+
+static int extract_streaming(const char *payload, size_t len, double *values)
+{
+    json_field_t fields[FIELD_COUNT];
+    for (size_t i = 0; i < FIELD_COUNT; i++) {
+        fields[i].path = s_paths[i];
+    }
+    json_extract(payload, len, fields, FIELD_COUNT);
+
+    int found = 0;
+    for (size_t i = 0; i < FIELD_COUNT; i++) {
+        values[i] = NAN;
+        if (json_field_number(&fields[i], &values[i])) {
+            found++;
+        }
+    }
+    return found;
+}
+
+int main(void)
+{
+    cJSON_Hooks hooks = {.malloc_fn = counting_malloc, .free_fn = free};
+    cJSON_InitHooks(&hooks);
+
+    printf("%-8s %6s %12s %12s %8s %12s\n", "payload", "bytes", "cJSON ns", "extract ns", "speedup", "cJSON allocs");
+    for (size_t p = 0; p < sizeof(s_payloads) / sizeof(s_payloads[0]); p++) {
+        const char *payload = s_payloads[p];
+        size_t len = strlen(payload);
+        double expected[FIELD_COUNT];
+        double actual[FIELD_COUNT];
+
+        // 两种实现的结果必须一致
+        extract_cjson(payload, expected);
+        extract_streaming(payload, len, actual);
+        for (size_t i = 0; i < FIELD_COUNT; i++) {
+            if (!(expected[i] == actual[i] || (isnan(expected[i]) && isnan(actual[i])))) {
+                fprintf(stderr, "payload %zu: %s 不一致 (cJSON %g, extract %g)\n", p, s_paths[i], expected[i],
+                        actual[i]);
+                return 1;
+            }
+        }
+
+        volatile int sink = 0;
+        s_allocs = 0;
+        double start = now_ns();
+        for (int i = 0; i < BENCH_ITERATIONS; i++) {
+            sink += extract_cjson(payload, expected);
+        }
+        double cjson_ns = (now_ns() - start) / BENCH_ITERATIONS;
+        unsigned long allocs = s_allocs / BENCH_ITERATIONS;
+
+        start = now_ns();
+        for (int i = 0; i < BENCH_ITERATIONS; i++) {
+            sink += extract_streaming(payload, len, actual);
+        }
+        double extract_ns = (now_ns() - start) / BENCH_ITERATIONS;
+        (void)sink;
+
+        printf("%-8zu %6zu %12.1f %12.1f %7.1fx %12lu\n", p, len, cjson_ns, extract_ns, cjson_ns / extract_ns,
+               allocs);
+    }
+    return 0;
+}
@@ -0,0 +1,241 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+/*
+ * 主机端基准：比较天气刷新时"完整接收响应 + cJSON"与 json_stream 分块解析
+ * 的峰值堆占用和耗时，并检查两者解析出的24小时数据一致。
+ *
+ * 编译（在项目根目录，需先运行 ESP-IDF 的 export 脚本）：
+ *   gcc -O2 -Imain/include -I$IDF_PATH/components/json/cJSON \
+ *       tools/json_stream_bench.c main/src/json_stream.c main/src/json_extract.c \
+ *       $IDF_PATH/components/json/cJSON/cJSON.c -lm -o json_stream_bench
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "cJSON.h"
+#include "json_stream.h"
+
+// 每种方式的解析次数
+#define BENCH_ITERATIONS 20000
+
+// 与 http_service 相同：完整接收时缓冲区按 4 KB 增长，流式接收每次读 256 字节
+#define RESPONSE_BUF_STEP 4096
+#define STREAM_CHUNK 256
+
+#define HOURS 24
+
+typedef struct {
+    float temperature;
+    float apparent_temperature;
+    int weather_code;
+    int humidity;
+} hourly_weather_t;
+
+// 统计当前和峰值堆占用，每块前面记录大小
+static size_t s_heap_now = 0;
+static size_t s_heap_peak = 0;
+
+static void *counting_malloc(size_t size)
+{
+    size_t *p = malloc(sizeof(size_t) + size);
+    *p = size;
+    s_heap_now += size;
+    if (s_heap_now > s_heap_peak) {
+        s_heap_peak = s_heap_now;
+    }
+    return p + 1;
+}
+
+static void counting_free(void *ptr)
+{
+    if (ptr != NULL) {
+        size_t *p = (size_t *)ptr - 1;
+        s_heap_now -= *p;
+        free(p);
+    }
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// 与 ha_monitor_task 请求的 Open-Meteo 响应格式相同
+static size_t build_response(char *buf, size_t size)
+{
+    size_t len = snprintf(buf, size,
+                          "{\"latitude\":22.5,\"longitude\":113.25,\"generationtime_ms\":0.0429,"
+                          "\"utc_offset_seconds\":28800,\"timezone\":\"Asia/Shanghai\",\"timezone_abbreviation\":\"GMT+8\","
+                          "\"elevation\":6.0,\"hourly_units\":{\"time\":\"iso8601\",\"temperature_2m\":\"°C\","
+                          "\"weather_code\":\"wmo code\",\"relative_humidity_2m\":\"%%\",\"apparent_temperature\":\"°C\"},"
+                          "\"hourly\":{\"time\":[");
+    for (int i = 0; i < HOURS; i++) {
+        len += snprintf(buf + len, size - len, "%s\"2025-06-01T%02d:00\"", i ? "," : "", i);
+    }
+    len += snprintf(buf + len, size - len, "],\"temperature_2m\":[");
+    for (int i = 0; i < HOURS; i++) {
+        len += snprintf(buf + len, size - len, "%s%.1f", i ? "," : "", 25.0 + (i % 12) * 0.7);
+    }
+    len += snprintf(buf + len, size - len, "],\"weather_code\":[");
+    for (int i = 0; i < HOURS; i++) {
+        len += snprintf(buf + len, size - len, "%s%d", i ? "," : "", (i % 3 == 0) ? 61 : 3);
+    }
+    len += snprintf(buf + len, size - len, "],\"relative_humidity_2m\":[");
+    for (int i = 0; i < HOURS; i++) {
+        len += snprintf(buf + len, size - len, "%s%d", i ? "," : "", 60 + i);
+    }
+    len += snprintf(buf + len, size - len, "],\"apparent_temperature\":[");
+    for (int i = 0; i < HOURS; i++) {
+        len += snprintf(buf + len, size - len, "%s%.1f", i ? "," : "", 27.3 + (i % 12) * 0.9);
+    }
+    len += snprintf(buf + len, size - len, "]}}");
+    return len;
+}
+
+// 旧实现：响应读入按 4 KB 增长的缓冲区，再构建完整的 DOM
+static int parse_cjson(const char *response, size_t len, hourly_weather_t *hours)
+{
+    size_t cap = RESPONSE_BUF_STEP;
+    char *buf = counting_malloc(cap);
+    size_t used = 0;
+    while (used < len) {
+        if (used >= cap - 1) {
+            char *bigger = counting_malloc(cap + RESPONSE_BUF_STEP);
+            memcpy(bigger, buf, used);
+            counting_free(buf);
+            buf = bigger;
+            cap += RESPONSE_BUF_STEP;
+        }
+        size_t n = (len - used < cap - 1 - used) ? len - used : cap - 1 - used;
+        memcpy(buf + used, response + used, n);
+        used += n;
+    }
+    buf[used] = '\0';
+
+    int count = 0;
+    cJSON *root = cJSON_Parse(buf);
+    cJSON *hourly = cJSON_GetObjectItem(root, "hourly");
+    cJSON *temps = cJSON_GetObjectItem(hourly, "temperature_2m");
+    cJSON *codes = cJSON_GetObjectItem(hourly, "weather_code");
+    cJSON *hums = cJSON_GetObjectItem(hourly, "relative_humidity_2m");
+    cJSON *apparent = cJSON_GetObjectItem(hourly, "apparent_temperature");
+    count = cJSON_GetArraySize(cJSON_GetObjectItem(hourly, "time"));
+    count = (count > HOURS) ? HOURS : count;
+    for (int i = 0; i < count; i++) {
+        hours[i].temperature = cJSON_GetArrayItem(temps, i)->valuedouble;
+        hours[i].apparent_temperature = cJSON_GetArrayItem(apparent, i)->valuedouble;
+        hours[i].weather_code = cJSON_GetArrayItem(codes, i)->valueint;
+        hours[i].humidity = (int)cJSON_GetArrayItem(hums, i)->valuedouble;
+    }
+    cJSON_Delete(root);
+    counting_free(buf);
+    return count;
+}
+
+typedef struct {
+    hourly_weather_t *hours;
+    int count;
+} stream_ctx_t;
+
+static void on_time(void *ctx, const json_field_t *field, int index)
+{
+    stream_ctx_t *c = ctx;
+    if (index < HOURS && index + 1 > c->count) {
+        c->count = index + 1;
+    }
+}
+
+static void on_value(void *ctx, const json_field_t *field, int index)
+{
+    stream_ctx_t *c = ctx;
+    double value;
+    if (index < 0 || index >= HOURS || !json_field_number(field, &value)) {
+        return;
+    }
+    const char *name = field->path + strlen("hourly.");
+    if (strncmp(name, "temperature_2m", 14) == 0) {
+        c->hours[index].temperature = value;
+    } else if (strncmp(name, "apparent_temperature", 20) == 0) {
+        c->hours[index].apparent_temperature = value;
+    } else if (strncmp(name, "weather_code", 12) == 0) {
+        c->hours[index].weather_code = (int)value;
+    } else {
+        c->hours[index].humidity = (int)value;
+    }
+}
+
+// 新实现：按 256 字节分块喂给 json_stream，结果直接写入目标数组
+static int parse_stream(const char *response, size_t len, hourly_weather_t *hours)
+{
+    stream_ctx_t ctx = {.hours = hours};
+    const json_stream_sub_t subs[] = {
+        {"hourly.time[*]", on_time, &ctx},
+        {"hourly.temperature_2m[*]", on_value, &ctx},
+        {"hourly.apparent_temperature[*]", on_value, &ctx},
+        {"hourly.weather_code[*]", on_value, &ctx},
+        {"hourly.relative_humidity_2m[*]", on_value, &ctx},
+    };
+    json_stream_t parser;
+    json_stream_init(&parser, subs, sizeof(subs) / sizeof(subs[0]));
+    for (size_t off = 0; off < len; off += STREAM_CHUNK) {
+        char chunk[STREAM_CHUNK];
+        size_t n = (len - off < STREAM_CHUNK) ? len - off : STREAM_CHUNK;
+        memcpy(chunk, response + off, n);
+        if (json_stream_feed(&parser, chunk, n) != 0) {
+            return -1;
+        }
+    }
+    return (json_stream_finish(&parser) == 0) ? ctx.count : -1;
+}
+
+int main(void)
+{
+    cJSON_Hooks hooks = {.malloc_fn = counting_malloc, .free_fn = counting_free};
+    cJSON_InitHooks(&hooks);
+
+    static char response[8192];
+    size_t len = build_response(response, sizeof(response));
+
+    // 两种实现的结果必须一致
+    hourly_weather_t expected[HOURS] = {0};
+    hourly_weather_t actual[HOURS] = {0};
+    s_heap_peak = 0;
+    int expected_count = parse_cjson(response, len, expected);
+    size_t cjson_peak = s_heap_peak;
+    s_heap_peak = 0;
+    int actual_count = parse_stream(response, len, actual);
+    size_t stream_peak = s_heap_peak;
+    if (expected_count != actual_count || memcmp(expected, actual, sizeof(expected)) != 0) {
+        fprintf(stderr, "结果不一致 (cJSON %d 小时, stream %d 小时)\n", expected_count, actual_count);
+        return 1;
+    }
+
+    volatile int sink = 0;
+    double start = now_ns();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        sink += parse_cjson(response, len, expected);
+    }
+    double cjson_us = (now_ns() - start) / BENCH_ITERATIONS / 1000;
+
+    start = now_ns();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        sink += parse_stream(response, len, actual);
+    }
+    double stream_us = (now_ns() - start) / BENCH_ITERATIONS / 1000;
+    (void)sink;
+
+    printf("响应 %zu 字节，%d 小时\n", len, expected_count);
+    printf("%-14s %10s %12s %10s\n", "", "time us", "heap peak", "stack");
+    printf("%-14s %10.1f %12zu %10s\n", "cJSON", cjson_us, cjson_peak, "-");
+    printf("%-14s %10.1f %12zu %10zu\n", "json_stream", stream_us, stream_peak,
+           sizeof(json_stream_t) + STREAM_CHUNK);
+    return 0;
+}
@@ -0,0 +1,222 @@
+#!/usr/bin/env python3
+# SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: CC0-1.0
+"""MQTT流量捕获文件工具（格式见 main/include/mqtt_capture.h）
+
+  extract   从串口监视器日志中提取 MQCAP: 行，还原为二进制捕获文件
+  info      打印捕获文件中的消息
+  publish   按原始时间间隔把捕获的消息发布到MQTT服务器（需要 paho-mqtt）
+  to-trace  转换为 mqtt_replay 使用的文本样本（main/bench/mqtt_trace.txt）
+  flash     写入设备的 mqttcap 分区，CONFIG_SMART_PANEL_MQTT_REPLAY 启用时设备直接回放
+"""
+
+import argparse
+import base64
+import os
+import struct
+import subprocess
+import sys
+import time
+from typing import Iterator, NamedTuple
+
+MAGIC = 0x5043514D
+VERSION = 1
+HEADER = struct.Struct('<IHHII')     # magic, version, header_size, record_count, data_size
+RECORD = struct.Struct('<IIHBB')     # delta_us, data_len, topic_len, qos, retain
+DUMP_PREFIX = 'MQCAP:'
+PARTITION = 'mqttcap'
+
+
+class Message(NamedTuple):
+    time_us: int        # 距开始捕获的微秒数
+    topic: bytes
+    data: bytes
+    qos: int
+    retain: int
+
+
+def parse(blob: bytes) -> Iterator[Message]:
+    if len(blob) < HEADER.size:
+        raise ValueError('文件过短')
+    magic, version, header_size, count, data_size = HEADER.unpack_from(blob)
+    if magic != MAGIC or version != VERSION:
+        raise ValueError('不是有效的MQTT捕获文件')
+    if header_size + data_size > len(blob):
+        raise ValueError('捕获数据不完整')
+
+    pos = header_size
+    end = header_size + data_size
+    now = 0
+    for _ in range(count):
+        if pos + RECORD.size > end:
+            raise ValueError('记录头截断')
+        delta, data_len, topic_len, qos, retain = RECORD.unpack_from(blob, pos)
+        pos += RECORD.size
+        if pos + topic_len + data_len > end:
+            raise ValueError('记录内容截断')
+        topic = blob[pos:pos + topic_len]
+        data = blob[pos + topic_len:pos + topic_len + data_len]
+        pos += topic_len + data_len
+        now += delta
+        yield Message(now, topic, data, qos, retain)
+
+
+def cmd_extract(args: argparse.Namespace) -> None:
+    chunks = []
+    expected = None
+    with open(args.log, 'r', encoding='utf-8', errors='replace') as f:
+        for line in f:
+            idx = line.find(DUMP_PREFIX)
+            if idx < 0:
+                continue
+            text = line[idx + len(DUMP_PREFIX):].strip()
+            if text.startswith('BEGIN'):
+                # 只保留日志中最后一次输出
+                chunks = []
+                expected = int(text.split()[1])
+            elif text == 'END':
+                continue
+            else:
+                chunks.append(base64.b64decode(text))
+    blob = b''.join(chunks)
+    if expected is None:
+        sys.exit('日志中没有找到捕获数据')
+    if len(blob) != expected:
+        sys.exit(f'捕获数据不完整: {len(blob)}/{expected} 字节')
+    count = sum(1 for _ in parse(blob))
+    with open(args.output, 'wb') as f:
+        f.write(blob)
+    print(f'已写入 {args.output}: {count} 条消息, {len(blob)} 字节')
+
+
+def cmd_info(args: argparse.Namespace) -> None:
+    with open(args.capture, 'rb') as f:
+        blob = f.read()
+    count = 0
+    last = 0
+    for msg in parse(blob):
+        count += 1
+        last = msg.time_us
+        if not args.summary:
+            data = msg.data.decode('utf-8', errors='replace')
+            if len(data) > args.width:
+                data = data[:args.width] + '...'
+            print(f'{msg.time_us / 1e6:12.6f} q{msg.qos}{"r" if msg.retain else " "} '
+                  f'{msg.topic.decode("utf-8", errors="replace")} {data!r}')
+    print(f'{count} 条消息, 时长 {last / 1e6:.3f} 秒, {len(blob)} 字节')
+
+
+def cmd_publish(args: argparse.Namespace) -> None:
+    try:
+        import paho.mqtt.client as mqtt
+    except ImportError:
+        sys.exit('需要 paho-mqtt: pip install paho-mqtt')
+
+    with open(args.capture, 'rb') as f:
+        messages = list(parse(f.read()))
+
+    client = mqtt.Client(client_id=args.client_id)
+    if args.username:
+        client.username_pw_set(args.username, args.password)
+    client.connect(args.host, args.port)
+    client.loop_start()
+
+    for loop in range(args.loops):
+        start = time.monotonic()
+        for msg in messages:
+            if args.speed > 0:
+                delay = start + msg.time_us / 1e6 / args.speed - time.monotonic()
+                if delay > 0:
+                    time.sleep(delay)
+            # 回放时默认不带保留标志，避免污染服务器上的保留消息
+            retain = bool(msg.retain) and args.keep_retain
+            client.publish(msg.topic.decode('utf-8'), msg.data, qos=msg.qos, retain=retain)
+        print(f'第 {loop + 1} 轮: 发布 {len(messages)} 条, 用时 {time.monotonic() - start:.3f} 秒')
+
+    client.loop_stop()
+    client.disconnect()
+
+
+def cmd_to_trace(args: argparse.Namespace) -> None:
+    with open(args.capture, 'rb') as f:
+        messages = list(parse(f.read()))
+
+    lines = ['# 由 tools/mqtt_capture.py 从 ' + os.path.basename(args.capture) + ' 转换',
+             '# 格式：<距上一条的毫秒数> <主题> <数据>，数据为行内剩余部分']
+    last_ms = 0
+    skipped = 0
+    for msg in messages:
+        data = msg.data.decode('utf-8', errors='replace')
+        # 文本样本按行分隔，无法表示多行数据
+        if '\n' in data or '\r' in data:
+            skipped += 1
+            continue
+        now_ms = msg.time_us // 1000
+        lines.append(f'{now_ms - last_ms} {msg.topic.decode("utf-8")} {data}')
+        last_ms = now_ms
+    with open(args.output, 'w', encoding='utf-8') as f:
+        f.write('\n'.join(lines) + '\n')
+    print(f'已写入 {args.output}: {len(messages) - skipped} 条消息, 跳过 {skipped} 条多行消息')
+
+
+def cmd_flash(args: argparse.Namespace) -> None:
+    with open(args.capture, 'rb') as f:
+        parse_count = sum(1 for _ in parse(f.read()))
+    idf_path = os.environ.get('IDF_PATH')
+    if not idf_path:
+        sys.exit('请先运行 ESP-IDF 的 export 脚本')
+    parttool = os.path.join(idf_path, 'components', 'partition_table', 'parttool.py')
+    cmd = [sys.executable, parttool]
+    if args.port:
+        cmd += ['--port', args.port]
+    cmd += ['write_partition', '--partition-name', PARTITION, '--input', args.capture]
+    subprocess.run(cmd, check=True)
+    print(f'已写入 {PARTITION} 分区: {parse_count} 条消息')
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = parser.add_subparsers(dest='command', required=True)
+
+    p = sub.add_parser('extract', help='从串口日志提取捕获文件')
+    p.add_argument('log', help='idf.py monitor 的日志文件')
+    p.add_argument('-o', '--output', default='capture.mqcap')
+    p.set_defaults(func=cmd_extract)
+
+    p = sub.add_parser('info', help='打印捕获文件内容')
+    p.add_argument('capture')
+    p.add_argument('--summary', action='store_true', help='只打印统计')
+    p.add_argument('--width', type=int, default=80, help='数据最多显示的字符数')
+    p.set_defaults(func=cmd_info)
+
+    p = sub.add_parser('publish', help='回放到MQTT服务器')
+    p.add_argument('capture')
+    p.add_argument('--host', default='localhost')
+    p.add_argument('--port', type=int, default=1883)
+    p.add_argument('--username')
+    p.add_argument('--password')
+    p.add_argument('--client-id', default='mqtt_capture_replay')
+    p.add_argument('--speed', type=float, default=1.0, help='回放倍速，0 表示不等待')
+    p.add_argument('--loops', type=int, default=1)
+    p.add_argument('--keep-retain', action='store_true', help='保留原始的保留标志')
+    p.set_defaults(func=cmd_publish)
+
+    p = sub.add_parser('to-trace', help='转换为 mqtt_replay 文本样本')
+    p.add_argument('capture')
+    p.add_argument('-o', '--output', default='mqtt_trace.txt')
+    p.set_defaults(func=cmd_to_trace)
+
+    p = sub.add_parser('flash', help='写入设备的 mqttcap 分区')
+    p.add_argument('capture')
+    p.add_argument('-p', '--port', help='串口')
+    p.set_defaults(func=cmd_flash)
+
+    args = parser.parse_args()
+    try:
+        args.func(args)
+    except ValueError as e:
+        sys.exit(f'错误: {e}')
+
+
+if __name__ == '__main__':
+    main()
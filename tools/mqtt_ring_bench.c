@@ -0,0 +1,295 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+/*
+ * 主机端基准：比较入站MQTT消息的两种交接方式，生产者和消费者各一个线程。
+ *   malloc：旧实现，消息容器、主题、数据各 malloc 一次，指针经加锁队列交给消费者后释放
+ *   ring：  mqtt_ring_write 把消息写入 SPSC 环形缓冲区，消费者 peek/pop，不分配内存
+ * 两种方式都用信号量充当门铃（设备上是事件队列和门铃信号量）。
+ *
+ * 先按 1 kHz 匀速发送（模拟消息风暴下的持续速率），统计生产者耗时和端到端延迟；
+ * 再连续发送测吞吐量，队列或缓冲区满时生产者让出CPU后重试，不丢消息。
+ * 消息取自播放器的真实主题和数据长度。
+ *
+ * 编译（在项目根目录）：
+ *   gcc -O2 -pthread -Itools/host -Imain/include tools/mqtt_ring_bench.c main/src/mqtt_ring.c -o mqtt_ring_bench
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "mqtt_ring.h"
+
+// 与 mqtt_client.c 的 BULK 通道环形缓冲区相同
+#define RING_CAPACITY (16 * 1024)
+
+// 旧实现的事件队列长度（两个通道各10项）
+#define QUEUE_LENGTH 20
+
+// 匀速阶段：速率和持续时间
+#define PACED_RATE_HZ 1000
+#define PACED_SECONDS 3
+
+// 连续发送阶段的消息数
+#define BURST_MESSAGES 1000000
+
+// 延迟直方图的上限（微秒），超过的计入最后一格
+#define LATENCY_MAX_US 2000
+
+typedef enum {
+    MODE_MALLOC,
+    MODE_RING,
+} bench_mode_t;
+
+static const struct {
+    const char *topic;
+    const char *data;
+} s_messages[] = {
+    {"homeassistant/number/esp32_music_player/position/state", "0.0374"},
+    {"homeassistant/sensor/esp32_music_player/progress/state", "00:10 / 04:29"},
+    {"homeassistant/sensor/esp32_music_player/lyrics/state", "从出生那年就飘着"},
+    {"homeassistant/number/esp32_music_player/volume/state", "35"},
+};
+
+#define MESSAGE_KINDS (sizeof(s_messages) / sizeof(s_messages[0]))
+
+// 旧实现的消息交接队列
+typedef struct {
+    mqtt_message_t *items[QUEUE_LENGTH];
+    uint32_t head;
+    uint32_t tail;
+    portMUX_TYPE lock;
+} ptr_queue_t;
+
+typedef struct {
+    bench_mode_t mode;
+    uint32_t count;             // 发送的消息数
+    uint32_t rate_hz;           // 0 表示连续发送
+    mqtt_ring_t *ring;
+    ptr_queue_t queue;
+    sem_t doorbell;
+    volatile bool producer_done;
+
+    // 生产者统计
+    uint32_t dropped;           // 匀速发送时因队列或缓冲区满丢弃的消息数
+    uint32_t full_retries;      // 连续发送时因队列或缓冲区满重试的次数
+    uint32_t heap_calls;
+    double producer_ns;
+
+    // 消费者统计
+    uint32_t received;
+    uint32_t latency_hist[LATENCY_MAX_US + 1];
+} bench_t;
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static bool queue_push(ptr_queue_t *q, mqtt_message_t *msg)
+{
+    bool ok = false;
+    portENTER_CRITICAL(&q->lock);
+    if (q->head - q->tail < QUEUE_LENGTH) {
+        q->items[q->head++ % QUEUE_LENGTH] = msg;
+        ok = true;
+    }
+    portEXIT_CRITICAL(&q->lock);
+    return ok;
+}
+
+static mqtt_message_t *queue_pop(ptr_queue_t *q)
+{
+    mqtt_message_t *msg = NULL;
+    portENTER_CRITICAL(&q->lock);
+    if (q->head != q->tail) {
+        msg = q->items[q->tail++ % QUEUE_LENGTH];
+    }
+    portEXIT_CRITICAL(&q->lock);
+    return msg;
+}
+
+// 旧实现的 mqtt_event_handler：三次 malloc 后放入队列
+static bool produce_malloc(bench_t *b, const char *topic, int topic_len, const char *data, int data_len)
+{
+    mqtt_message_t *msg = malloc(sizeof(mqtt_message_t));
+    msg->topic = malloc(topic_len + 1);
+    msg->data = malloc(data_len + 1);
+    b->heap_calls += 3;
+    memcpy(msg->topic, topic, topic_len + 1);
+    memcpy(msg->data, data, data_len + 1);
+    msg->data_len = data_len;
+    msg->recv_time = (uint32_t)esp_timer_get_time();
+    if (!queue_push(&b->queue, msg)) {
+        free(msg->data);
+        free(msg->topic);
+        free(msg);
+        return false;
+    }
+    return true;
+}
+
+static void *producer_task(void *arg)
+{
+    bench_t *b = arg;
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    double busy_ns = 0;
+
+    for (uint32_t i = 0; i < b->count; i++) {
+        if (b->rate_hz > 0) {
+            next.tv_nsec += 1000000000L / b->rate_hz;
+            if (next.tv_nsec >= 1000000000L) {
+                next.tv_nsec -= 1000000000L;
+                next.tv_sec++;
+            }
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+        }
+
+        const char *topic = s_messages[i % MESSAGE_KINDS].topic;
+        const char *data = s_messages[i % MESSAGE_KINDS].data;
+        bool ok;
+        while (true) {
+            double start = now_ns();
+            if (b->mode == MODE_MALLOC) {
+                ok = produce_malloc(b, topic, strlen(topic), data, strlen(data));
+            } else {
+                ok = mqtt_ring_write(b->ring, topic, strlen(topic), data, strlen(data), 0, 0,
+                                     (uint32_t)esp_timer_get_time());
+            }
+            busy_ns += now_ns() - start;
+            if (ok || b->rate_hz > 0) {
+                break;
+            }
+            b->full_retries++;
+            sched_yield();
+        }
+        if (ok) {
+            sem_post(&b->doorbell);
+        } else {
+            b->dropped++;
+        }
+    }
+
+    b->producer_ns = busy_ns / b->count;
+    __atomic_store_n(&b->producer_done, true, __ATOMIC_RELEASE);
+    sem_post(&b->doorbell);
+    return NULL;
+}
+
+static void record_latency(bench_t *b, uint32_t recv_time)
+{
+    uint32_t latency = (uint32_t)esp_timer_get_time() - recv_time;
+    b->latency_hist[(latency < LATENCY_MAX_US) ? latency : LATENCY_MAX_US]++;
+    b->received++;
+}
+
+// 事件处理任务：门铃响后取空所有消息
+static void *consumer_task(void *arg)
+{
+    bench_t *b = arg;
+    while (true) {
+        sem_wait(&b->doorbell);
+        if (b->mode == MODE_MALLOC) {
+            mqtt_message_t *msg;
+            while ((msg = queue_pop(&b->queue)) != NULL) {
+                record_latency(b, msg->recv_time);
+                free(msg->data);
+                free(msg->topic);
+                free(msg);
+            }
+        } else {
+            mqtt_message_t msg;
+            while (mqtt_ring_peek(b->ring, &msg)) {
+                record_latency(b, msg.recv_time);
+                mqtt_ring_pop(b->ring);
+            }
+        }
+        if (__atomic_load_n(&b->producer_done, __ATOMIC_ACQUIRE) &&
+            b->received + b->dropped >= b->count) {
+            return NULL;
+        }
+    }
+}
+
+static uint32_t percentile(const bench_t *b, double p)
+{
+    uint32_t target = (uint32_t)(b->received * p);
+    uint32_t seen = 0;
+    for (uint32_t us = 0; us <= LATENCY_MAX_US; us++) {
+        seen += b->latency_hist[us];
+        if (seen > target) {
+            return us;
+        }
+    }
+    return LATENCY_MAX_US;
+}
+
+// 环形缓冲区在每轮结束时已被取空，各轮共用
+static double run(bench_t *b, mqtt_ring_t *ring, bench_mode_t mode, uint32_t count, uint32_t rate_hz)
+{
+    memset(b, 0, sizeof(*b));
+    b->mode = mode;
+    b->count = count;
+    b->rate_hz = rate_hz;
+    b->ring = ring;
+    b->queue.lock = (portMUX_TYPE)portMUX_INITIALIZER_UNLOCKED;
+    sem_init(&b->doorbell, 0, 0);
+
+    pthread_t producer;
+    pthread_t consumer;
+    double start = now_ns();
+    pthread_create(&consumer, NULL, consumer_task, b);
+    pthread_create(&producer, NULL, producer_task, b);
+    pthread_join(producer, NULL);
+    pthread_join(consumer, NULL);
+    double elapsed_s = (now_ns() - start) / 1e9;
+
+    sem_destroy(&b->doorbell);
+    return elapsed_s;
+}
+
+int main(void)
+{
+    static bench_t bench;
+    static const char *names[] = {"malloc", "ring"};
+    mqtt_ring_t *ring = mqtt_ring_create(RING_CAPACITY);
+    if (ring == NULL) {
+        return 1;
+    }
+
+    printf("匀速 %d Hz，%d 秒\n", PACED_RATE_HZ, PACED_SECONDS);
+    printf("%-8s %10s %12s %10s %10s %10s %10s\n", "", "received", "heap calls", "prod ns", "p50 us",
+           "p99 us", "max us");
+    for (int mode = MODE_MALLOC; mode <= MODE_RING; mode++) {
+        run(&bench, ring, mode, PACED_RATE_HZ * PACED_SECONDS, PACED_RATE_HZ);
+        uint32_t max_us = 0;
+        for (uint32_t us = 0; us <= LATENCY_MAX_US; us++) {
+            if (bench.latency_hist[us] > 0) {
+                max_us = us;
+            }
+        }
+        printf("%-8s %10u %12u %10.0f %10u %10u %10u\n", names[mode], bench.received, bench.heap_calls,
+               bench.producer_ns, percentile(&bench, 0.5), percentile(&bench, 0.99), max_us);
+    }
+
+    printf("\n连续发送 %d 条\n", BURST_MESSAGES);
+    printf("%-8s %10s %12s %12s %10s\n", "", "received", "full retries", "msg/s", "prod ns");
+    for (int mode = MODE_MALLOC; mode <= MODE_RING; mode++) {
+        double elapsed_s = run(&bench, ring, mode, BURST_MESSAGES, 0);
+        printf("%-8s %10u %12u %12.0f %10.0f\n", names[mode], bench.received, bench.full_retries,
+               bench.received / elapsed_s, bench.producer_ns);
+    }
+    return 0;
+}
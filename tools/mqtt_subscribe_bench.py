@@ -0,0 +1,340 @@
+#!/usr/bin/env python3
+# SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: CC0-1.0
+"""测量重连到首条更新的耗时，比较面板的三种订阅方式
+
+  per-topic  每个路由一个 SUBSCRIBE 包，依次发送（批量订阅之前的做法）
+  batched    所有路由合并进一个 SUBSCRIBE 包（CONFIG_SMART_PANEL_MQTT_WILDCARD_SUBSCRIBE=n）
+  wildcard   音乐播放器主题合并为一个通配符过滤器（CONFIG_SMART_PANEL_MQTT_WILDCARD_SUBSCRIBE=y）
+
+每轮按面板的方式连接（clean session）、收到 CONNACK 后立即发出订阅，记录从开始连接到
+首条消息、以及到所有路由的保留状态都到达的耗时，随后断开，重复 --runs 轮。
+
+默认在本进程内启动一个只依赖标准库的 MQTT 3.1.1 服务器替身：只支持 QoS 0 和保留消息，
+每个方向的包按 --delay-ms 延迟送达（模拟 WiFi 单程时延，多个包并行在途，不互相排队）。
+替身不模拟 mosquitto 的处理开销，数值只用于比较订阅方式之间的差别。
+有 mosquitto 时用 --broker 指向它，脚本先以保留消息发布同样的状态再测量：
+
+  python tools/mqtt_subscribe_bench.py --runs 200 --delay-ms 3
+  python tools/mqtt_subscribe_bench.py --broker localhost:1883
+
+主题和保留内容与 main/src/event_system.c 的 s_mqtt_routes 一致（statestream 路由未启用）。
+"""
+
+import argparse
+import asyncio
+import statistics
+import struct
+import time
+
+# 路由表中的主题及其保留状态（tele/.../SENSOR 不是保留消息，重连后不会立即收到）
+ROUTE_STATES = {
+    'homeassistant/sensor/esp32_music_player/lyrics/state': '从出生那年就飘着',
+    'homeassistant/sensor/esp32_music_player/lrc/state': '[00:10.00]从出生那年就飘着\n' * 80,
+    'homeassistant/sensor/esp32_music_player/song/state': '晴天',
+    'homeassistant/sensor/esp32_music_player/artist/state': '周杰伦',
+    'homeassistant/number/esp32_music_player/position/state': '0.0374',
+    'homeassistant/number/esp32_music_player/volume/state': '35',
+    'homeassistant/sensor/esp32_music_player/progress/state': '00:10 / 04:29',
+    'homeassistant/sensor/esp32_music_player/url/state': 'http://192.168.1.218/music/%E6%99%B4%E5%A4%A9.mp3',
+    'homeassistant/switch/esp32_music_player/play/state': 'ON',
+}
+ROUTE_TOPICS = list(ROUTE_STATES) + ['tele/tasmota_A0DA50/SENSOR']
+
+# 通配符模式的过滤器：与 event_system.c 的 s_mqtt_wildcards 相同，未被覆盖的路由仍精确订阅
+WILDCARD = 'homeassistant/+/esp32_music_player/+/state'
+
+# 与 mqtt_client.c 的 MQTT_SUBSCRIBE_BATCH_BYTES 相同
+SUBSCRIBE_BATCH_BYTES = 768
+
+
+def topic_matches(filter_: str, topic: str) -> bool:
+    """MQTT 主题过滤器匹配（'+' 匹配一级，'#' 匹配其余所有级）"""
+    f_levels = filter_.split('/')
+    t_levels = topic.split('/')
+    for i, level in enumerate(f_levels):
+        if level == '#':
+            return True
+        if i >= len(t_levels) or (level != '+' and level != t_levels[i]):
+            return False
+    return len(f_levels) == len(t_levels)
+
+
+def subscription_packets(mode: str) -> list:
+    """按面板的方式生成各 SUBSCRIBE 包中的过滤器列表"""
+    if mode == 'per-topic':
+        return [[topic] for topic in ROUTE_TOPICS]
+    if mode == 'wildcard':
+        filters = [WILDCARD] + [t for t in ROUTE_TOPICS if not topic_matches(WILDCARD, t)]
+    else:
+        filters = list(ROUTE_TOPICS)
+    packets, batch, size = [], [], 0
+    for f in filters:
+        if batch and size + len(f.encode()) + 3 > SUBSCRIBE_BATCH_BYTES:
+            packets.append(batch)
+            batch, size = [], 0
+        batch.append(f)
+        size += len(f.encode()) + 3
+    packets.append(batch)
+    return packets
+
+
+# ---------- MQTT 3.1.1 编解码 ----------
+
+def encode_length(n: int) -> bytes:
+    out = bytearray()
+    while True:
+        byte, n = n % 128, n // 128
+        out.append(byte | (0x80 if n else 0))
+        if not n:
+            return bytes(out)
+
+
+def encode_str(s: str) -> bytes:
+    b = s.encode()
+    return struct.pack('!H', len(b)) + b
+
+
+def packet(header: int, body: bytes) -> bytes:
+    return bytes([header]) + encode_length(len(body)) + body
+
+
+def connect_packet(client_id: str) -> bytes:
+    return packet(0x10, encode_str('MQTT') + bytes([4, 0x02]) + struct.pack('!H', 60) + encode_str(client_id))
+
+
+def subscribe_packet(packet_id: int, filters: list) -> bytes:
+    body = struct.pack('!H', packet_id) + b''.join(encode_str(f) + b'\x00' for f in filters)
+    return packet(0x82, body)
+
+
+def publish_packet(topic: str, payload: bytes, retain: bool) -> bytes:
+    return packet(0x30 | (1 if retain else 0), encode_str(topic) + payload)
+
+
+async def read_packet(reader: asyncio.StreamReader):
+    header = (await reader.readexactly(1))[0]
+    length, shift = 0, 0
+    while True:
+        byte = (await reader.readexactly(1))[0]
+        length |= (byte & 0x7F) << shift
+        shift += 7
+        if not byte & 0x80:
+            break
+    return header, await reader.readexactly(length)
+
+
+def parse_publish(header: int, body: bytes):
+    topic_len = struct.unpack('!H', body[:2])[0]
+    offset = 2 + topic_len + (2 if header & 0x06 else 0)
+    return body[2:2 + topic_len].decode(), body[offset:]
+
+
+# ---------- 服务器替身 ----------
+
+class DelayedLink:
+    """按到达顺序、在到达时刻 + delay 后处理（或写出）每个包"""
+
+    def __init__(self, delay: float, handler):
+        self.delay = delay
+        self.handler = handler
+        self.queue = asyncio.Queue()
+        self.task = asyncio.ensure_future(self.run())
+
+    def put(self, item) -> None:
+        self.queue.put_nowait((time.monotonic() + self.delay, item))
+
+    async def run(self) -> None:
+        while True:
+            due, item = await self.queue.get()
+            wait = due - time.monotonic()
+            if wait > 0:
+                await asyncio.sleep(wait)
+            await self.handler(item)
+
+
+class BrokerStub:
+    def __init__(self, delay: float):
+        self.delay = delay
+        self.retained = {}
+        self.sessions = set()
+
+    async def wait_sessions(self) -> None:
+        """等待客户端断开后仍在处理的连接结束"""
+        if self.sessions:
+            await asyncio.wait(list(self.sessions))
+
+    async def handle(self, reader: asyncio.StreamReader, writer: asyncio.StreamWriter) -> None:
+        async def send(data: bytes) -> None:
+            writer.write(data)
+            await writer.drain()
+
+        outbound = DelayedLink(self.delay, send)
+        disconnected = asyncio.Event()
+
+        async def process(item) -> None:
+            header, body = item
+            kind = header >> 4
+            if kind == 1:       # CONNECT
+                outbound.put(b'\x20\x02\x00\x00')
+            elif kind == 8:     # SUBSCRIBE：先 SUBACK，再逐个过滤器发送匹配的保留消息
+                packet_id, offset, filters = body[:2], 2, []
+                while offset < len(body):
+                    n = struct.unpack('!H', body[offset:offset + 2])[0]
+                    filters.append(body[offset + 2:offset + 2 + n].decode())
+                    offset += n + 3
+                outbound.put(packet(0x90, packet_id + b'\x00' * len(filters)))
+                for f in filters:
+                    for topic, payload in self.retained.items():
+                        if topic_matches(f, topic):
+                            outbound.put(publish_packet(topic, payload, True))
+            elif kind == 3:     # PUBLISH（QoS 0）
+                topic, payload = parse_publish(header, body)
+                if header & 0x01:
+                    self.retained[topic] = payload
+            elif kind == 12:    # PINGREQ
+                outbound.put(b'\xd0\x00')
+            elif kind == 14:    # DISCONNECT：之前的包都已处理
+                disconnected.set()
+
+        inbound = DelayedLink(self.delay, process)
+        self.sessions.add(asyncio.current_task())
+        try:
+            while True:
+                header, body = await read_packet(reader)
+                inbound.put((header, body))
+                if header >> 4 == 14:
+                    await disconnected.wait()
+                    break
+        except (asyncio.IncompleteReadError, ConnectionError):
+            pass
+        finally:
+            self.sessions.discard(asyncio.current_task())
+            inbound.task.cancel()
+            outbound.task.cancel()
+            writer.close()
+
+
+# ---------- 测量 ----------
+
+async def publish_states(host: str, port: int, states: dict) -> None:
+    reader, writer = await asyncio.open_connection(host, port)
+    writer.write(connect_packet('subscribe_bench_publisher'))
+    await read_packet(reader)
+    for topic, payload in states.items():
+        writer.write(publish_packet(topic, payload.encode(), True))
+    writer.write(b'\xe0\x00')
+    await writer.drain()
+    writer.close()
+
+
+async def measure_once(host: str, port: int, mode: str, states: dict, timeout: float) -> dict:
+    expected = set(ROUTE_STATES)
+    start = time.monotonic()
+    reader, writer = await asyncio.open_connection(host, port)
+    writer.write(connect_packet('smart_panel_bench'))
+    await writer.drain()
+    header, _ = await read_packet(reader)
+    connack = time.monotonic()
+
+    # esp-mqtt 在 MQTT_EVENT_CONNECTED 中逐个写出 SUBSCRIBE，不等待 SUBACK
+    packets = subscription_packets(mode)
+    sent = 0
+    for i, filters in enumerate(packets):
+        data = subscribe_packet(i + 1, filters)
+        writer.write(data)
+        await writer.drain()
+        sent += len(data)
+
+    first = None
+    received = 0
+    async def receive() -> None:
+        nonlocal first, received
+        while expected:
+            header, body = await read_packet(reader)
+            received += len(body) + 2
+            if header >> 4 != 3:
+                continue
+            topic, _ = parse_publish(header, body)
+            if first is None:
+                first = time.monotonic()
+            expected.discard(topic)
+    await asyncio.wait_for(receive(), timeout)
+    done = time.monotonic()
+    # 匹配订阅、但不在路由表中的保留主题：面板收到后在本地丢弃
+    unrouted = sum(1 for topic in states if topic not in ROUTE_TOPICS and
+                   any(topic_matches(f, topic) for filters in packets for f in filters))
+    writer.write(b'\xe0\x00')
+    await writer.drain()
+    writer.close()
+    return {
+        'connack': (connack - start) * 1000,
+        'first': (first - start) * 1000,
+        'all': (done - start) * 1000,
+        'packets': len(packets),
+        'sent': sent,
+        'received': received,
+        'unrouted': unrouted,
+    }
+
+
+def summarize(mode: str, runs: list) -> None:
+    def pct(key: str, p: float) -> float:
+        values = sorted(r[key] for r in runs)
+        return values[min(len(values) - 1, int(len(values) * p))]
+    print('%-10s %4d %9.1f %9.1f %9.1f %9.1f %9.1f %7d %9d %9d' % (
+        mode, runs[0]['packets'], statistics.median(r['connack'] for r in runs),
+        statistics.median(r['first'] for r in runs), pct('first', 0.95),
+        statistics.median(r['all'] for r in runs), pct('all', 0.95),
+        runs[0]['sent'], runs[0]['received'], runs[0]['unrouted']))
+
+
+async def main_async(args: argparse.Namespace) -> None:
+    states = dict(ROUTE_STATES)
+    # 路由表之外、但匹配通配符的音乐播放器主题，只有通配符模式会收到
+    for i in range(args.extra_topics):
+        states['homeassistant/sensor/esp32_music_player/extra%d/state' % i] = 'x' * 32
+
+    server = None
+    if args.broker:
+        host, _, port = args.broker.partition(':')
+        port = int(port or 1883)
+        where = '%s:%d' % (host, port)
+    else:
+        stub = BrokerStub(args.delay_ms / 1000)
+        server = await asyncio.start_server(stub.handle, '127.0.0.1', 0)
+        host, port = server.sockets[0].getsockname()[:2]
+        where = '服务器替身，单程时延 %.1f ms' % args.delay_ms
+    await publish_states(host, port, states)
+
+    print('%s，每种方式 %d 轮，另有 %d 个路由表之外的保留主题' % (where, args.runs, args.extra_topics))
+    print('%-10s %4s %9s %9s %9s %9s %9s %7s %9s %9s' % (
+        '', 'SUB', 'connack', 'first', 'first p95', 'all', 'all p95', 'sent B', 'recv B', 'unrouted'))
+    modes = ['per-topic', 'batched', 'wildcard']
+    results = {mode: [] for mode in modes}
+    # 各方式交替进行，避免主机负载变化只影响其中一种
+    for _ in range(args.runs):
+        for mode in modes:
+            results[mode].append(await measure_once(host, port, mode, states, args.timeout))
+    for mode in modes:
+        summarize(mode, results[mode])
+    print('（耗时单位 ms，均从开始建立 TCP 连接算起；first/all 为中位数；recv B 为所有路由状态到达前收到的字节数）')
+
+    if server is not None:
+        await stub.wait_sessions()
+        server.close()
+        await server.wait_closed()
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--broker', help='MQTT服务器 host[:port]，不指定时使用内置的服务器替身')
+    parser.add_argument('--delay-ms', type=float, default=3.0, help='服务器替身每个方向的时延')
+    parser.add_argument('--runs', type=int, default=100, help='每种方式的重连次数')
+    parser.add_argument('--extra-topics', type=int, default=4, help='路由表之外、匹配通配符的保留主题数')
+    parser.add_argument('--timeout', type=float, default=5.0, help='单轮等待保留状态的超时（秒）')
+    asyncio.run(main_async(parser.parse_args()))
+
+
+if __name__ == '__main__':
+    main()
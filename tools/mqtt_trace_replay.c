@@ -0,0 +1,365 @@
+/*
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+/*
+ * 主机端回放：用设备上的 mqtt_ring、mqtt_dispatch 和 ui_update_channel 回放
+ * main/bench/mqtt_trace.txt（格式同 mqtt_replay.c），三个线程分别对应：
+ *   回放线程    —— esp-mqtt 任务：按路由选通道写入环形缓冲区，信号量充当门铃
+ *   事件处理线程 —— event_system_task：门铃响或 10 ms 超时后取空环形缓冲区并分发
+ *   LVGL 线程    —— lvgl_task：每 10 ms 取出UI更新通道中的值，统计端到端延迟
+ *
+ * 路由表只包含样本中的主题，解析函数与 event_system.c 中本地播放时钟未启用时的分支相同
+ * （逐行歌词和进度原样显示，位置按比例发布）；封面、LRC 等有副作用的路由不在样本中。
+ *
+ * 编译（在项目根目录）：
+ *   gcc -O2 -pthread -Itools/host -Imain/include tools/mqtt_trace_replay.c main/src/mqtt_ring.c \
+ *       main/src/mqtt_dispatch.c main/src/ui_update_channel.c main/src/json_extract.c -o mqtt_trace_replay
+ * 运行：
+ *   ./mqtt_trace_replay [样本文件] [倍速，0 为最高速] [重复次数]
+ * 不带参数时与设备上的 mqtt_replay_task 相同，依次以10倍速回放一次、最高速回放20次。
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "esp_timer.h"
+#include "event_metrics.h"
+#include "json_extract.h"
+#include "mqtt_dispatch.h"
+#include "mqtt_ring.h"
+#include "ui_update_channel.h"
+
+// 默认样本
+#define DEFAULT_TRACE "main/bench/mqtt_trace.txt"
+
+// 与 mqtt_client.c 相同的环形缓冲区大小
+#define RING_SIZE_INTERACTIVE (4 * 1024)
+#define RING_SIZE_BULK (16 * 1024)
+
+// 与 event_system_task 和 lvgl_task 相同的周期
+#define EVENT_TASK_TIMEOUT_MS 10
+#define LVGL_PERIOD_MS 10
+#define LVGL_BULK_BUDGET_US 8000
+
+// 与 playback_clock.h 相同
+#define PLAYBACK_PROGRESS_MAX 10000
+
+// 端到端延迟直方图的上限（微秒），超过的计入最后一格
+#define LATENCY_MAX_US 100000
+
+static mqtt_ring_t *s_rings[EVENT_LANE_MAX];
+static sem_t s_doorbell;
+static volatile bool s_stop;
+
+// 端到端延迟：从写入环形缓冲区到 LVGL 线程应用
+static uint32_t s_latency_hist[LATENCY_MAX_US + 1];
+static uint32_t s_latency_count;
+
+esp_err_t event_system_post_ui_update(const ui_update_t *update)
+{
+    return ui_update_channel_publish(update);
+}
+
+static bool parse_text(const mqtt_message_t *msg, ui_update_t *update)
+{
+    update->tag = UI_VALUE_STR;
+    update->len = (msg->data_len > UINT16_MAX) ? UINT16_MAX : (uint16_t)msg->data_len;
+    update->value.str_value = msg->data;
+    return true;
+}
+
+static bool parse_position(const mqtt_message_t *msg, ui_update_t *update)
+{
+    update->value.int_value = (int)(atof(msg->data) * PLAYBACK_PROGRESS_MAX);
+    return true;
+}
+
+static bool parse_int(const mqtt_message_t *msg, ui_update_t *update)
+{
+    update->value.int_value = atoi(msg->data);
+    return true;
+}
+
+static bool parse_tasmota_power(const mqtt_message_t *msg, ui_update_t *update)
+{
+    json_field_t field = {.path = "ENERGY.Power"};
+    double power;
+    json_extract(msg->data, msg->data_len, &field, 1);
+    if (!json_field_number(&field, &power)) {
+        return false;
+    }
+    update->value.int_value = (int)(power * 10.0);
+    return true;
+}
+
+static bool parse_play_state(const mqtt_message_t *msg, ui_update_t *update)
+{
+    update->value.int_value = (strcmp(msg->data, "ON") == 0) ? 1 : 0;
+    return true;
+}
+
+static const mqtt_route_t s_routes[] = {
+    {"homeassistant/sensor/esp32_music_player/lyrics/state",    0, UI_UPDATE_TYPE_LYRICS,        parse_text,          MQTT_CHANGE_STR,    EVENT_LANE_BULK},
+    {"homeassistant/sensor/esp32_music_player/song/state",      0, UI_UPDATE_TYPE_SONG_NAME,     parse_text,          MQTT_CHANGE_STR,    EVENT_LANE_BULK},
+    {"homeassistant/sensor/esp32_music_player/artist/state",    0, UI_UPDATE_TYPE_ARTIST,        parse_text,          MQTT_CHANGE_STR,    EVENT_LANE_BULK},
+    {"homeassistant/number/esp32_music_player/position/state",  0, UI_UPDATE_TYPE_PLAY_PROGRESS, parse_position,      MQTT_CHANGE_INT,    EVENT_LANE_BULK},
+    {"homeassistant/number/esp32_music_player/volume/state",    0, UI_UPDATE_TYPE_VOLUME,        parse_int,           MQTT_CHANGE_INT,    EVENT_LANE_INTERACTIVE},
+    {"homeassistant/sensor/esp32_music_player/progress/state",  0, UI_UPDATE_TYPE_SONG_TIME,     parse_text,          MQTT_CHANGE_STR,    EVENT_LANE_BULK},
+    {"tele/tasmota_A0DA50/SENSOR",                              0, UI_UPDATE_TYPE_POWER,         parse_tasmota_power, MQTT_CHANGE_INT,    EVENT_LANE_BULK},
+    {"homeassistant/switch/esp32_music_player/play/state",      0, UI_UPDATE_TYPE_PLAY_STATE,    parse_play_state,    MQTT_CHANGE_ALWAYS, EVENT_LANE_INTERACTIVE},
+};
+
+// mqtt_client_inject：按路由选择通道写入环形缓冲区
+static esp_err_t inject(const char *topic, int topic_len, const char *data, int data_len)
+{
+    event_lane_t lane;
+    if (!mqtt_dispatch_lane(topic, topic_len, &lane)) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (!mqtt_ring_write(s_rings[lane], topic, topic_len, data, data_len, 0, 0, event_metrics_now_us())) {
+        return ESP_ERR_NO_MEM;
+    }
+    sem_post(&s_doorbell);
+    return ESP_OK;
+}
+
+static bool drain_rings(void)
+{
+    bool any = false;
+    for (int lane = 0; lane < EVENT_LANE_MAX; lane++) {
+        mqtt_message_t msg;
+        while (mqtt_ring_peek(s_rings[lane], &msg)) {
+            mqtt_dispatch_message(&msg);
+            mqtt_ring_pop(s_rings[lane]);
+            any = true;
+        }
+    }
+    return any;
+}
+
+static void *event_task(void *arg)
+{
+    (void)arg;
+    while (true) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += EVENT_TASK_TIMEOUT_MS * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_nsec -= 1000000000L;
+            deadline.tv_sec++;
+        }
+        // 门铃和超时都会取空环形缓冲区，与设备上丢失门铃时的兜底相同
+        while (sem_timedwait(&s_doorbell, &deadline) != 0 && errno == EINTR) {
+        }
+        if (!drain_rings() && __atomic_load_n(&s_stop, __ATOMIC_ACQUIRE)) {
+            return NULL;
+        }
+    }
+}
+
+static void apply_update(const ui_update_t *update, void *ctx)
+{
+    (void)ctx;
+    uint32_t latency = event_metrics_now_us() - update->origin_time;
+    s_latency_hist[(latency < LATENCY_MAX_US) ? latency : LATENCY_MAX_US]++;
+    s_latency_count++;
+}
+
+static void *lvgl_task(void *arg)
+{
+    (void)arg;
+    struct timespec period = {0, LVGL_PERIOD_MS * 1000000L};
+    while (true) {
+        bool stopping = __atomic_load_n(&s_stop, __ATOMIC_ACQUIRE);
+        if (ui_update_channel_drain(apply_update, NULL, LVGL_BULK_BUDGET_US) == 0 && stopping) {
+            return NULL;
+        }
+        nanosleep(&period, NULL);
+    }
+}
+
+static uint32_t percentile(double p)
+{
+    uint32_t target = (uint32_t)(s_latency_count * p);
+    uint32_t seen = 0;
+    for (uint32_t us = 0; us <= LATENCY_MAX_US; us++) {
+        seen += s_latency_hist[us];
+        if (seen > target) {
+            return us;
+        }
+    }
+    return LATENCY_MAX_US;
+}
+
+static void sleep_until(int64_t target_us)
+{
+    int64_t remaining_us = target_us - esp_timer_get_time();
+    if (remaining_us > 0) {
+        struct timespec ts = {remaining_us / 1000000, (remaining_us % 1000000) * 1000};
+        nanosleep(&ts, NULL);
+    }
+}
+
+// 回放一遍样本，返回成功注入的消息数
+static uint32_t replay_trace(const char *trace, size_t len, uint32_t speed, int64_t *target_us, uint32_t *ring_full)
+{
+    uint32_t messages = 0;
+    const char *p = trace;
+    const char *end = trace + len;
+    while (p < end) {
+        const char *eol = memchr(p, '\n', end - p);
+        if (eol == NULL) {
+            eol = end;
+        }
+        const char *line = p;
+        const char *line_end = (eol > line && eol[-1] == '\r') ? eol - 1 : eol;
+        p = eol + 1;
+        if (line == line_end || *line == '#') {
+            continue;
+        }
+
+        // <毫秒数> <主题> <数据>
+        char *num_end = NULL;
+        unsigned long delta_ms = strtoul(line, &num_end, 10);
+        if (num_end == line || num_end >= line_end || *num_end != ' ') {
+            continue;
+        }
+        const char *topic = num_end + 1;
+        const char *topic_end = memchr(topic, ' ', line_end - topic);
+        if (topic_end == NULL) {
+            topic_end = line_end;
+        }
+        const char *data = (topic_end < line_end) ? topic_end + 1 : line_end;
+
+        if (speed != 0) {
+            *target_us += (int64_t)delta_ms * 1000 / speed;
+            sleep_until(*target_us);
+        }
+        esp_err_t err = inject(topic, (int)(topic_end - topic), data, (int)(line_end - data));
+        if (err == ESP_OK) {
+            messages++;
+        } else if (err == ESP_ERR_NO_MEM) {
+            (*ring_full)++;
+        }
+    }
+    return messages;
+}
+
+static void run(const char *trace, size_t len, uint32_t speed, uint32_t loops)
+{
+    ui_update_channel_stats_t before;
+    ui_update_channel_stats_t after;
+    mqtt_ring_stats_t ring_before[EVENT_LANE_MAX];
+    mqtt_ring_stats_t ring_after[EVENT_LANE_MAX];
+
+    memset(s_latency_hist, 0, sizeof(s_latency_hist));
+    s_latency_count = 0;
+    s_stop = false;
+    ui_update_channel_get_stats(&before);
+    for (int lane = 0; lane < EVENT_LANE_MAX; lane++) {
+        mqtt_ring_get_stats(s_rings[lane], &ring_before[lane]);
+    }
+
+    pthread_t event_thread;
+    pthread_t lvgl_thread;
+    pthread_create(&event_thread, NULL, event_task, NULL);
+    pthread_create(&lvgl_thread, NULL, lvgl_task, NULL);
+
+    int64_t start_us = esp_timer_get_time();
+    int64_t target_us = start_us;
+    uint32_t messages = 0;
+    uint32_t ring_full = 0;
+    for (uint32_t loop = 0; loop < loops; loop++) {
+        messages += replay_trace(trace, len, speed, &target_us, &ring_full);
+    }
+
+    // 先等事件处理线程取空环形缓冲区，再等 LVGL 线程应用剩余的值
+    __atomic_store_n(&s_stop, true, __ATOMIC_RELEASE);
+    sem_post(&s_doorbell);
+    pthread_join(event_thread, NULL);
+    pthread_join(lvgl_thread, NULL);
+    int64_t elapsed_us = esp_timer_get_time() - start_us;
+
+    ui_update_channel_get_stats(&after);
+    for (int lane = 0; lane < EVENT_LANE_MAX; lane++) {
+        mqtt_ring_get_stats(s_rings[lane], &ring_after[lane]);
+    }
+
+    char label[16];
+    snprintf(label, sizeof(label), (speed == 0) ? "max" : "%ux", (unsigned int)speed);
+    printf("[%s] 注入 %u 条, 丢弃 %u 条, 耗时 %u ms, 吞吐 %u 条/秒\n", label, (unsigned int)messages,
+           (unsigned int)ring_full, (unsigned int)(elapsed_us / 1000),
+           (unsigned int)(elapsed_us > 0 ? (int64_t)messages * 1000000 / elapsed_us : 0));
+    static const char *const lane_names[EVENT_LANE_MAX] = {"interactive", "bulk"};
+    for (int lane = 0; lane < EVENT_LANE_MAX; lane++) {
+        printf("[%s] 环形缓冲区 %-11s 写入 %u 丢弃 %u 峰值 %u/%u 字节\n", label, lane_names[lane],
+               (unsigned int)(ring_after[lane].written - ring_before[lane].written),
+               (unsigned int)(ring_after[lane].dropped - ring_before[lane].dropped),
+               (unsigned int)ring_after[lane].high_water, (unsigned int)ring_after[lane].capacity);
+    }
+    printf("[%s] UI通道 发布 %u 合并 %u 应用 %u 推迟 %u 截断 %u 拷贝 %u 字节\n", label,
+           (unsigned int)(after.published - before.published), (unsigned int)(after.coalesced - before.coalesced),
+           (unsigned int)(after.applied - before.applied), (unsigned int)(after.deferred - before.deferred),
+           (unsigned int)(after.truncated - before.truncated),
+           (unsigned int)(after.copied_bytes - before.copied_bytes));
+    printf("[%s] 端到端延迟 p50 %u us, p99 %u us (%u 个样本)\n", label, percentile(0.5), percentile(0.99),
+           (unsigned int)s_latency_count);
+}
+
+static char *read_file(const char *path, size_t *len)
+{
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char *buf = malloc(size + 1);
+    if (buf != NULL && fread(buf, 1, size, f) == (size_t)size) {
+        buf[size] = '\0';
+        *len = (size_t)size;
+    } else {
+        free(buf);
+        buf = NULL;
+    }
+    fclose(f);
+    return buf;
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = (argc > 1) ? argv[1] : DEFAULT_TRACE;
+    size_t len = 0;
+    char *trace = read_file(path, &len);
+    if (trace == NULL) {
+        fprintf(stderr, "无法读取样本: %s\n", path);
+        return 1;
+    }
+
+    s_rings[EVENT_LANE_INTERACTIVE] = mqtt_ring_create(RING_SIZE_INTERACTIVE);
+    s_rings[EVENT_LANE_BULK] = mqtt_ring_create(RING_SIZE_BULK);
+    if (s_rings[EVENT_LANE_INTERACTIVE] == NULL || s_rings[EVENT_LANE_BULK] == NULL ||
+        ui_update_channel_init() != ESP_OK ||
+        mqtt_dispatch_register(s_routes, sizeof(s_routes) / sizeof(s_routes[0])) != ESP_OK) {
+        fprintf(stderr, "初始化失败\n");
+        return 1;
+    }
+    sem_init(&s_doorbell, 0, 0);
+
+    if (argc > 2) {
+        run(trace, len, (uint32_t)strtoul(argv[2], NULL, 10), (argc > 3) ? (uint32_t)strtoul(argv[3], NULL, 10) : 1);
+    } else {
+        run(trace, len, 10, 1);
+        run(trace, len, 0, 20);
+    }
+    free(trace);
+    return 0;
+}